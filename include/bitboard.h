@@ -0,0 +1,142 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+/**
+ * A set of squares. Bit n is set when the square whose underlying value is n is in the set, so bit 0 is A8 and bit 63
+ * is H1.
+ */
+using Bitboard = uint64_t;
+
+constexpr Bitboard kEmptyBitboard = 0;
+
+constexpr Bitboard kFileA = 0x0101010101010101;
+constexpr Bitboard kFileB = kFileA << 1;
+constexpr Bitboard kFileC = kFileA << 2;
+constexpr Bitboard kFileD = kFileA << 3;
+constexpr Bitboard kFileE = kFileA << 4;
+constexpr Bitboard kFileF = kFileA << 5;
+constexpr Bitboard kFileG = kFileA << 6;
+constexpr Bitboard kFileH = kFileA << 7;
+
+// Rank 8 holds the lowest bits.
+constexpr Bitboard kRank8 = 0xFF;
+constexpr Bitboard kRank7 = kRank8 << 8;
+constexpr Bitboard kRank6 = kRank8 << 16;
+constexpr Bitboard kRank5 = kRank8 << 24;
+constexpr Bitboard kRank4 = kRank8 << 32;
+constexpr Bitboard kRank3 = kRank8 << 40;
+constexpr Bitboard kRank2 = kRank8 << 48;
+constexpr Bitboard kRank1 = kRank8 << 56;
+
+/**
+ * @exception std::invalid_argument if the square is invalid.
+ */
+[[nodiscard]] constexpr Bitboard SquareBitboard(const Square square) {
+  if (square < Square::kA8 || square >= Square::kNone) {
+    throw std::invalid_argument("Invalid square.");
+  }
+  return Bitboard{1} << std::to_underlying(square);
+}
+
+// Bit 0 is A8, so north (towards rank 8) is a right shift by 8 and east (towards the h file) a left shift by 1. Squares
+// shifted off the board are dropped.
+[[nodiscard]] constexpr Bitboard North(const Bitboard bitboard) noexcept { return bitboard >> 8; }
+[[nodiscard]] constexpr Bitboard South(const Bitboard bitboard) noexcept { return bitboard << 8; }
+[[nodiscard]] constexpr Bitboard East(const Bitboard bitboard) noexcept { return (bitboard << 1) & ~kFileA; }
+[[nodiscard]] constexpr Bitboard West(const Bitboard bitboard) noexcept { return (bitboard >> 1) & ~kFileH; }
+
+/**
+ * @return The squares attacked by every knight on the bitboard at once. Knights attack symmetrically, so these are also
+ * the squares a knight has to stand on to attack one of the given squares.
+ */
+[[nodiscard]] constexpr Bitboard KnightSpread(const Bitboard bitboard) noexcept {
+  const Bitboard one_file = East(bitboard) | West(bitboard);
+  const Bitboard two_files = ((bitboard << 2) & ~(kFileA | kFileB)) | ((bitboard >> 2) & ~(kFileG | kFileH));
+  return North(North(one_file)) | South(South(one_file)) | North(two_files) | South(two_files);
+}
+
+/**
+ * @return The squares attacked by every king on the bitboard at once, leaving out the kings' own squares.
+ */
+[[nodiscard]] constexpr Bitboard KingSpread(const Bitboard bitboard) noexcept {
+  const Bitboard row = bitboard | East(bitboard) | West(bitboard);
+  return (row | North(row) | South(row)) & ~bitboard;
+}
+
+/**
+ * @return The squares a pawn of the attacking color has to stand on to attack one of the given squares.
+ */
+[[nodiscard]] constexpr Bitboard PawnAttackerSquares(const Bitboard bitboard, const Color attacker) noexcept {
+  const Bitboard files = East(bitboard) | West(bitboard);
+  return attacker == Color::kWhite ? South(files) : North(files);
+}
+
+/**
+ * Every piece of a position as one bitboard per piece type and one per color.
+ */
+struct PositionBitboards {
+  std::array<Bitboard, 6> piece_types{};
+  std::array<Bitboard, 2> colors{};
+
+  constexpr bool operator==(const PositionBitboards&) const = default;
+
+  /**
+   * @exception std::invalid_argument if the piece type is kNone or invalid.
+   */
+  [[nodiscard]] Bitboard Pieces(PieceType piece_type) const;
+  /**
+   * @exception std::invalid_argument if the color is kNone or invalid.
+   */
+  [[nodiscard]] Bitboard Pieces(Color color) const;
+  /**
+   * @exception std::invalid_argument if the piece is invalid or kNone.
+   */
+  [[nodiscard]] Bitboard Pieces(Piece piece) const;
+  [[nodiscard]] Bitboard Occupied() const noexcept;
+};
+
+/**
+ * @exception std::invalid_argument if the position contains invalid pieces.
+ */
+[[nodiscard]] PositionBitboards MakeBitboards(const Position& position);
+
+/**
+ * The attack functions throw std::invalid_argument if the square (or color) is invalid.
+ */
+[[nodiscard]] Bitboard PawnAttacks(Color color, Square square);
+[[nodiscard]] Bitboard KnightAttacks(Square square);
+[[nodiscard]] Bitboard KingAttacks(Square square);
+/**
+ * Sliders stop at, and include, the first occupied square in each direction.
+ */
+[[nodiscard]] Bitboard BishopAttacks(Square square, Bitboard occupied);
+[[nodiscard]] Bitboard RookAttacks(Square square, Bitboard occupied);
+[[nodiscard]] Bitboard QueenAttacks(Square square, Bitboard occupied);
+
+/**
+ * @return Every piece, of either color, attacking the square. Slider attacks are computed with the given occupancy, so
+ * removing pieces from it reveals the attackers behind them (x-rays).
+ * @exception std::invalid_argument if the square is invalid.
+ */
+[[nodiscard]] Bitboard AttackersTo(const PositionBitboards& bitboards, Square square, Bitboard occupied);
+
+/**
+ * @return The square of the lowest set bit.
+ * @exception std::invalid_argument if the bitboard is empty.
+ */
+[[nodiscard]] Square LowestSquare(Bitboard bitboard);
+
+}  // namespace bomchess
+
+#endif  // BITBOARD_H
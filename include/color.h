@@ -1,7 +1,10 @@
 #ifndef COLOR_H
 #define COLOR_H
 
+#include <cstddef>
 #include <ostream>
+#include <stdexcept>
+#include <utility>
 
 namespace bomchess {
 enum class Color { kWhite, kBlack, kNone };
@@ -20,6 +23,17 @@ constexpr std::ostream& operator<<(std::ostream& os, const Color color) noexcept
   }
   return os;
 }
+
+/**
+ * @return 0 for white and 1 for black, for indexing per color tables.
+ * @exception std::invalid_argument if the color is kNone or invalid.
+ */
+[[nodiscard]] constexpr size_t ColorIndex(const Color color) {
+  if (color != Color::kWhite && color != Color::kBlack) {
+    throw std::invalid_argument("Invalid color.");
+  }
+  return std::to_underlying(color);
+}
 }  // namespace bomchess
 
 #endif  // COLOR_H
@@ -0,0 +1,120 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+enum class GameResult { kWhiteWins, kBlackWins, kDraw, kUnknown };
+
+/**
+ * One training example: a position, the move played from it and how the game ended.
+ */
+struct TrainingRecord {
+  PositionState state;
+  Move move;
+  GameResult result = GameResult::kUnknown;
+
+  bool operator==(const TrainingRecord&) const = default;
+};
+
+/**
+ * Writes training records to a binary dataset file. Records are grouped into blocks of up to kRecordsPerBlock, each
+ * starting on a kDatasetBlockAlignment byte boundary so blocks can be memory mapped on their own. Within a block the
+ * first record of each game is stored in full (an occupancy bitboard, 4 bits per piece and the state) and every later
+ * one only as its 2 byte move, since the position follows from the one before. An index of blocks at the end of the
+ * file allows jumping to any record.
+ */
+class DatasetWriter {
+ public:
+  /**
+   * @exception std::runtime_error if the file can't be created.
+   */
+  explicit DatasetWriter(const std::filesystem::path& path);
+  DatasetWriter(const DatasetWriter&) = delete;
+  DatasetWriter& operator=(const DatasetWriter&) = delete;
+  /**
+   * Closes the file, errors are ignored. Call Close to see them.
+   */
+  ~DatasetWriter();
+
+  /**
+   * Replays the game from its start and writes a record for every move.
+   * @exception std::invalid_argument if a move doesn't move a piece of the side to move. Nothing is written then.
+   * @exception std::runtime_error if writing fails.
+   */
+  void AddGame(const PositionState& start, std::span<const Move> moves, GameResult result);
+
+  /**
+   * Writes the last block and the index. No games can be added afterwards.
+   * @exception std::runtime_error if writing fails.
+   */
+  void Close();
+
+  static constexpr size_t kRecordsPerBlock = 1024;
+
+ private:
+  void AddRecord(const TrainingRecord& record, bool continues_game);
+  void FinishBlock();
+
+  std::ofstream file_;
+  std::string block_;
+  size_t block_records_ = 0;
+  uint64_t record_count_ = 0;
+  // Byte offset and first record of each finished block.
+  std::vector<std::array<uint64_t, 2>> index_;
+  bool closed_ = false;
+};
+
+constexpr size_t kDatasetBlockAlignment = 4096;
+
+/**
+ * Random access to a dataset written by DatasetWriter. Reading a record decodes its whole block, and the last decoded
+ * block is kept, so reading records in order is cheap.
+ */
+class DatasetReader {
+ public:
+  /**
+   * @exception std::runtime_error if the file can't be opened or is not a complete dataset file.
+   */
+  explicit DatasetReader(const std::filesystem::path& path);
+
+  [[nodiscard]] uint64_t Size() const noexcept;
+  [[nodiscard]] size_t BlockCount() const noexcept;
+
+  /**
+   * @exception std::out_of_range if the index is not less than Size().
+   * @exception std::runtime_error if the block can't be read or is corrupt.
+   */
+  [[nodiscard]] const TrainingRecord& Read(uint64_t index);
+
+  /**
+   * @exception std::out_of_range if the block is not less than BlockCount().
+   * @exception std::runtime_error if the block can't be read or is corrupt.
+   */
+  [[nodiscard]] std::span<const TrainingRecord> ReadBlock(size_t block);
+
+ private:
+  std::ifstream file_;
+  uint64_t record_count_ = 0;
+  std::vector<std::array<uint64_t, 2>> index_;
+  uint64_t index_offset_ = 0;
+  size_t cached_block_ = 0;
+  std::vector<TrainingRecord> cached_records_;
+};
+
+}  // namespace bomchess
+
+#endif  // DATASET_H
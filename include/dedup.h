@@ -0,0 +1,135 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include "game.h"
+#include "move.h"
+
+namespace bomchess {
+/**
+ * A 128 bit hash identifying a game.
+ */
+struct GameFingerprint {
+  uint64_t high = 0;
+  uint64_t low = 0;
+
+  constexpr auto operator<=>(const GameFingerprint&) const = default;
+};
+
+/**
+ * Builds a game's fingerprint one move at a time, so games can be fingerprinted while they are streamed in. The
+ * fingerprint covers the move sequence and the White, Black and Date tags. Tag values are compared ignoring case,
+ * surrounding whitespace and runs of whitespace, and an unknown value ("?", "????.??.??") equals a missing one. The
+ * result is left out, so a copy of a game with the result missing or "*" is still a duplicate.
+ */
+class GameFingerprinter {
+ public:
+  /**
+   * @exception std::invalid_argument if the move's squares or promotion are invalid.
+   */
+  void AddMove(Move move);
+
+  /**
+   * Combines the moves so far with the game's tags. Further moves can still be added.
+   */
+  [[nodiscard]] GameFingerprint Finish(const TagPairs& tags) const;
+
+ private:
+  uint64_t high_ = 0x6a09e667f3bcc908;
+  uint64_t low_ = 0xbb67ae8584caa73b;
+  uint64_t move_count_ = 0;
+};
+
+/**
+ * @exception std::invalid_argument if a move's squares or promotion are invalid.
+ */
+[[nodiscard]] GameFingerprint Fingerprint(std::span<const Move> moves, const TagPairs& tags);
+
+/**
+ * The set of fingerprints seen so far, kept on disk so it can grow past memory. A Bloom filter in memory answers most
+ * lookups for new games. The rest check the exact set: sorted shard files with a sparse index in memory, so a lookup
+ * reads one small block. New fingerprints are held in memory and merged into the shard files in batches.
+ */
+class DuplicateFilter {
+ public:
+  /**
+   * Opens the set stored in the directory, creating it if needed. Fingerprints already stored count as seen, so
+   * several runs over different sources can share a directory.
+   * @param expected_games Sizes the Bloom filter at about 10 bits per game. Going over only means more disk reads.
+   * @param max_pending How many new fingerprints are held in memory before being merged into the shard files.
+   * @exception std::runtime_error if the directory can't be created or a shard file can't be read.
+   */
+  DuplicateFilter(const std::filesystem::path& directory, size_t expected_games, size_t max_pending = size_t{1} << 20);
+  DuplicateFilter(const DuplicateFilter&) = delete;
+  DuplicateFilter& operator=(const DuplicateFilter&) = delete;
+  /**
+   * Flushes pending fingerprints. Call Flush first to see any error.
+   */
+  ~DuplicateFilter();
+
+  /**
+   * Records the fingerprint.
+   * @return true if the fingerprint had not been seen before.
+   * @exception std::runtime_error if a shard file can't be read or written.
+   */
+  bool Insert(const GameFingerprint& fingerprint);
+
+  /**
+   * @exception std::runtime_error if a shard file can't be read.
+   */
+  [[nodiscard]] bool Contains(const GameFingerprint& fingerprint);
+
+  /**
+   * Merges the pending fingerprints into the shard files.
+   * @exception std::runtime_error if a shard file can't be written.
+   */
+  void Flush();
+
+  /**
+   * @return How many fingerprints are in the set, stored and pending.
+   */
+  [[nodiscard]] size_t Size() const noexcept;
+
+  static constexpr size_t kShardCount = 64;
+
+ private:
+  // Fingerprints are already well mixed hashes.
+  struct FingerprintHash {
+    size_t operator()(const GameFingerprint& fingerprint) const noexcept { return fingerprint.low; }
+  };
+
+  struct Shard {
+    std::filesystem::path path;
+    std::ifstream file;
+    size_t size = 0;
+    // Every kIndexInterval'th stored fingerprint, so a lookup only reads the block between two of them.
+    std::vector<GameFingerprint> sparse_index;
+    // Sorted once, when they are merged into the file.
+    std::unordered_set<GameFingerprint, FingerprintHash> pending;
+  };
+
+  void LoadShard(Shard& shard);
+  // Merges the pending fingerprints with the file, rebuilding the sparse index as the merged file is written.
+  void FlushShard(Shard& shard);
+  [[nodiscard]] bool StoredInShard(Shard& shard, const GameFingerprint& fingerprint);
+  [[nodiscard]] bool MightContain(const GameFingerprint& fingerprint) const noexcept;
+  void AddToBloomFilter(const GameFingerprint& fingerprint) noexcept;
+
+  std::vector<uint64_t> bloom_filter_;
+  std::array<Shard, kShardCount> shards_;
+  size_t max_pending_;
+  size_t pending_count_ = 0;
+};
+
+}  // namespace bomchess
+
+#endif  // DEDUP_H
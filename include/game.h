@@ -1,8 +1,114 @@
-//
-// Created by brigh on 6/20/2024.
-//
-
 #ifndef GAME_H
 #define GAME_H
 
-#endif //GAME_H
+#include <array>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bomchess {
+namespace tags {
+// Seven Tag Roster
+constexpr std::string_view kEvent = "Event";
+constexpr std::string_view kSite = "Site";
+constexpr std::string_view kDate = "Date";
+constexpr std::string_view kRound = "Round";
+constexpr std::string_view kWhite = "White";
+constexpr std::string_view kBlack = "Black";
+constexpr std::string_view kResult = "Result";
+
+// Supplemental tags from section 9 of the PGN standard.
+constexpr std::string_view kWhiteTitle = "WhiteTitle";
+constexpr std::string_view kBlackTitle = "BlackTitle";
+constexpr std::string_view kWhiteElo = "WhiteElo";
+constexpr std::string_view kBlackElo = "BlackElo";
+constexpr std::string_view kWhiteUSCF = "WhiteUSCF";
+constexpr std::string_view kBlackUSCF = "BlackUSCF";
+constexpr std::string_view kWhiteNA = "WhiteNA";
+constexpr std::string_view kBlackNA = "BlackNA";
+constexpr std::string_view kWhiteType = "WhiteType";
+constexpr std::string_view kBlackType = "BlackType";
+constexpr std::string_view kEventDate = "EventDate";
+constexpr std::string_view kEventSponsor = "EventSponsor";
+constexpr std::string_view kSection = "Section";
+constexpr std::string_view kStage = "Stage";
+constexpr std::string_view kBoard = "Board";
+constexpr std::string_view kOpening = "Opening";
+constexpr std::string_view kVariation = "Variation";
+constexpr std::string_view kSubVariation = "SubVariation";
+constexpr std::string_view kECO = "ECO";
+constexpr std::string_view kNIC = "NIC";
+constexpr std::string_view kTime = "Time";
+constexpr std::string_view kUTCTime = "UTCTime";
+constexpr std::string_view kUTCDate = "UTCDate";
+constexpr std::string_view kTimeControl = "TimeControl";
+constexpr std::string_view kSetUp = "SetUp";
+constexpr std::string_view kFEN = "FEN";
+constexpr std::string_view kTermination = "Termination";
+constexpr std::string_view kAnnotator = "Annotator";
+constexpr std::string_view kMode = "Mode";
+constexpr std::string_view kPlyCount = "PlyCount";
+
+/**
+ * The Seven Tag Roster in the order the PGN standard requires them to be exported.
+ */
+constexpr std::array<std::string_view, 7> kSevenTagRoster{kEvent, kSite, kDate, kRound, kWhite, kBlack, kResult};
+}  // namespace tags
+
+struct TagPair {
+  std::pmr::string name;
+  std::pmr::string value;
+};
+
+/**
+ * The PGN tags of a game. The Seven Tag Roster is kept in fixed slots, so only supplemental tags store their names.
+ * All strings are allocated from the memory resource given at construction, which lets a game keep its tags in the
+ * same arena as the rest of its data.
+ */
+class TagPairs {
+ public:
+  explicit TagPairs(std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource());
+  /**
+   * Copies the tags into strings allocated from the given memory resource. Plain copies are deleted because they would
+   * silently allocate from the default resource instead of the source's.
+   */
+  TagPairs(const TagPairs& other, std::pmr::memory_resource* memory_resource);
+  TagPairs(const TagPairs&) = delete;
+  TagPairs& operator=(const TagPairs&) = delete;
+  /**
+   * Moves keep the source's memory resource. Move assignment keeps the target's, copying if the two differ.
+   */
+  TagPairs(TagPairs&&) noexcept = default;
+  TagPairs& operator=(TagPairs&& other);
+  ~TagPairs() = default;
+
+  /**
+   * @return The value of the tag, or "" if the tag is not set.
+   */
+  [[nodiscard]] std::string_view Get(std::string_view name) const noexcept;
+
+  /**
+   * Sets or overwrites a tag. No validation or cleansing of the tag is done. Setting a tag to "" removes it.
+   */
+  void Set(std::string_view name, std::string_view value);
+
+  /**
+   * @return The supplemental (non Seven Tag Roster) tags in the order they were first set.
+   */
+  [[nodiscard]] std::span<const TagPair> SupplementalTags() const noexcept;
+
+  [[nodiscard]] std::pmr::memory_resource* GetMemoryResource() const noexcept;
+
+ private:
+  // Replaces the tags with copies of the other's, allocated from this one's memory resource.
+  void CopyFrom(const TagPairs& other);
+
+  std::array<std::pmr::string, tags::kSevenTagRoster.size()> roster_;
+  std::pmr::vector<TagPair> supplemental_;
+};
+
+}  // namespace bomchess
+
+#endif  // GAME_H
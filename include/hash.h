@@ -0,0 +1,17 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+
+namespace bomchess {
+/**
+ * The finalizer from splitmix64, so every input bit affects every output bit.
+ */
+[[nodiscard]] constexpr uint64_t Mix64(uint64_t value) noexcept {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+}  // namespace bomchess
+
+#endif  // HASH_H
@@ -0,0 +1,120 @@
+#ifndef HISTORYCODEC_H
+#define HISTORYCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "move.h"
+#include "movegen.h"
+
+namespace bomchess {
+/**
+ * The largest number of legal moves in any reachable chess position.
+ */
+constexpr int kMaxLegalMoves = 218;
+
+/**
+ * The largest sum of move frequencies a model may pass to MoveIndexEncoder::Write or MoveIndexDecoder::Read.
+ */
+constexpr uint32_t kMaxFrequencyTotal = uint32_t{1} << 16;
+
+/**
+ * Compresses a move history by storing each move as its index in the legal move list of the position it was played
+ * from. The indices are range coded, so a ply costs log2(legal move count) bits rounded to a fraction of a bit rather
+ * than up to a whole one, and forced moves cost nothing. Callers with a model of which moves are likely (from move
+ * ordering, say) can pass each move's frequency instead, and likely moves then cost less than a bit. The decoder needs
+ * the same legal move counts or frequencies, in the same order, to read the indices back.
+ */
+class MoveIndexEncoder {
+ public:
+  /**
+   * Writes the index with every legal move equally likely.
+   * @exception std::invalid_argument if legal_move_count is not in [1, kMaxLegalMoves] or move_index is not less than
+   * legal_move_count.
+   */
+  void Write(int move_index, int legal_move_count);
+
+  /**
+   * Writes the index with each legal move as likely as its frequency. The legal move count is frequencies.size().
+   * @exception std::invalid_argument if there are not [1, kMaxLegalMoves] frequencies, any frequency is 0, they sum to
+   * more than kMaxFrequencyTotal, or move_index is not less than the legal move count.
+   */
+  void Write(int move_index, std::span<const uint32_t> frequencies);
+
+  /**
+   * Ends the history, appending its encoded bytes to output, and resets the encoder for the next one. Trailing zero
+   * bytes are left out, the decoder reads past the end as zeros.
+   */
+  void Finish(std::vector<uint8_t>& output);
+
+ private:
+  void Encode(uint32_t start, uint32_t size, uint32_t total);
+  void ShiftLow();
+
+  std::vector<uint8_t> bytes_;
+  // The low end of the coding interval, with a carry bit above the 32 bits not yet written.
+  uint64_t low_ = 0;
+  uint32_t range_ = std::numeric_limits<uint32_t>::max();
+  // The last byte of low that left the interval, held back until it is known whether a carry reaches it, and how many
+  // 0xFF bytes a carry would turn to zero after it.
+  uint8_t cache_ = 0;
+  size_t cache_size_ = 1;
+};
+
+class MoveIndexDecoder {
+ public:
+  /**
+   * The decoder does not copy the bytes, they must outlive it.
+   */
+  explicit MoveIndexDecoder(std::span<const uint8_t> bytes) noexcept;
+
+  /**
+   * Reads an index written with MoveIndexEncoder::Write(move_index, legal_move_count). The decoder is left unchanged if
+   * this throws.
+   * @return The index of the next move.
+   * @exception std::invalid_argument if legal_move_count is not in [1, kMaxLegalMoves], or the data does not decode to
+   * an index less than legal_move_count.
+   */
+  [[nodiscard]] int Read(int legal_move_count);
+
+  /**
+   * Reads an index written with MoveIndexEncoder::Write(move_index, frequencies). The decoder is left unchanged if this
+   * throws.
+   * @exception std::invalid_argument if the frequencies are invalid (see MoveIndexEncoder::Write), or the data does
+   * not decode to an index less than the legal move count.
+   */
+  [[nodiscard]] int Read(std::span<const uint32_t> frequencies);
+
+ private:
+  [[nodiscard]] uint32_t Target(uint32_t total) const;
+  void Consume(uint32_t start, uint32_t size, uint32_t total);
+  [[nodiscard]] uint8_t NextByte() noexcept;
+
+  std::span<const uint8_t> bytes_;
+  size_t byte_position_ = 0;
+  // How far into the coding interval the encoded value lies.
+  uint32_t code_ = 0;
+  uint32_t range_ = std::numeric_limits<uint32_t>::max();
+};
+
+/**
+ * Encodes the moves played from the start, each as its index in the GenerateLegalMoves list of the position it was
+ * played from, appending the bytes to output. The move count is not stored.
+ * @exception std::invalid_argument if a move is not legal in the position it is played from.
+ */
+void EncodeHistory(const PositionState& start, std::span<const Move> moves, std::vector<uint8_t>& output);
+
+/**
+ * Decodes move_count moves written by EncodeHistory from the same start, replaying them with AdvanceState.
+ * @exception std::invalid_argument if the data does not decode to legal moves, or the game ends before move_count
+ * moves.
+ */
+[[nodiscard]] std::vector<Move> DecodeHistory(const PositionState& start, std::span<const uint8_t> bytes,
+                                              size_t move_count);
+
+}  // namespace bomchess
+
+#endif  // HISTORYCODEC_H
@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace bomchess {
+/**
+ * A whole file memory mapped read only. The mapping lives as long as the object.
+ */
+class MappedFile {
+ public:
+  /**
+   * @param random_access Set to true if the file is read in random places, so the OS doesn't read ahead.
+   * @exception std::runtime_error if the file can't be opened, is empty or can't be mapped.
+   */
+  explicit MappedFile(const std::filesystem::path& path, bool random_access = false);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  [[nodiscard]] std::span<const std::byte> Data() const noexcept;
+
+ private:
+  const std::byte* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace bomchess
+
+#endif  // MAPPEDFILE_H
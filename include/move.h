@@ -14,6 +14,12 @@ struct Move {
   constexpr bool operator==(const Move&) const = default;
 };
 
+/**
+ * Passing the turn without moving, written "0000" in UCI. Engines send it as their best move when they have no legal
+ * move, and GUIs may include it in a position's move list.
+ */
+constexpr Move kNullMove{Square::kNone, Square::kNone, PieceType::kNone};
+
 /**
  * @exception std::invalid_argument if the move string is not a valid UCI move as defined at
  * https://www.chessprogramming.org/Algebraic_Chess_Notation#UCI
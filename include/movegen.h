@@ -1,8 +1,116 @@
-//
-// Created by brigh on 6/20/2024.
-//
-
 #ifndef MOVEGEN_H
 #define MOVEGEN_H
 
-#endif //MOVEGEN_H
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+/**
+ * One side's castling rights.
+ */
+struct CastlingRights {
+  bool king_side = false;
+  bool queen_side = false;
+
+  constexpr bool operator==(const CastlingRights&) const = default;
+};
+
+/**
+ * What MakeMove changed that the move alone doesn't record, so UnmakeMove can restore it.
+ */
+struct UndoInfo {
+  Piece captured = pieces::kNone;
+  Square captured_square = Square::kNone;
+
+  constexpr bool operator==(const UndoInfo&) const = default;
+};
+
+/**
+ * A position along with the state a Position doesn't hold.
+ */
+struct PositionState {
+  Position position;
+  Color side_to_move = Color::kWhite;
+  /**
+   * Indexed by Color.
+   */
+  std::array<CastlingRights, 2> castling{};
+  Square en_passant = Square::kNone;
+  uint16_t ply = 0;
+
+  bool operator==(const PositionState&) const = default;
+};
+
+/**
+ * Appends the pseudo legal pawn moves for the side: single and double pushes, captures, en passant onto the given
+ * square, and every promotion (queen, rook, bishop then knight) on the last rank.
+ * @param en_passant The square behind a pawn that just moved two squares, or Square::kNone.
+ * @exception std::invalid_argument if the color is kNone or invalid.
+ */
+void GeneratePawnMoves(const Position& position, Color side, Square en_passant, std::vector<Move>& moves);
+
+/**
+ * Appends the castling moves, as king moves of two squares, the side is allowed to play. The squares between king and
+ * rook must be empty, and the king may not start on, pass through or land on an attacked square.
+ * @exception std::invalid_argument if the color is kNone or invalid.
+ */
+void GenerateCastlingMoves(const Position& position, Color side, CastlingRights rights, std::vector<Move>& moves);
+
+/**
+ * Appends the pseudo legal knight, bishop, rook, queen and king moves for the side. Castling is left to
+ * GenerateCastlingMoves.
+ * @exception std::invalid_argument if the color is kNone or invalid.
+ */
+void GeneratePieceMoves(const Position& position, Color side, std::vector<Move>& moves);
+
+/**
+ * Appends the legal moves for the side: the moves of GeneratePawnMoves, GeneratePieceMoves and GenerateCastlingMoves
+ * that don't leave its king attacked.
+ * @param en_passant The square behind a pawn that just moved two squares, or Square::kNone.
+ * @exception std::invalid_argument if the color is kNone or invalid, or the side has no king.
+ */
+void GenerateLegalMoves(const Position& position, Color side, Square en_passant, CastlingRights rights,
+                        std::vector<Move>& moves);
+
+/**
+ * @return true if the side's king is attacked.
+ * @exception std::invalid_argument if the color is kNone or invalid, or the side has no king.
+ */
+[[nodiscard]] bool IsInCheck(const Position& position, Color side);
+
+/**
+ * @return true if the move takes a piece, en passant included. A pawn moving diagonally onto an empty square is taken
+ * to be en passant, as MakeMove does.
+ */
+[[nodiscard]] bool IsCapture(const Position& position, Move move);
+
+/**
+ * Plays the move on the position, including the rook move when castling, removing the pawn taken en passant and
+ * promoting. The move is not checked for legality. A pawn moving diagonally onto an empty square is taken to be en
+ * passant, a king moving two squares from its starting square to be castling.
+ * @exception std::invalid_argument if the move's squares are invalid or there is no piece on the from square.
+ */
+UndoInfo MakeMove(Position& position, Move move);
+
+/**
+ * Takes back a move played with MakeMove.
+ * @exception std::invalid_argument if the move's squares are invalid or there is no piece on the to square.
+ */
+void UnmakeMove(Position& position, Move move, UndoInfo undo);
+
+/**
+ * Plays the move, updating the side to move, castling rights, en passant square and ply as well as the position.
+ * @exception std::invalid_argument if there is no piece of the side to move on the move's from square.
+ */
+void AdvanceState(PositionState& state, Move move);
+
+}  // namespace bomchess
+
+#endif  // MOVEGEN_H
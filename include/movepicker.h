@@ -0,0 +1,99 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "position.h"
+
+namespace bomchess {
+/**
+ * Scores quiet moves by how often they caused a cutoff in the past, per side, from square and to square.
+ */
+class HistoryTable {
+ public:
+  /**
+   * Moves the score towards +/- kMaxHistory. Large bonuses move it further, but the score can never leave the range.
+   * @exception std::invalid_argument if the color or the move's squares are invalid.
+   */
+  void Update(Color color, Move move, int bonus);
+
+  /**
+   * @exception std::invalid_argument if the color or the move's squares are invalid.
+   */
+  [[nodiscard]] int Get(Color color, Move move) const;
+
+  void Clear() noexcept;
+
+  static constexpr int kMaxHistory = 16384;
+
+ private:
+  std::array<std::array<std::array<int, 64>, 64>, 2> scores_{};
+};
+
+/**
+ * Move generation hooks for MovePicker. Each generator appends pseudo legal moves for the side to move.
+ */
+struct MovePickerGenerators {
+  std::function<void(std::vector<Move>& moves)> captures;
+  std::function<void(std::vector<Move>& moves)> quiets;
+  /**
+   * Hash moves and killers come from other positions, so they are only played if this returns true.
+   */
+  std::function<bool(Move move)> is_pseudo_legal;
+};
+
+/**
+ * Hands out moves one at a time, best guesses first: the hash move, captures by most valuable victim then least
+ * valuable attacker, the killer moves, the remaining quiet moves by history score, and finally the captures that lose
+ * material by static exchange evaluation. Each stage's moves are only generated once the previous stage is used up,
+ * and only the best remaining move is picked out each time, so a node that cuts off early never generates or sorts its
+ * quiet moves.
+ */
+class MovePicker {
+ public:
+  /**
+   * Pass a move with Square::kNone squares for a missing hash move or killer. The position, history table and
+   * generators must outlive the picker.
+   */
+  MovePicker(const Position& position, Move hash_move, std::array<Move, 2> killers, const HistoryTable& history,
+             const MovePickerGenerators& generators);
+
+  /**
+   * @return The next move, or std::nullopt once every move has been picked.
+   */
+  [[nodiscard]] std::optional<Move> Next();
+
+ private:
+  enum class Stage { kHashMove, kGenerateCaptures, kCaptures, kKillers, kGenerateQuiets, kQuiets, kBadCaptures, kDone };
+
+  struct ScoredMove {
+    Move move;
+    int score;
+  };
+
+  [[nodiscard]] bool IsPlayableKiller(Move killer) const;
+  [[nodiscard]] bool AlreadyPicked(Move move) const noexcept;
+  [[nodiscard]] std::optional<Move> PickBest();
+
+  const Position& position_;
+  Move hash_move_;
+  std::array<Move, 2> killers_;
+  const HistoryTable& history_;
+  const MovePickerGenerators& generators_;
+  Stage stage_ = Stage::kHashMove;
+  size_t killer_index_ = 0;
+  std::vector<Move> generated_;
+  std::vector<ScoredMove> scored_;
+  size_t next_scored_ = 0;
+  std::vector<Move> bad_captures_;
+  size_t next_bad_capture_ = 0;
+};
+
+}  // namespace bomchess
+
+#endif  // MOVEPICKER_H
@@ -0,0 +1,107 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <span>
+#include <vector>
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+enum class SimdLevel { kScalar, kSse2, kAvx2 };
+
+/**
+ * The first layer of the network for one position, seen from both sides. Keep one per position in a search and update
+ * it with AddPiece and RemovePiece as moves are made and unmade, instead of rebuilding it from the whole position.
+ */
+struct NnueAccumulator {
+  std::vector<int16_t> white_perspective;
+  std::vector<int16_t> black_perspective;
+
+  bool operator==(const NnueAccumulator&) const = default;
+};
+
+/**
+ * A quantized (768 -> N) x 2 -> 1 network. Each side's perspective has 768 inputs, one per piece type, color (own or
+ * opponent's) and square, with the board mirrored vertically for black. The side to move's hidden layer is followed
+ * by the other side's, both clipped to [0, 255], and dotted with the output weights.
+ *
+ * File format, all values little endian:
+ * "BNUE", uint32 N, int16 feature weights[768][N], int16 feature biases[N], int16 output weights[2 * N], int32 output
+ * bias. Feature index = (own piece ? 0 : 384) + PieceType * 64 + Square, with squares numbered as in square.h.
+ */
+class NnueNetwork {
+ public:
+  /**
+   * @exception std::runtime_error if the file can't be read or is not a valid network.
+   */
+  explicit NnueNetwork(const std::filesystem::path& path);
+
+  /**
+   * @exception std::runtime_error if the stream doesn't hold a valid network.
+   */
+  explicit NnueNetwork(std::istream& network_stream);
+
+  [[nodiscard]] int HiddenSize() const noexcept;
+
+  /**
+   * @return The fastest forward pass kernel this CPU supports. This is the level new networks start with.
+   */
+  [[nodiscard]] static SimdLevel SupportedSimdLevel() noexcept;
+  [[nodiscard]] SimdLevel GetSimdLevel() const noexcept;
+  /**
+   * @exception std::invalid_argument if this CPU doesn't support the level.
+   */
+  void SetSimdLevel(SimdLevel simd_level);
+
+  /**
+   * Builds an accumulator from scratch.
+   * @exception std::invalid_argument if the position contains invalid pieces.
+   */
+  [[nodiscard]] NnueAccumulator MakeAccumulator(const Position& position) const;
+
+  /**
+   * @exception std::invalid_argument if the piece or square is invalid, or the piece is kNone.
+   */
+  void AddPiece(NnueAccumulator& accumulator, Piece piece, Square square) const;
+
+  /**
+   * @exception std::invalid_argument if the piece or square is invalid, or the piece is kNone.
+   */
+  void RemovePiece(NnueAccumulator& accumulator, Piece piece, Square square) const;
+
+  /**
+   * @return The evaluation in centipawns from the side to move's point of view.
+   * @exception std::invalid_argument if side_to_move is kNone.
+   */
+  [[nodiscard]] int Evaluate(const NnueAccumulator& accumulator, Color side_to_move) const;
+
+  /**
+   * Evaluates many positions. Each accumulator is updated from the previous position rather than rebuilt, so
+   * positions that follow each other in a game are much cheaper than unrelated ones.
+   * @exception std::invalid_argument if the spans have different sizes, a side to move is kNone, or a position
+   * contains invalid pieces.
+   */
+  [[nodiscard]] std::vector<int> EvaluateBatch(std::span<const Position> positions,
+                                               std::span<const Color> sides_to_move) const;
+
+ private:
+  void Load(std::istream& network_stream);
+  void UpdateFeature(NnueAccumulator& accumulator, Piece piece, Square square, int sign) const;
+
+  int hidden_size_ = 0;
+  std::vector<int16_t> feature_weights_;
+  std::vector<int16_t> feature_biases_;
+  std::vector<int16_t> output_weights_;
+  int32_t output_bias_ = 0;
+  SimdLevel simd_level_ = SupportedSimdLevel();
+};
+
+}  // namespace bomchess
+
+#endif  // NNUE_H
@@ -0,0 +1,73 @@
+#ifndef PGNANNOTATIONS_H
+#define PGNANNOTATIONS_H
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bomchess {
+/**
+ * Marks a move without the annotation.
+ */
+constexpr int32_t kNoAnnotation = std::numeric_limits<int32_t>::min();
+/**
+ * Evaluations at or beyond +/- (kMateEvaluation - 1000) are mates, see MateEvaluation.
+ */
+constexpr int32_t kMateEvaluation = 1000000;
+
+/**
+ * The extended PGN command annotations found in comments, as numbers with one entry per move. Moves without a command
+ * hold kNoAnnotation, and a vector is left empty when no move has that command.
+ */
+struct MoveAnnotations {
+  /**
+   * [%clk h:mm:ss] The mover's remaining time in milliseconds.
+   */
+  std::vector<int32_t> clock_ms{};
+  /**
+   * [%emt h:mm:ss] Time spent on the move in milliseconds.
+   */
+  std::vector<int32_t> elapsed_ms{};
+  /**
+   * [%eval 0.17] or [%eval #-3] Centipawns from white's point of view, mates as given by MateEvaluation. A search
+   * depth, as in [%eval 0.17,20], is dropped.
+   */
+  std::vector<int32_t> evaluation{};
+};
+
+/**
+ * @param moves Positive if white mates, negative if black mates.
+ * @return kMateEvaluation - moves for white, -(kMateEvaluation - moves) for black, so quicker mates are more extreme.
+ */
+[[nodiscard]] constexpr int32_t MateEvaluation(const int32_t moves) noexcept {
+  return moves >= 0 ? kMateEvaluation - moves : -kMateEvaluation - moves;
+}
+
+[[nodiscard]] constexpr bool IsMateEvaluation(const int32_t evaluation) noexcept {
+  return evaluation != kNoAnnotation &&
+         (evaluation >= kMateEvaluation - 1000 || evaluation <= -(kMateEvaluation - 1000));
+}
+
+/**
+ * @param clock "h:mm:ss", "m:ss" or "ss", each optionally with a decimal fraction of a second.
+ * @return Milliseconds, or std::nullopt if the text is malformed.
+ */
+[[nodiscard]] std::optional<int32_t> ParseClock(std::string_view clock) noexcept;
+
+/**
+ * @param evaluation Pawns ("-1.35") or a mate ("#4", "#-2"). Anything after a ',' (such as a search depth) is ignored.
+ * @return The evaluation as stored in MoveAnnotations, or std::nullopt if the text is malformed.
+ */
+[[nodiscard]] std::optional<int32_t> ParseEvaluation(std::string_view evaluation) noexcept;
+
+/**
+ * Appends the move's commands, such as "[%eval 0.17] [%clk 0:03:00]", for every annotation it has.
+ */
+void AppendAnnotations(const MoveAnnotations& annotations, size_t move, std::string& buffer);
+
+}  // namespace bomchess
+
+#endif  // PGNANNOTATIONS_H
@@ -0,0 +1,139 @@
+#ifndef PGNSCANNER_H
+#define PGNSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "color.h"
+#include "game.h"
+#include "pgnannotations.h"
+#include "pgnwriter.h"
+
+namespace bomchess {
+/**
+ * A game found by PgnScanner. Its tags are parsed when it is scanned, its movetext stays raw text until the moves,
+ * comments or termination marker are asked for. Filtering on tags therefore never pays for parsing the movetext of the
+ * games it rejects. The movetext points into the scanned text, which must outlive the game.
+ */
+class LazyPgnGame {
+ public:
+  [[nodiscard]] const TagPairs& Tags() const noexcept;
+  /**
+   * @return The value of the tag, or "" if the tag is not set.
+   */
+  [[nodiscard]] std::string_view GetTag(std::string_view name) const noexcept;
+  /**
+   * @return The movetext as written, including the termination marker.
+   */
+  [[nodiscard]] std::string_view Movetext() const noexcept;
+  /**
+   * @return Where the game starts in the scanned text.
+   */
+  [[nodiscard]] size_t Offset() const noexcept;
+  [[nodiscard]] bool IsMovetextParsed() const noexcept;
+
+  /**
+   * @return The main line in SAN, without move numbers, NAGs or "!" and "?" suffixes. Variations are skipped.
+   */
+  [[nodiscard]] std::span<const std::string> SanMoves();
+  /**
+   * @return One comment per move, the text of every comment following it joined by spaces, "" if there is none.
+   */
+  [[nodiscard]] std::span<const std::string> Comments();
+  /**
+   * @return The [%clk], [%emt] and [%eval] commands of every move as numbers, spread out per move on the first call.
+   * While parsing the movetext these commands are cut out of the comments, unless their value is malformed, in which
+   * case they stay in the comment text. The depth after an evaluation, as in [%eval 0.17,20], is not kept here.
+   */
+  [[nodiscard]] const MoveAnnotations& Annotations();
+  /**
+   * @return The commands cut out of the comments, as written, so "[%eval 0.17,20]" keeps its depth.
+   */
+  [[nodiscard]] std::span<const PgnCommand> Commands();
+  /**
+   * @return Comments before the first move.
+   */
+  [[nodiscard]] std::string_view InitialComment();
+  /**
+   * @return "1-0", "0-1", "1/2-1/2", "*" or "" if the movetext has no termination marker.
+   */
+  [[nodiscard]] std::string_view Termination();
+  /**
+   * @return The game ready for AppendPGN. The move number and color to move of the first move are taken from the
+   * movetext, so a game written from a set up position keeps its numbering. The commands are passed on as written
+   * rather than as annotations, so viewing a game decodes nothing. A move number too large for an int is
+   * ignored, and the game is numbered from 1 with White to move.
+   */
+  [[nodiscard]] PgnGameView View();
+
+ private:
+  friend class PgnScanner;
+
+  LazyPgnGame(TagPairs tags, std::string_view movetext, size_t offset);
+
+  enum class AnnotationType { kClock, kElapsed, kEvaluation };
+
+  struct AnnotationCommand {
+    AnnotationType type;
+    int32_t value;
+  };
+
+  void ParseMovetext();
+  void AddComment(std::string_view comment);
+
+  TagPairs tags_;
+  std::string_view movetext_;
+  size_t offset_ = 0;
+  bool parsed_ = false;
+  std::vector<std::string> san_moves_;
+  std::vector<std::string> comments_;
+  std::string initial_comment_;
+  std::string_view termination_;
+  std::vector<PgnCommand> commands_;
+  // The value of each of commands_, checked when the command was cut out of its comment.
+  std::vector<AnnotationCommand> annotation_commands_;
+  bool annotations_decoded_ = false;
+  MoveAnnotations annotations_;
+  int first_move_number_ = 1;
+  Color first_to_move_ = Color::kWhite;
+};
+
+/**
+ * Splits PGN text into games, one at a time. Only the tag sections are parsed, the movetext of each game is just
+ * scanned for its end: the termination marker outside of comments and variations, or the next tag section.
+ */
+class PgnScanner {
+ public:
+  /**
+   * @param pgn Must outlive the scanner and every game it returns.
+   * @param memory_resource Tags are allocated from it.
+   */
+  explicit PgnScanner(std::string_view pgn,
+                      std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource());
+
+  /**
+   * @return The next game, or std::nullopt once the text is used up.
+   * @exception std::invalid_argument if a tag is malformed, or the text ends inside a tag or comment. The scanner can't
+   * continue afterwards.
+   */
+  [[nodiscard]] std::optional<LazyPgnGame> Next();
+
+ private:
+  void SkipWhitespace() noexcept;
+  [[nodiscard]] TagPairs ScanTags();
+  [[nodiscard]] size_t ScanMovetext();
+
+  std::string_view pgn_;
+  size_t position_ = 0;
+  std::pmr::memory_resource* memory_resource_;
+};
+
+}  // namespace bomchess
+
+#endif  // PGNSCANNER_H
@@ -0,0 +1,92 @@
+#ifndef PGNWRITER_H
+#define PGNWRITER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "color.h"
+#include "game.h"
+#include "pgnannotations.h"
+
+namespace bomchess {
+/**
+ * A command such as "[%eval 0.17,20]", written verbatim.
+ */
+struct PgnCommand {
+  size_t move = 0;
+  std::string_view text{};
+};
+
+/**
+ * Everything an exported game is written from. None of it is owned, so the tags, moves and comments must outlive the
+ * view. Moves are given in SAN, ready to be written.
+ */
+struct PgnGameView {
+  const TagPairs* tags = nullptr;
+  std::span<const std::string> san_moves{};
+  /**
+   * Either empty or one comment per move, written after it. An empty comment is skipped.
+   */
+  std::span<const std::string> comments{};
+  int first_move_number = 1;
+  Color first_to_move = Color::kWhite;
+  /**
+   * Optional, written as commands at the start of each move's comment.
+   */
+  const MoveAnnotations* annotations = nullptr;
+  /**
+   * Optional, sorted by move. Written after the annotations and before the comment of their move, so commands read
+   * from a PGN file are copied out without being decoded.
+   */
+  std::span<const PgnCommand> commands{};
+};
+
+/**
+ * Appends the game in PGN export format: the Seven Tag Roster in order ("?" for missing tags), the supplemental tags,
+ * a blank line, then the movetext wrapped to lines of at most kPgnLineLength characters, ending with the result and a
+ * blank line.
+ * @exception std::invalid_argument if the view has no tags, the comment or annotation count doesn't match the move
+ * count, a command is out of order or for a move past the end, a comment or command contains '}', or the first color to
+ * move is kNone.
+ */
+void AppendPGN(const PgnGameView& game, std::string& buffer);
+
+constexpr size_t kPgnLineLength = 80;
+
+/**
+ * Writes many games to one PGN file. Games are formatted in chunks on a pool of threads, each into its own buffer, and
+ * the buffers are written to the file in game order with unbuffered writes to the file descriptor. Only a bounded
+ * number of formatted chunks wait for the file at once.
+ */
+class PgnWriter {
+ public:
+  /**
+   * Creates or truncates the file.
+   * @param thread_count Formatting threads. 0 is treated as 1.
+   * @exception std::runtime_error if the file can't be opened.
+   */
+  explicit PgnWriter(const std::filesystem::path& path, unsigned thread_count);
+  PgnWriter(const PgnWriter&) = delete;
+  PgnWriter& operator=(const PgnWriter&) = delete;
+  ~PgnWriter();
+
+  /**
+   * Appends the games to the file, in order.
+   * @exception std::invalid_argument if a game can't be formatted, see AppendPGN. Games before its chunk are written.
+   * @exception std::runtime_error if writing to the file fails.
+   */
+  void Write(std::span<const PgnGameView> games);
+
+ private:
+  void WriteBuffer(std::string_view buffer) const;
+
+  int file_descriptor_ = -1;
+  unsigned thread_count_ = 1;
+};
+
+}  // namespace bomchess
+
+#endif  // PGNWRITER_H
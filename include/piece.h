@@ -28,6 +28,27 @@ struct Piece {
 
 std::ostream& operator<<(std::ostream& os, Piece piece) noexcept;
 
+/**
+ * @return The material value of the piece type in centipawns. Kings can never be captured, so they are worth 0, as is
+ * PieceType::kNone.
+ */
+[[nodiscard]] constexpr int PieceValue(const PieceType piece_type) noexcept {
+  switch (piece_type) {
+    case PieceType::kPawn:
+      return 100;
+    case PieceType::kKnight:
+      return 320;
+    case PieceType::kBishop:
+      return 330;
+    case PieceType::kRook:
+      return 500;
+    case PieceType::kQueen:
+      return 900;
+    default:
+      return 0;
+  }
+}
+
 namespace pieces {
 constexpr Piece kWhitePawn{Color::kWhite, PieceType::kPawn};
 constexpr Piece kWhiteRook{Color::kWhite, PieceType::kRook};
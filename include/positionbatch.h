@@ -0,0 +1,89 @@
+#ifndef POSITIONBATCH_H
+#define POSITIONBATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bitboard.h"
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+
+namespace bomchess {
+/**
+ * Many positions stored column wise: one bitboard column per piece, where row i of every column belongs to position i.
+ * The bulk queries run over whole columns of contiguous memory in branch free loops the compiler can vectorize, rather
+ * than visiting the 64 squares of one Position after another.
+ */
+class PositionBatch {
+ public:
+  PositionBatch() = default;
+  /**
+   * @exception std::invalid_argument if a position contains invalid pieces.
+   */
+  explicit PositionBatch(std::span<const Position> positions);
+
+  bool operator==(const PositionBatch&) const = default;
+
+  /**
+   * @exception std::invalid_argument if the position contains invalid pieces.
+   */
+  void Add(const Position& position);
+  /**
+   * @exception std::out_of_range if the index is not less than Size().
+   */
+  [[nodiscard]] Position Get(size_t index) const;
+  [[nodiscard]] size_t Size() const noexcept;
+  void Reserve(size_t size);
+  void Clear() noexcept;
+
+  /**
+   * @return The piece's bitboard in every position.
+   * @exception std::invalid_argument if the piece is invalid or kNone.
+   */
+  [[nodiscard]] std::span<const Bitboard> Column(Piece piece) const;
+
+  /**
+   * @exception std::invalid_argument if the piece is invalid or kNone.
+   */
+  [[nodiscard]] std::vector<uint8_t> PieceCounts(Piece piece) const;
+  /**
+   * @return White's material minus black's in centipawns (see PieceValue) for every position.
+   */
+  [[nodiscard]] std::vector<int> MaterialBalance() const;
+
+  /**
+   * Appends the piece-square features of every position, in position order, as used by NnueNetwork from white's
+   * perspective: piece type * 64 + square, plus 384 for black pieces. offsets gets Size() + 1 entries, the features of
+   * position i are features[offsets[i]] up to features[offsets[i + 1]].
+   */
+  void PieceSquareFeatures(std::vector<uint16_t>& features, std::vector<uint32_t>& offsets) const;
+
+  /**
+   * @return 1 for every position where a king of the color is attacked, else 0. Positions without a king of that color
+   * are never in check.
+   * @exception std::invalid_argument if the color is kNone or invalid.
+   */
+  [[nodiscard]] std::vector<uint8_t> KingInCheck(Color color) const;
+
+  /**
+   * @return A 64 bit hash of every position. Equal positions hash equal, in any batch.
+   */
+  [[nodiscard]] std::vector<uint64_t> Hashes() const;
+  /**
+   * @return 1 for every position equal to the position at the same index of the other batch, else 0.
+   * @exception std::invalid_argument if the batches differ in size.
+   */
+  [[nodiscard]] std::vector<uint8_t> Equal(const PositionBatch& other) const;
+
+ private:
+  // Indexed by color * 6 + piece type.
+  std::array<std::vector<Bitboard>, 12> columns_;
+};
+
+}  // namespace bomchess
+
+#endif  // POSITIONBATCH_H
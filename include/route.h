@@ -0,0 +1,58 @@
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+/**
+ * The distance to a square the piece can never reach.
+ */
+constexpr int8_t kUnreachable = -1;
+
+/**
+ * @return The fewest moves the piece needs to get from one square to the other on an otherwise empty board, or
+ * kUnreachable. Looked up in tables built at compile time. Pawns only push, straight up the board for white and down
+ * for black, two squares at once from their starting rank.
+ * @exception std::invalid_argument if the piece is invalid or kNone, or either square is invalid.
+ */
+[[nodiscard]] int8_t PieceDistance(Piece piece, Square from, Square to);
+
+struct PieceRoute {
+  int8_t distance = kUnreachable;
+  /**
+   * One shortest route, starting with the from square and ending with the to square. Empty if unreachable.
+   */
+  std::vector<Square> squares;
+};
+
+/**
+ * Finds the shortest route for the piece on the from square while every other piece stays where it is. The piece may
+ * not move through or onto other pieces, except for capturing an opposing piece on the to square. Pawns can only make
+ * that capture diagonally. Checks are ignored.
+ * @exception std::invalid_argument if either square is invalid or there is no piece on the from square.
+ */
+[[nodiscard]] PieceRoute FindRoute(const Position& position, Square from, Square to);
+
+/**
+ * Route distances, under the rules of FindRoute, from the piece on the from square to every square. Costs one search
+ * however many squares are used.
+ * @exception std::invalid_argument if the square is invalid or there is no piece on it.
+ */
+[[nodiscard]] std::array<int8_t, 64> RouteDistances(const Position& position, Square from);
+
+/**
+ * RouteDistances for every piece in the position, indexed by the piece's square. Rows for empty squares are all
+ * kUnreachable.
+ * @exception std::invalid_argument if the position contains invalid pieces.
+ */
+[[nodiscard]] std::array<std::array<int8_t, 64>, 64> RouteDistances(const Position& position);
+
+}  // namespace bomchess
+
+#endif  // ROUTE_H
@@ -0,0 +1,136 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "move.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "transpositiontable.h"
+
+namespace bomchess {
+constexpr int kMaxSearchDepth = 64;
+
+/**
+ * Scores are in centipawns from the side to move's point of view. A score of kMateScore - n means the side to move
+ * mates in n plies, -(kMateScore - n) that it is mated in n plies.
+ */
+constexpr int kMateScore = 32000;
+
+/**
+ * When a search stops. Unset limits are std::nullopt, and a search with no limits runs to kMaxSearchDepth or until
+ * Searcher::Stop is called.
+ */
+struct SearchLimits {
+  std::optional<int> depth{};
+  std::optional<uint64_t> nodes{};
+  /**
+   * In milliseconds.
+   */
+  std::optional<int64_t> move_time{};
+};
+
+enum class SearchStopReason { kDepth, kNodes, kTime, kStopped };
+
+/**
+ * The result of one completed iteration of iterative deepening.
+ */
+struct SearchInfo {
+  int depth = 0;
+  int score = 0;
+  /**
+   * Nodes searched so far by every thread.
+   */
+  uint64_t nodes = 0;
+  /**
+   * Milliseconds since the search started.
+   */
+  int64_t time = 0;
+  std::vector<Move> principal_variation;
+};
+
+struct SearchResult {
+  /**
+   * kNullMove if the side to move has no legal moves.
+   */
+  Move best_move = kNullMove;
+  SearchInfo info;
+  SearchStopReason stop_reason = SearchStopReason::kDepth;
+};
+
+/**
+ * Progress reports from Searcher::Search. Both are called on the thread that called Search, and may call
+ * Searcher::Stop. Unset callbacks are skipped.
+ */
+struct SearchCallbacks {
+  /**
+   * Called after every completed iteration.
+   */
+  std::function<void(const SearchInfo&)> iteration;
+  /**
+   * Called once when the search ends, with the limit that ended it.
+   */
+  std::function<void(SearchStopReason reason, const SearchInfo& info)> stopped;
+};
+
+/**
+ * An alpha-beta search evaluating positions with an NNUE network. Iterative deepening with aspiration windows drives a
+ * principal variation search, which ends each line in a quiescence search of captures and uses null move pruning and
+ * late move reductions to spend less time on moves that are unlikely to matter. Moves are ordered by MovePicker.
+ *
+ * Searches run on several threads with Lazy SMP: every thread searches the same position independently, and they share
+ * work only through the transposition table. Repetitions are only detected within the searched lines, the moves that
+ * led to the root position are not known. Neither is the 50 move counter, so the rule is not applied.
+ */
+class Searcher {
+ public:
+  /**
+   * The network and transposition table must outlive the searcher. The table keeps its entries between searches, so
+   * clear it when switching to unrelated positions if old entries shouldn't be used.
+   * @param thread_count The calling thread plus thread_count - 1 helper threads started for each search.
+   * @exception std::invalid_argument if thread_count is less than 1.
+   */
+  Searcher(const NnueNetwork& network, TranspositionTable& table, int thread_count = 1);
+  Searcher(const Searcher&) = delete;
+  Searcher& operator=(const Searcher&) = delete;
+
+  /**
+   * Searches the position until a limit is reached, blocking until it has. The result is the best move of the last
+   * completed iteration, or of the first legal move if not even the first iteration completed. A Stop() from before
+   * the call ends the search at once, and stops up to the end of the stopped callback are cleared before returning.
+   * @exception std::invalid_argument if the depth limit is less than 1, the side to move is kNone or invalid, or either
+   * side has no king.
+   */
+  SearchResult Search(const PositionState& state, const SearchLimits& limits, const SearchCallbacks& callbacks = {});
+
+  /**
+   * Ends the running search, which returns the result it has so far. Called while no search is running, it ends the
+   * next one as soon as it starts, so a stop sent right after a search was handed to another thread is not lost. Safe
+   * to call from any thread, including from the search callbacks.
+   */
+  void Stop() noexcept;
+
+ private:
+  class Worker;
+
+  // true if this call stopped the search.
+  bool RequestStop(SearchStopReason reason) noexcept;
+  // Readies the stop flag for the next search.
+  void ClearStop() noexcept;
+
+  const NnueNetwork& network_;
+  TranspositionTable& table_;
+  int thread_count_;
+  std::atomic<bool> stop_ = false;
+  std::atomic<SearchStopReason> stop_reason_ = SearchStopReason::kDepth;
+  // Nodes counted by every thread, added in batches.
+  std::atomic<uint64_t> nodes_ = 0;
+};
+
+}  // namespace bomchess
+
+#endif  // SEARCH_H
@@ -0,0 +1,29 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "move.h"
+#include "position.h"
+
+namespace bomchess {
+/**
+ * Static exchange evaluation. Plays out every capture on the move's target square, least valuable attacker first, with
+ * either side free to stop capturing when it is ahead, and returns the material the moving side ends up with in
+ * centipawns (see PieceValue). Sliders hidden behind other attackers join in once the pieces in front of them have
+ * captured. Pins and checks are ignored, except that a king never captures onto a square that is still defended.
+ *
+ * The side to move is the color of the piece on the move's from square. A pawn moving diagonally onto an empty square
+ * is treated as en passant. Quiet moves can be evaluated too, a negative result means the piece can be won.
+ * @exception std::invalid_argument if the move's squares are invalid or there is no piece on the from square.
+ */
+[[nodiscard]] int SEE(const Position& position, Move move);
+
+/**
+ * Equivalent to SEE(position, move) >= threshold, but stops as soon as the answer is known. Use this for pruning and
+ * for sorting captures into winning and losing ones.
+ * @exception std::invalid_argument if the move's squares are invalid or there is no piece on the from square.
+ */
+[[nodiscard]] bool SEEGreaterEqual(const Position& position, Move move, int threshold);
+
+}  // namespace bomchess
+
+#endif  // SEE_H
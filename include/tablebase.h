@@ -0,0 +1,134 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#include "color.h"
+#include "move.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+/**
+ * The largest number of pieces (kings included) that any Syzygy table covers.
+ */
+constexpr int kMaxTablebasePieces = 7;
+
+enum class TablebaseType { kWdl, kDtz };
+
+/**
+ * A tablebase result for the side to move. Cursed wins and blessed losses are decided by the 50 move rule: the win
+ * takes more than 50 moves without a capture or pawn move, so with the rule the game is drawn.
+ */
+enum class WdlScore { kLoss = -2, kBlessedLoss = -1, kDraw = 0, kCursedWin = 1, kWin = 2 };
+
+/**
+ * @return The name of the Syzygy table covering the position's material, with the stronger side first. (ex. "KQvKR")
+ * The name is the same no matter which color holds the stronger material.
+ * @exception std::invalid_argument if the position doesn't have exactly one king of each color, contains invalid
+ * pieces, or has more than kMaxTablebasePieces pieces.
+ */
+[[nodiscard]] std::string SyzygyTableName(const Position& position);
+
+/**
+ * A directory of Syzygy table files. Table files are found when the tablebase is constructed, but are not opened or
+ * memory mapped until a position using them is first looked up. All const member functions are safe to call from
+ * multiple threads at once.
+ *
+ * Syzygy tables store an arbitrary value for a position where a capture, en passant included, is the best move, and
+ * DTZ tables also where a winning pawn move is. So every probe first runs an alpha-beta search over the captures,
+ * probing the positions they lead to, and only trusts the stored value when it is better than all of them. Positions
+ * are taken to have no castling rights, which no table covers.
+ */
+class Tablebase {
+ public:
+  /**
+   * @exception std::invalid_argument if the directory does not exist.
+   */
+  explicit Tablebase(const std::filesystem::path& directory);
+  Tablebase(const Tablebase&) = delete;
+  Tablebase& operator=(const Tablebase&) = delete;
+  Tablebase(Tablebase&&) noexcept;
+  Tablebase& operator=(Tablebase&&) noexcept;
+  ~Tablebase();
+
+  /**
+   * @return The piece count of the largest table found, or 0 if no tables were found.
+   */
+  [[nodiscard]] int MaxPieces() const noexcept;
+
+  /**
+   * @return true if a table of the given type covers the position's material. Does not open the table.
+   * @exception std::invalid_argument if the position is not a valid tablebase position. See SyzygyTableName.
+   */
+  [[nodiscard]] bool HasTable(const Position& position, TablebaseType type) const;
+
+  /**
+   * Memory maps the table covering the position on first use. Later calls return the same mapping.
+   * @return The raw bytes of the table file, including its header.
+   * @exception std::invalid_argument if the position is not a valid tablebase position or no table covers it.
+   * @exception std::runtime_error if the table file can't be mapped or is not a Syzygy table of the given type.
+   */
+  [[nodiscard]] std::span<const std::byte> TableData(const Position& position, TablebaseType type) const;
+
+  /**
+   * The result with best play, from the WDL table of the position and those of the positions its captures lead to. Two
+   * bare kings are a draw without a table.
+   * @param en_passant The square behind a pawn that just moved two squares, or Square::kNone.
+   * @exception std::invalid_argument if the position is not a valid tablebase position, the color is kNone or invalid,
+   * or a WDL table needed is missing.
+   * @exception std::runtime_error if a table file can't be mapped or is corrupt.
+   */
+  [[nodiscard]] WdlScore ProbeWdl(const Position& position, Color side_to_move, Square en_passant) const;
+
+  /**
+   * Looks the position up in its DTZ table. A DTZ table only stores one side to move, so for the other side this
+   * searches the legal moves one ply deep, probing the positions after them.
+   * @param en_passant The square behind a pawn that just moved two squares, or Square::kNone.
+   * @return Plies to the next capture or pawn move with best play, positive if the side to move wins and negative if
+   * it loses, 0 for a draw. Cursed wins and blessed losses are 100 further from 0.
+   * @exception std::invalid_argument if the position is not a valid tablebase position, the color is kNone or invalid,
+   * or a WDL or DTZ table needed is missing.
+   * @exception std::runtime_error if a table file can't be mapped or is corrupt.
+   */
+  [[nodiscard]] int ProbeDtz(const Position& position, Color side_to_move, Square en_passant) const;
+
+  /**
+   * Picks the legal move that keeps the best result: the quickest win, otherwise a draw, otherwise the slowest loss.
+   * Captures and pawn moves are ranked with the WDL table of the position they lead to, other moves with the DTZ
+   * table. The 50 move counter is not known, so a win is not preferred for fitting within it.
+   * @param en_passant The square behind a pawn that just moved two squares, or Square::kNone.
+   * @return The move, or std::nullopt if the side to move has no legal moves.
+   * @exception std::invalid_argument if the position is not a valid tablebase position, the color is kNone or invalid,
+   * or a table needed is missing.
+   * @exception std::runtime_error if a table file can't be mapped or is corrupt.
+   */
+  [[nodiscard]] std::optional<Move> BestMove(const Position& position, Color side_to_move, Square en_passant) const;
+
+ private:
+  struct TableFile;
+  struct TableLayout;
+
+  [[nodiscard]] const TableLayout& Layout(const Position& position, TablebaseType type) const;
+  [[nodiscard]] WdlScore ProbeWdlTable(const Position& position, Color side_to_move) const;
+
+  // The alpha-beta search over captures, plus pawn moves if pawn_moves is set, that resolves the positions the tables
+  // store arbitrary values for. zeroing_best is set if the best move is one of those searched, or if they are the only
+  // moves, as the DTZ table's value can't be used then. Only exact with the full window.
+  [[nodiscard]] WdlScore Search(const Position& position, Color side_to_move, Square en_passant, WdlScore alpha,
+                                WdlScore beta, bool pawn_moves, bool& zeroing_best) const;
+
+  std::unordered_map<std::string, std::unique_ptr<TableFile>> wdl_tables_;
+  std::unordered_map<std::string, std::unique_ptr<TableFile>> dtz_tables_;
+  int max_pieces_ = 0;
+};
+
+}  // namespace bomchess
+
+#endif  // TABLEBASE_H
@@ -0,0 +1,134 @@
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mappedfile.h"
+
+namespace bomchess {
+/**
+ * @return The PGN date ("YYYY.MM.DD") as the integer YYYYMMDD. Unknown ("??") or malformed month and day parts are 0,
+ * as is the whole date if the year is unknown, so dates compare in calendar order.
+ */
+[[nodiscard]] int32_t ParsePgnDate(std::string_view date) noexcept;
+
+/**
+ * The dictionary encoded string columns of a TagIndex.
+ */
+enum class TagColumn { kWhite, kBlack, kEvent, kECO };
+
+/**
+ * Indexes the tags of every game in the PGN text and writes the index file. Only the tag sections are parsed.
+ * @exception std::invalid_argument if the PGN text has a malformed tag.
+ * @exception std::runtime_error if the index file can't be written.
+ */
+void BuildTagIndex(std::string_view pgn, const std::filesystem::path& index_path);
+
+/**
+ * Inclusive bounds. A missing Elo or date is 0.
+ */
+struct TagRange {
+  int32_t min = std::numeric_limits<int32_t>::min();
+  int32_t max = std::numeric_limits<int32_t>::max();
+};
+
+/**
+ * A game matches if it passes every condition that is set. String conditions match the whole tag value.
+ */
+struct TagFilter {
+  std::optional<TagRange> white_elo{};
+  std::optional<TagRange> black_elo{};
+  std::optional<TagRange> date{};
+  std::optional<std::string> white{};
+  std::optional<std::string> black{};
+  /**
+   * Matches games where either player has this name.
+   */
+  std::optional<std::string> player{};
+  std::optional<std::string> event{};
+  /**
+   * ECO codes from the first to the last, inclusive, such as {"B90", "B99"}.
+   */
+  std::optional<std::array<std::string, 2>> eco{};
+};
+
+/**
+ * The tags of a PGN database in columns, one row per game, memory mapped from a file written by BuildTagIndex. Elo
+ * ratings and dates are stored as integers. Player, event and ECO strings are replaced by ids into a sorted dictionary
+ * per column, so every filter becomes integer comparisons over contiguous columns, which the compiler vectorizes.
+ */
+class TagIndex {
+ public:
+  /**
+   * @exception std::runtime_error if the file can't be mapped or is not a tag index.
+   */
+  explicit TagIndex(const std::filesystem::path& path);
+
+  [[nodiscard]] size_t Size() const noexcept;
+
+  /**
+   * @return Where each game starts in the indexed PGN text.
+   */
+  [[nodiscard]] std::span<const uint64_t> Offsets() const noexcept;
+  [[nodiscard]] std::span<const uint16_t> WhiteElo() const noexcept;
+  [[nodiscard]] std::span<const uint16_t> BlackElo() const noexcept;
+  /**
+   * @return Dates as given by ParsePgnDate.
+   */
+  [[nodiscard]] std::span<const int32_t> Dates() const noexcept;
+  /**
+   * @return The dictionary id of every game's value. Ids are ordered like the strings they stand for. Missing tags
+   * have the id of "".
+   */
+  [[nodiscard]] std::span<const uint32_t> Ids(TagColumn column) const noexcept;
+
+  /**
+   * @exception std::out_of_range if the id is not in the column's dictionary.
+   */
+  [[nodiscard]] std::string_view Value(TagColumn column, uint32_t id) const;
+  /**
+   * @return The id of the value, or std::nullopt if no game has it.
+   */
+  [[nodiscard]] std::optional<uint32_t> FindId(TagColumn column, std::string_view value) const;
+
+  /**
+   * @return The ids (row numbers) of the games matching the filter, in ascending order. Offsets() maps them back into
+   * the PGN text.
+   */
+  [[nodiscard]] std::vector<uint32_t> Filter(const TagFilter& filter) const;
+
+ private:
+  [[nodiscard]] uint32_t DictionarySize(TagColumn column) const noexcept;
+  /**
+   * @return The first id whose value is not less than (or with after_equal, greater than) the value.
+   */
+  [[nodiscard]] uint32_t LowerBound(TagColumn column, std::string_view value, bool after_equal) const;
+
+  struct Dictionary {
+    std::span<const uint64_t> offsets;
+    std::string_view strings;
+  };
+
+  std::unique_ptr<MappedFile> file_;
+  size_t size_ = 0;
+  std::span<const uint64_t> offsets_;
+  std::span<const uint16_t> white_elo_;
+  std::span<const uint16_t> black_elo_;
+  std::span<const int32_t> dates_;
+  std::array<std::span<const uint32_t>, 4> ids_;
+  std::array<Dictionary, 4> dictionaries_;
+};
+
+}  // namespace bomchess
+
+#endif  // TAGINDEX_H
@@ -0,0 +1,67 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "move.h"
+
+namespace bomchess {
+/**
+ * How a stored score relates to the true score of the position.
+ */
+enum class Bound { kNone, kUpper, kLower, kExact };
+
+struct TranspositionEntry {
+  Move move;
+  int16_t score;
+  int8_t depth;
+  Bound bound;
+
+  constexpr bool operator==(const TranspositionEntry&) const = default;
+};
+
+/**
+ * A fixed size hash table of search results, shared by every search thread. Store and Probe never lock. Each slot keeps
+ * its key xor'd with its data, so an entry torn by two threads writing at once fails the key check instead of being
+ * returned with mixed up fields.
+ */
+class TranspositionTable {
+ public:
+  /**
+   * @param size_in_megabytes The table is rounded down to a power of two number of entries.
+   * @exception std::invalid_argument if the size is too small to hold a single entry.
+   */
+  explicit TranspositionTable(size_t size_in_megabytes);
+
+  /**
+   * Replaces the entry in the key's slot if the slot holds a different position, or a search that was not deeper.
+   * @exception std::invalid_argument if the entry's move has invalid squares or promotion.
+   */
+  void Store(uint64_t key, const TranspositionEntry& entry);
+
+  [[nodiscard]] std::optional<TranspositionEntry> Probe(uint64_t key) const noexcept;
+
+  /**
+   * Not thread safe, no search may be running.
+   */
+  void Clear() noexcept;
+
+  [[nodiscard]] size_t EntryCount() const noexcept;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> checked_key;
+    std::atomic<uint64_t> data;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t entry_count_;
+};
+
+}  // namespace bomchess
+
+#endif  // TRANSPOSITIONTABLE_H
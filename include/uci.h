@@ -0,0 +1,132 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "move.h"
+#include "movegen.h"
+
+namespace bomchess {
+/**
+ * The FEN the position command uses for "startpos".
+ */
+constexpr std::string_view kUciStartPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+/**
+ * Reads a FEN as given to the position command. The halfmove clock is ignored, and the two move counters may be left
+ * out. The ply is counted from the full move number.
+ * @exception std::invalid_argument if the FEN is malformed.
+ */
+[[nodiscard]] PositionState ParseFen(std::string_view fen);
+
+/**
+ * The arguments of a UCI go command. Times are in milliseconds. Unset limits are std::nullopt.
+ */
+struct GoParameters {
+  std::vector<Move> search_moves;
+  bool ponder = false;
+  bool infinite = false;
+  std::optional<int64_t> white_time;
+  std::optional<int64_t> black_time;
+  std::optional<int64_t> white_increment;
+  std::optional<int64_t> black_increment;
+  std::optional<int64_t> moves_to_go;
+  std::optional<int64_t> depth;
+  std::optional<int64_t> nodes;
+  std::optional<int64_t> mate;
+  std::optional<int64_t> move_time;
+};
+
+/**
+ * Engine hooks called by UciSession. Every hook is called on the thread reading the input, so a hook must return
+ * quickly; go in particular should start the search on another thread rather than run it. Unset hooks are skipped.
+ */
+struct UciCallbacks {
+  /**
+   * Called for each position command. When reset is false the engine's position is still the one from the previous
+   * call, and only moves (those appended since then) need to be played. When reset is true the engine should set up
+   * fen and play moves from there. Null moves ("0000") in the move list are passed on as kNullMove.
+   */
+  std::function<void(std::string_view fen, std::span<const Move> moves, bool reset)> position;
+  std::function<void(const GoParameters&)> go;
+  std::function<void()> stop;
+  std::function<void()> ponder_hit;
+  std::function<void()> new_game;
+  std::function<void(std::string_view name, std::string_view value)> set_option;
+};
+
+/**
+ * The UCI protocol, as described at https://www.shredderchess.com/download/div/uci.zip, with the engine itself
+ * supplied through UciCallbacks. Commands the session doesn't know are ignored, as the protocol requires.
+ */
+class UciSession {
+ public:
+  UciSession(std::istream& input, std::ostream& output, UciCallbacks callbacks, std::string engine_name,
+             std::string engine_author);
+  UciSession(const UciSession&) = delete;
+  UciSession& operator=(const UciSession&) = delete;
+  /**
+   * Waits for the input thread to finish, which only happens once quit is read or the input ends.
+   */
+  ~UciSession();
+
+  /**
+   * Starts reading commands on a separate thread.
+   * @exception std::logic_error if the session was already started.
+   */
+  void Start();
+
+  /**
+   * Blocks until quit is read or the input ends.
+   */
+  void Join();
+
+  /**
+   * Handles a single line of input.
+   * @return false if the line was a quit command.
+   * @exception std::invalid_argument if a position or go command contains an invalid move. The session's position is
+   * reset, so the next position command is replayed in full.
+   */
+  bool HandleCommand(std::string_view line);
+
+  /**
+   * Writes a bestmove line, with kNullMove written as "0000". Safe to call from any thread.
+   */
+  void SendBestMove(Move best_move, std::optional<Move> ponder_move = std::nullopt);
+
+  /**
+   * Writes "info " followed by the given text. Safe to call from any thread.
+   */
+  void SendInfo(std::string_view info);
+
+ private:
+  void Send(std::string_view line);
+  void HandlePosition(std::string_view arguments);
+  void HandleGo(std::string_view arguments);
+  void HandleSetOption(std::string_view arguments);
+
+  std::istream& input_;
+  std::ostream& output_;
+  std::mutex output_mutex_;
+  UciCallbacks callbacks_;
+  std::string engine_name_;
+  std::string engine_author_;
+  std::string fen_;
+  // The arguments of the last position command, so a command that only appends moves can skip the moves already played.
+  std::string position_arguments_;
+  std::thread input_thread_;
+};
+
+}  // namespace bomchess
+
+#endif  // UCI_H
@@ -0,0 +1,151 @@
+#include "bitboard.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+struct Step {
+  int file;
+  int rank;
+};
+
+constexpr std::array<Step, 8> kKnightSteps{{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}};
+constexpr std::array<Step, 8> kKingSteps{{{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}}};
+constexpr std::array<Step, 4> kBishopSteps{{{1, 1}, {1, -1}, {-1, -1}, {-1, 1}}};
+constexpr std::array<Step, 4> kRookSteps{{{0, 1}, {1, 0}, {0, -1}, {-1, 0}}};
+
+// Files count from a, ranks from 1, so moving up the board is a positive rank step.
+constexpr int FileOf(const int square) { return square % 8; }
+constexpr int RankOf(const int square) { return 7 - square / 8; }
+constexpr bool OnBoard(const int file, const int rank) { return file >= 0 && file < 8 && rank >= 0 && rank < 8; }
+constexpr Bitboard Bit(const int file, const int rank) { return Bitboard{1} << ((7 - rank) * 8 + file); }
+
+template <size_t N>
+constexpr std::array<Bitboard, 64> MakeLeaperAttacks(const std::array<Step, N>& steps) {
+  std::array<Bitboard, 64> attacks{};
+  for (int square = 0; square < 64; ++square) {
+    for (const Step step : steps) {
+      const int file = FileOf(square) + step.file;
+      const int rank = RankOf(square) + step.rank;
+      if (OnBoard(file, rank)) {
+        attacks.at(square) |= Bit(file, rank);
+      }
+    }
+  }
+  return attacks;
+}
+
+constexpr std::array<Bitboard, 64> kKnightAttacks = MakeLeaperAttacks(kKnightSteps);
+constexpr std::array<Bitboard, 64> kKingAttacks = MakeLeaperAttacks(kKingSteps);
+constexpr std::array<std::array<Bitboard, 64>, 2> kPawnAttacks{
+    MakeLeaperAttacks(std::array<Step, 2>{{{-1, 1}, {1, 1}}}),
+    MakeLeaperAttacks(std::array<Step, 2>{{{-1, -1}, {1, -1}}}),
+};
+
+int SquareIndex(const Square square) {
+  if (!IsValidSquare(square)) {
+    throw std::invalid_argument("Invalid square.");
+  }
+  return std::to_underlying(square);
+}
+
+size_t PieceTypeIndex(const PieceType piece_type) {
+  if (std::to_underlying(piece_type) >= std::to_underlying(PieceType::kNone)) {
+    throw std::invalid_argument("Invalid piece type.");
+  }
+  return std::to_underlying(piece_type);
+}
+
+template <size_t N>
+Bitboard SliderAttacks(const Square square, const Bitboard occupied, const std::array<Step, N>& steps) {
+  const int index = SquareIndex(square);
+  Bitboard attacks = kEmptyBitboard;
+  for (const Step step : steps) {
+    int file = FileOf(index) + step.file;
+    int rank = RankOf(index) + step.rank;
+    while (OnBoard(file, rank)) {
+      const Bitboard bit = Bit(file, rank);
+      attacks |= bit;
+      if ((occupied & bit) != 0) {
+        break;
+      }
+      file += step.file;
+      rank += step.rank;
+    }
+  }
+  return attacks;
+}
+}  // namespace
+
+Bitboard PositionBitboards::Pieces(const PieceType piece_type) const {
+  return piece_types.at(PieceTypeIndex(piece_type));
+}
+
+Bitboard PositionBitboards::Pieces(const Color color) const { return colors.at(ColorIndex(color)); }
+
+Bitboard PositionBitboards::Pieces(const Piece piece) const { return Pieces(piece.type) & Pieces(piece.color); }
+
+Bitboard PositionBitboards::Occupied() const noexcept { return colors.front() | colors.back(); }
+
+PositionBitboards MakeBitboards(const Position& position) {
+  PositionBitboards bitboards;
+  for (const Square square : kAllSquares) {
+    const Piece piece = position.at(square);
+    if (piece == pieces::kNone) {
+      continue;
+    }
+    const Bitboard bit = SquareBitboard(square);
+    bitboards.piece_types.at(PieceTypeIndex(piece.type)) |= bit;
+    bitboards.colors.at(ColorIndex(piece.color)) |= bit;
+  }
+  return bitboards;
+}
+
+Bitboard PawnAttacks(const Color color, const Square square) {
+  return kPawnAttacks.at(ColorIndex(color)).at(SquareIndex(square));
+}
+
+Bitboard KnightAttacks(const Square square) { return kKnightAttacks.at(SquareIndex(square)); }
+
+Bitboard KingAttacks(const Square square) { return kKingAttacks.at(SquareIndex(square)); }
+
+Bitboard BishopAttacks(const Square square, const Bitboard occupied) {
+  return SliderAttacks(square, occupied, kBishopSteps);
+}
+
+Bitboard RookAttacks(const Square square, const Bitboard occupied) {
+  return SliderAttacks(square, occupied, kRookSteps);
+}
+
+Bitboard QueenAttacks(const Square square, const Bitboard occupied) {
+  return BishopAttacks(square, occupied) | RookAttacks(square, occupied);
+}
+
+Bitboard AttackersTo(const PositionBitboards& bitboards, const Square square, const Bitboard occupied) {
+  const Bitboard queens = bitboards.Pieces(PieceType::kQueen);
+  // A pawn attacks the square exactly when a pawn of the other color on the square would attack the pawn.
+  return (PawnAttacks(Color::kBlack, square) & bitboards.Pieces(pieces::kWhitePawn)) |
+         (PawnAttacks(Color::kWhite, square) & bitboards.Pieces(pieces::kBlackPawn)) |
+         (KnightAttacks(square) & bitboards.Pieces(PieceType::kKnight)) |
+         (KingAttacks(square) & bitboards.Pieces(PieceType::kKing)) |
+         (BishopAttacks(square, occupied) & (bitboards.Pieces(PieceType::kBishop) | queens)) |
+         (RookAttacks(square, occupied) & (bitboards.Pieces(PieceType::kRook) | queens));
+}
+
+Square LowestSquare(const Bitboard bitboard) {
+  if (bitboard == kEmptyBitboard) {
+    throw std::invalid_argument("Empty bitboard.");
+  }
+  return static_cast<Square>(std::countr_zero(bitboard));
+}
+
+}  // namespace bomchess
@@ -0,0 +1,301 @@
+#include "dataset.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+constexpr std::string_view kMagic = "BPDS";
+constexpr uint32_t kVersion = 1;
+constexpr uint16_t kKeyframeFlag = 0x8000;
+constexpr uint8_t kNoEnPassant = 64;
+constexpr size_t kFooterSize = 3 * sizeof(uint64_t) + kMagic.size();
+
+template <typename T>
+void AppendLittleEndian(std::string& bytes, const T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    bytes += static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+  }
+}
+
+template <typename T>
+T ReadLittleEndian(const std::span<const char> bytes, size_t& offset) {
+  if (offset + sizeof(T) > bytes.size()) {
+    throw std::runtime_error("Dataset block is corrupt.");
+  }
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset + i])) << (8 * i);
+  }
+  offset += sizeof(T);
+  return static_cast<T>(value);
+}
+
+uint16_t PackMove(const Move move) {
+  return static_cast<uint16_t>(std::to_underlying(move.from_square) | std::to_underlying(move.to_square) << 6 |
+                               std::to_underlying(move.promotion) << 12);
+}
+
+Move UnpackMove(const uint16_t packed) {
+  const auto promotion = static_cast<PieceType>(packed >> 12 & 7);
+  if (std::to_underlying(promotion) > std::to_underlying(PieceType::kNone)) {
+    throw std::runtime_error("Dataset block is corrupt.");
+  }
+  return {static_cast<Square>(packed & 63), static_cast<Square>(packed >> 6 & 63), promotion};
+}
+
+// Bit 0 is the side to move, bits 1 to 4 the castling rights (white king side first), bits 5 and 6 the result.
+uint8_t PackFlags(const TrainingRecord& record) {
+  const PositionState& state = record.state;
+  return static_cast<uint8_t>((state.side_to_move == Color::kBlack ? 1 : 0) | state.castling.front().king_side << 1 |
+                              state.castling.front().queen_side << 2 | state.castling.back().king_side << 3 |
+                              state.castling.back().queen_side << 4 | std::to_underlying(record.result) << 5);
+}
+
+void AppendKeyframe(const TrainingRecord& record, std::string& bytes) {
+  AppendLittleEndian(bytes, static_cast<uint16_t>(PackMove(record.move) | kKeyframeFlag));
+  uint64_t occupancy = 0;
+  std::vector<uint8_t> nibbles;
+  for (const Square square : kAllSquares) {
+    const Piece piece = record.state.position.at(square);
+    if (piece != pieces::kNone) {
+      occupancy |= uint64_t{1} << std::to_underlying(square);
+      nibbles.push_back(static_cast<uint8_t>(std::to_underlying(piece.color) << 3 | std::to_underlying(piece.type)));
+    }
+  }
+  AppendLittleEndian(bytes, occupancy);
+  for (size_t i = 0; i < nibbles.size(); i += 2) {
+    bytes += static_cast<char>(nibbles.at(i) | (i + 1 < nibbles.size() ? nibbles.at(i + 1) << 4 : 0));
+  }
+  AppendLittleEndian(bytes, PackFlags(record));
+  AppendLittleEndian(bytes, IsValidSquare(record.state.en_passant)
+                                ? static_cast<uint8_t>(std::to_underlying(record.state.en_passant))
+                                : kNoEnPassant);
+  AppendLittleEndian(bytes, record.state.ply);
+}
+
+TrainingRecord ReadKeyframe(const uint16_t move, const std::span<const char> bytes, size_t& offset) {
+  TrainingRecord record;
+  record.move = UnpackMove(move);
+  uint64_t occupancy = ReadLittleEndian<uint64_t>(bytes, offset);
+  const int piece_count = std::popcount(occupancy);
+  uint8_t nibble_byte = 0;
+  for (int i = 0; i < piece_count; ++i, occupancy &= occupancy - 1) {
+    if (i % 2 == 0) {
+      nibble_byte = ReadLittleEndian<uint8_t>(bytes, offset);
+    }
+    const uint8_t nibble = i % 2 == 0 ? nibble_byte & 15 : nibble_byte >> 4;
+    const auto color = static_cast<Color>(nibble >> 3);
+    const auto type = static_cast<PieceType>(nibble & 7);
+    if (std::to_underlying(type) >= std::to_underlying(PieceType::kNone)) {
+      throw std::runtime_error("Dataset block is corrupt.");
+    }
+    record.state.position.at(static_cast<Square>(std::countr_zero(occupancy))) = {color, type};
+  }
+  const uint8_t flags = ReadLittleEndian<uint8_t>(bytes, offset);
+  record.state.side_to_move = (flags & 1) != 0 ? Color::kBlack : Color::kWhite;
+  record.state.castling = {CastlingRights{(flags & 2) != 0, (flags & 4) != 0},
+                           CastlingRights{(flags & 8) != 0, (flags & 16) != 0}};
+  record.result = static_cast<GameResult>(flags >> 5 & 3);
+  const uint8_t en_passant = ReadLittleEndian<uint8_t>(bytes, offset);
+  record.state.en_passant = en_passant < kNoEnPassant ? static_cast<Square>(en_passant) : Square::kNone;
+  record.state.ply = ReadLittleEndian<uint16_t>(bytes, offset);
+  return record;
+}
+
+void Pad(std::ofstream& file) {
+  const auto position = static_cast<size_t>(file.tellp());
+  const size_t padding = (kDatasetBlockAlignment - position % kDatasetBlockAlignment) % kDatasetBlockAlignment;
+  file << std::string(padding, '\0');
+}
+}  // namespace
+
+DatasetWriter::DatasetWriter(const std::filesystem::path& path) : file_(path, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw std::runtime_error("Could not create dataset file.");
+  }
+  file_ << kMagic;
+  std::string version;
+  AppendLittleEndian(version, kVersion);
+  file_ << version;
+  Pad(file_);
+}
+
+DatasetWriter::~DatasetWriter() {
+  try {
+    Close();
+  } catch (...) {
+    // Destructors can't throw, callers that care call Close.
+  }
+}
+
+void DatasetWriter::AddGame(const PositionState& start, const std::span<const Move> moves, const GameResult result) {
+  if (closed_) {
+    throw std::runtime_error("Dataset is closed.");
+  }
+  // Replay the whole game first, so an illegal move doesn't leave half a game in the file.
+  std::vector<TrainingRecord> records;
+  records.reserve(moves.size());
+  PositionState state = start;
+  for (const Move move : moves) {
+    records.push_back({state, move, result});
+    AdvanceState(state, move);
+  }
+  for (size_t i = 0; i < records.size(); ++i) {
+    AddRecord(records.at(i), i > 0);
+  }
+}
+
+void DatasetWriter::Close() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  FinishBlock();
+  std::string index;
+  for (const auto& [offset, first_record] : index_) {
+    AppendLittleEndian(index, offset);
+    AppendLittleEndian(index, first_record);
+  }
+  AppendLittleEndian(index, static_cast<uint64_t>(file_.tellp()));
+  AppendLittleEndian(index, static_cast<uint64_t>(index_.size()));
+  AppendLittleEndian(index, record_count_);
+  index += kMagic;
+  file_ << index;
+  file_.close();
+  if (file_.fail()) {
+    throw std::runtime_error("Could not write dataset file.");
+  }
+}
+
+void DatasetWriter::AddRecord(const TrainingRecord& record, const bool continues_game) {
+  if (block_records_ == kRecordsPerBlock) {
+    FinishBlock();
+  }
+  // Every block starts with a keyframe, so it can be decoded without the blocks before it.
+  if (continues_game && block_records_ > 0) {
+    AppendLittleEndian(block_, PackMove(record.move));
+  } else {
+    AppendKeyframe(record, block_);
+  }
+  block_records_ += 1;
+  record_count_ += 1;
+}
+
+void DatasetWriter::FinishBlock() {
+  if (block_records_ == 0) {
+    return;
+  }
+  index_.push_back({static_cast<uint64_t>(file_.tellp()), record_count_ - block_records_});
+  file_ << block_;
+  Pad(file_);
+  if (!file_) {
+    throw std::runtime_error("Could not write dataset file.");
+  }
+  block_.clear();
+  block_records_ = 0;
+}
+
+DatasetReader::DatasetReader(const std::filesystem::path& path) : file_(path, std::ios::binary) {
+  std::string header(kMagic.size(), '\0');
+  if (!file_ || !file_.read(header.data(), static_cast<std::streamsize>(header.size())) || header != kMagic) {
+    throw std::runtime_error("Not a dataset file.");
+  }
+  std::vector<char> footer(kFooterSize);
+  file_.seekg(-static_cast<std::streamoff>(kFooterSize), std::ios::end);
+  if (!file_.read(footer.data(), static_cast<std::streamsize>(footer.size())) ||
+      std::string_view(footer.data() + kFooterSize - kMagic.size(), kMagic.size()) != kMagic) {
+    throw std::runtime_error("Dataset file is incomplete.");
+  }
+  size_t offset = 0;
+  index_offset_ = ReadLittleEndian<uint64_t>(footer, offset);
+  const auto block_count = ReadLittleEndian<uint64_t>(footer, offset);
+  record_count_ = ReadLittleEndian<uint64_t>(footer, offset);
+
+  std::vector<char> index(block_count * 2 * sizeof(uint64_t));
+  file_.seekg(static_cast<std::streamoff>(index_offset_));
+  if (!file_.read(index.data(), static_cast<std::streamsize>(index.size()))) {
+    throw std::runtime_error("Dataset file is incomplete.");
+  }
+  offset = 0;
+  for (uint64_t i = 0; i < block_count; ++i) {
+    const auto block_offset = ReadLittleEndian<uint64_t>(index, offset);
+    index_.push_back({block_offset, ReadLittleEndian<uint64_t>(index, offset)});
+  }
+  cached_block_ = index_.size();
+}
+
+uint64_t DatasetReader::Size() const noexcept { return record_count_; }
+
+size_t DatasetReader::BlockCount() const noexcept { return index_.size(); }
+
+const TrainingRecord& DatasetReader::Read(const uint64_t index) {
+  if (index >= record_count_) {
+    throw std::out_of_range("Record index out of range.");
+  }
+  const auto block = std::ranges::upper_bound(index_, index, {}, [](const auto& entry) { return entry.back(); });
+  const auto block_index = static_cast<size_t>(block - index_.begin() - 1);
+  return ReadBlock(block_index)[index - index_.at(block_index).back()];
+}
+
+std::span<const TrainingRecord> DatasetReader::ReadBlock(const size_t block) {
+  if (block >= index_.size()) {
+    throw std::out_of_range("Block index out of range.");
+  }
+  if (block == cached_block_) {
+    return cached_records_;
+  }
+  const uint64_t start = index_.at(block).front();
+  const uint64_t end = block + 1 < index_.size() ? index_.at(block + 1).front() : index_offset_;
+  const uint64_t record_count =
+      (block + 1 < index_.size() ? index_.at(block + 1).back() : record_count_) - index_.at(block).back();
+  std::vector<char> bytes(end - start);
+  file_.clear();
+  file_.seekg(static_cast<std::streamoff>(start));
+  if (!file_.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+    throw std::runtime_error("Could not read dataset block.");
+  }
+
+  cached_block_ = index_.size();
+  cached_records_.clear();
+  size_t offset = 0;
+  for (uint64_t i = 0; i < record_count; ++i) {
+    const auto move = ReadLittleEndian<uint16_t>(bytes, offset);
+    if ((move & kKeyframeFlag) != 0) {
+      cached_records_.push_back(ReadKeyframe(move & ~kKeyframeFlag, bytes, offset));
+      continue;
+    }
+    if (cached_records_.empty()) {
+      throw std::runtime_error("Dataset block is corrupt.");
+    }
+    TrainingRecord record = cached_records_.back();
+    try {
+      AdvanceState(record.state, record.move);
+    } catch (const std::invalid_argument&) {
+      throw std::runtime_error("Dataset block is corrupt.");
+    }
+    record.move = UnpackMove(move);
+    cached_records_.push_back(record);
+  }
+  cached_block_ = block;
+  return cached_records_;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,294 @@
+#include "dedup.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "game.h"
+#include "hash.h"
+#include "move.h"
+#include "piece.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+constexpr size_t kFingerprintBytes = 16;
+constexpr size_t kIndexInterval = 512;
+constexpr int kBloomHashCount = 7;
+constexpr size_t kBloomBitsPerGame = 10;
+
+constexpr std::array<std::string_view, 3> kKeyTags{tags::kWhite, tags::kBlack, tags::kDate};
+
+uint16_t PackMove(const Move move) {
+  if (!IsValidSquare(move.from_square) || !IsValidSquare(move.to_square) ||
+      std::to_underlying(move.promotion) > std::to_underlying(PieceType::kNone)) {
+    throw std::invalid_argument("Invalid move.");
+  }
+  return static_cast<uint16_t>(std::to_underlying(move.from_square) | std::to_underlying(move.to_square) << 6 |
+                               std::to_underlying(move.promotion) << 12);
+}
+
+// Lower case words separated by single spaces. Values made only of '?', '.' and spaces are unknown, and become "".
+std::string NormalizeTagValue(const std::string_view value) {
+  if (value.find_first_not_of("?. \t") == std::string_view::npos) {
+    return "";
+  }
+  std::string normalized;
+  bool in_space = false;
+  for (const char character : value) {
+    if (std::isspace(static_cast<unsigned char>(character))) {
+      in_space = !normalized.empty();
+      continue;
+    }
+    if (in_space) {
+      normalized += ' ';
+      in_space = false;
+    }
+    normalized += static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+  }
+  return normalized;
+}
+
+// Big endian, so byte order and numeric order agree.
+std::array<char, kFingerprintBytes> Serialize(const GameFingerprint& fingerprint) {
+  std::array<char, kFingerprintBytes> bytes{};
+  for (size_t i = 0; i < 8; ++i) {
+    bytes.at(i) = static_cast<char>(fingerprint.high >> (56 - 8 * i));
+    bytes.at(8 + i) = static_cast<char>(fingerprint.low >> (56 - 8 * i));
+  }
+  return bytes;
+}
+
+GameFingerprint Deserialize(const std::span<const char, kFingerprintBytes> bytes) {
+  GameFingerprint fingerprint;
+  for (size_t i = 0; i < 8; ++i) {
+    fingerprint.high = fingerprint.high << 8 | static_cast<uint8_t>(bytes[i]);
+    fingerprint.low = fingerprint.low << 8 | static_cast<uint8_t>(bytes[8 + i]);
+  }
+  return fingerprint;
+}
+
+std::vector<GameFingerprint> ReadFingerprints(std::ifstream& file, const size_t first, const size_t count) {
+  std::vector<char> bytes(count * kFingerprintBytes);
+  file.clear();
+  file.seekg(static_cast<std::streamoff>(first * kFingerprintBytes));
+  if (!file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+    throw std::runtime_error("Could not read fingerprint shard.");
+  }
+  std::vector<GameFingerprint> fingerprints;
+  fingerprints.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    fingerprints.push_back(Deserialize(std::span(bytes).subspan(i * kFingerprintBytes).first<kFingerprintBytes>()));
+  }
+  return fingerprints;
+}
+
+size_t ShardIndex(const GameFingerprint& fingerprint) {
+  return fingerprint.high >> (64 - std::countr_zero(DuplicateFilter::kShardCount));
+}
+}  // namespace
+
+void GameFingerprinter::AddMove(const Move move) {
+  const uint64_t packed = PackMove(move);
+  // Two independent lanes, each depending on the order of the moves.
+  high_ = std::rotl(high_ ^ packed, 23) * 0x9e3779b97f4a7c15 + 0x632be59bd9b4e019;
+  low_ = std::rotl(low_ + packed, 37) * 0xc2b2ae3d27d4eb4f ^ 0x85ebca77c2b2ae63;
+  move_count_ += 1;
+}
+
+GameFingerprint GameFingerprinter::Finish(const TagPairs& tags) const {
+  uint64_t high = high_ ^ move_count_;
+  uint64_t low = low_ + move_count_;
+  for (const std::string_view tag : kKeyTags) {
+    // The separator keeps ("ab", "c") and ("a", "bc") apart.
+    for (const char character : NormalizeTagValue(tags.Get(tag)) + '\xff') {
+      high = (high ^ static_cast<uint8_t>(character)) * 0x100000001b3;
+      low = (low + static_cast<uint8_t>(character)) * 0xff51afd7ed558ccd;
+    }
+  }
+  return {Mix64(high ^ std::rotl(low, 32)), Mix64(low + high)};
+}
+
+GameFingerprint Fingerprint(const std::span<const Move> moves, const TagPairs& tags) {
+  GameFingerprinter fingerprinter;
+  for (const Move move : moves) {
+    fingerprinter.AddMove(move);
+  }
+  return fingerprinter.Finish(tags);
+}
+
+DuplicateFilter::DuplicateFilter(const std::filesystem::path& directory, const size_t expected_games,
+                                 const size_t max_pending)
+    : bloom_filter_(std::max<size_t>(expected_games * kBloomBitsPerGame / 64, 1)), max_pending_(max_pending) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (!std::filesystem::is_directory(directory)) {
+    throw std::runtime_error("Could not create fingerprint directory.");
+  }
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    constexpr std::string_view kHexDigits = "0123456789abcdef";
+    shards_.at(i).path = directory / ("shard_" + std::string{kHexDigits.at(i / 16), kHexDigits.at(i % 16)} + ".bin");
+    LoadShard(shards_.at(i));
+  }
+}
+
+DuplicateFilter::~DuplicateFilter() {
+  try {
+    Flush();
+  } catch (...) {
+    // Destructors can't throw, callers that care call Flush.
+  }
+}
+
+bool DuplicateFilter::Insert(const GameFingerprint& fingerprint) {
+  if (Contains(fingerprint)) {
+    return false;
+  }
+  shards_.at(ShardIndex(fingerprint)).pending.insert(fingerprint);
+  AddToBloomFilter(fingerprint);
+  pending_count_ += 1;
+  if (pending_count_ >= max_pending_) {
+    Flush();
+  }
+  return true;
+}
+
+bool DuplicateFilter::Contains(const GameFingerprint& fingerprint) {
+  if (!MightContain(fingerprint)) {
+    return false;
+  }
+  Shard& shard = shards_.at(ShardIndex(fingerprint));
+  return shard.pending.contains(fingerprint) || StoredInShard(shard, fingerprint);
+}
+
+void DuplicateFilter::Flush() {
+  for (Shard& shard : shards_) {
+    FlushShard(shard);
+  }
+  pending_count_ = 0;
+}
+
+size_t DuplicateFilter::Size() const noexcept {
+  size_t size = 0;
+  for (const Shard& shard : shards_) {
+    size += shard.size + shard.pending.size();
+  }
+  return size;
+}
+
+void DuplicateFilter::LoadShard(Shard& shard) {
+  shard.file.close();
+  shard.size = 0;
+  shard.sparse_index.clear();
+  if (!std::filesystem::exists(shard.path)) {
+    return;
+  }
+  const uintmax_t file_size = std::filesystem::file_size(shard.path);
+  if (file_size % kFingerprintBytes != 0) {
+    throw std::runtime_error("Fingerprint shard is truncated.");
+  }
+  shard.file.open(shard.path, std::ios::binary);
+  if (!shard.file) {
+    throw std::runtime_error("Could not open fingerprint shard.");
+  }
+  shard.size = file_size / kFingerprintBytes;
+  // Read in index blocks, the whole shard may not fit in memory.
+  for (size_t first = 0; first < shard.size; first += kIndexInterval) {
+    const std::vector<GameFingerprint> block =
+        ReadFingerprints(shard.file, first, std::min(kIndexInterval, shard.size - first));
+    shard.sparse_index.push_back(block.front());
+    for (const GameFingerprint& fingerprint : block) {
+      AddToBloomFilter(fingerprint);
+    }
+  }
+}
+
+void DuplicateFilter::FlushShard(Shard& shard) {
+  if (shard.pending.empty()) {
+    return;
+  }
+  std::vector<GameFingerprint> pending(shard.pending.begin(), shard.pending.end());
+  std::ranges::sort(pending);
+  std::filesystem::path temporary_path = shard.path;
+  temporary_path += ".tmp";
+  std::vector<GameFingerprint> sparse_index;
+  size_t size = 0;
+  {
+    std::ofstream merged(temporary_path, std::ios::binary | std::ios::trunc);
+    const auto write = [&](const GameFingerprint& fingerprint) {
+      if (size % kIndexInterval == 0) {
+        sparse_index.push_back(fingerprint);
+      }
+      size += 1;
+      const std::array<char, kFingerprintBytes> bytes = Serialize(fingerprint);
+      merged.write(bytes.data(), bytes.size());
+    };
+    auto next_pending = pending.begin();
+    for (size_t first = 0; first < shard.size; first += kIndexInterval) {
+      for (const GameFingerprint& stored :
+           ReadFingerprints(shard.file, first, std::min(kIndexInterval, shard.size - first))) {
+        for (; next_pending != pending.end() && *next_pending < stored; ++next_pending) {
+          write(*next_pending);
+        }
+        write(stored);
+      }
+    }
+    std::for_each(next_pending, pending.end(), write);
+    if (!merged.flush()) {
+      throw std::runtime_error("Could not write fingerprint shard.");
+    }
+  }
+  shard.file.close();
+  std::filesystem::rename(temporary_path, shard.path);
+  // The pending fingerprints are in the Bloom filter already, so the merged file doesn't need reading again.
+  shard.file.open(shard.path, std::ios::binary);
+  if (!shard.file) {
+    throw std::runtime_error("Could not open fingerprint shard.");
+  }
+  shard.size = size;
+  shard.sparse_index = std::move(sparse_index);
+  shard.pending.clear();
+}
+
+bool DuplicateFilter::StoredInShard(Shard& shard, const GameFingerprint& fingerprint) {
+  const auto block = std::ranges::upper_bound(shard.sparse_index, fingerprint);
+  if (block == shard.sparse_index.begin()) {
+    return false;
+  }
+  const size_t first = static_cast<size_t>(block - shard.sparse_index.begin() - 1) * kIndexInterval;
+  return std::ranges::binary_search(ReadFingerprints(shard.file, first, std::min(kIndexInterval, shard.size - first)),
+                                    fingerprint);
+}
+
+// Double hashing: the fingerprint is already a good hash, so its halves give every probe position.
+bool DuplicateFilter::MightContain(const GameFingerprint& fingerprint) const noexcept {
+  const uint64_t bit_count = bloom_filter_.size() * 64;
+  for (int i = 0; i < kBloomHashCount; ++i) {
+    const uint64_t bit = (fingerprint.low + i * (fingerprint.high | 1)) % bit_count;
+    if ((bloom_filter_[bit / 64] >> (bit % 64) & 1) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DuplicateFilter::AddToBloomFilter(const GameFingerprint& fingerprint) noexcept {
+  const uint64_t bit_count = bloom_filter_.size() * 64;
+  for (int i = 0; i < kBloomHashCount; ++i) {
+    const uint64_t bit = (fingerprint.low + i * (fingerprint.high | 1)) % bit_count;
+    bloom_filter_[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+}
+
+}  // namespace bomchess
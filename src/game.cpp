@@ -1,5 +1,87 @@
-//
-// Created by brigh on 6/20/2024.
-//
-
 #include "game.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace bomchess {
+namespace {
+// Returns kSevenTagRoster.size() if the tag is not part of the roster.
+size_t RosterIndex(const std::string_view name) noexcept {
+  return std::ranges::find(tags::kSevenTagRoster, name) - tags::kSevenTagRoster.begin();
+}
+}  // namespace
+
+TagPairs::TagPairs(std::pmr::memory_resource* memory_resource)
+    : roster_{std::pmr::string(memory_resource), std::pmr::string(memory_resource), std::pmr::string(memory_resource),
+              std::pmr::string(memory_resource), std::pmr::string(memory_resource), std::pmr::string(memory_resource),
+              std::pmr::string(memory_resource)},
+      supplemental_(memory_resource) {}
+
+TagPairs::TagPairs(const TagPairs& other, std::pmr::memory_resource* memory_resource) : TagPairs(memory_resource) {
+  CopyFrom(other);
+}
+
+TagPairs& TagPairs::operator=(TagPairs&& other) {
+  if (GetMemoryResource() == other.GetMemoryResource()) {
+    roster_ = std::move(other.roster_);
+    supplemental_ = std::move(other.supplemental_);
+  } else {
+    // Moving the TagPairs in would keep strings allocated from the other resource, which may be released first.
+    CopyFrom(other);
+  }
+  return *this;
+}
+
+std::string_view TagPairs::Get(const std::string_view name) const noexcept {
+  if (const size_t roster_index = RosterIndex(name); roster_index < roster_.size()) {
+    return roster_.at(roster_index);
+  }
+  const auto tag = std::ranges::find(supplemental_, name, &TagPair::name);
+  if (tag == supplemental_.end()) {
+    return "";
+  }
+  return tag->value;
+}
+
+void TagPairs::Set(const std::string_view name, const std::string_view value) {
+  if (const size_t roster_index = RosterIndex(name); roster_index < roster_.size()) {
+    roster_.at(roster_index).assign(value);
+    return;
+  }
+  const auto tag = std::ranges::find(supplemental_, name, &TagPair::name);
+  if (value.empty()) {
+    if (tag != supplemental_.end()) {
+      supplemental_.erase(tag);
+    }
+    return;
+  }
+  if (tag != supplemental_.end()) {
+    tag->value.assign(value);
+    return;
+  }
+  // TagPair is not allocator aware, so its strings need the memory resource passed in explicitly.
+  supplemental_.emplace_back(std::pmr::string(name, GetMemoryResource()), std::pmr::string(value, GetMemoryResource()));
+}
+
+std::span<const TagPair> TagPairs::SupplementalTags() const noexcept { return supplemental_; }
+
+std::pmr::memory_resource* TagPairs::GetMemoryResource() const noexcept {
+  return supplemental_.get_allocator().resource();
+}
+
+void TagPairs::CopyFrom(const TagPairs& other) {
+  for (size_t i = 0; i < roster_.size(); ++i) {
+    roster_.at(i).assign(other.roster_.at(i));
+  }
+  supplemental_.clear();
+  supplemental_.reserve(other.supplemental_.size());
+  for (const TagPair& tag : other.supplemental_) {
+    supplemental_.emplace_back(std::pmr::string(tag.name, GetMemoryResource()),
+                               std::pmr::string(tag.value, GetMemoryResource()));
+  }
+}
+
+}  // namespace bomchess
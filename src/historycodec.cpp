@@ -0,0 +1,209 @@
+#include "historycodec.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+
+// A range coder in the style of LZMA's: the interval is kept at 32 bits, and a byte is shifted out whenever the range
+// drops below 2^24. kMaxFrequencyTotal is small enough that range / total never loses more than 1/256 of the range.
+
+namespace bomchess {
+namespace {
+constexpr uint32_t kTopValue = uint32_t{1} << 24;
+
+// The list the move indices point into.
+void LegalMoves(const PositionState& state, std::vector<Move>& moves) {
+  moves.clear();
+  GenerateLegalMoves(state.position, state.side_to_move, state.en_passant,
+                     state.castling.at(ColorIndex(state.side_to_move)), moves);
+}
+
+void CheckLegalMoveCount(const int legal_move_count) {
+  if (legal_move_count < 1 || legal_move_count > kMaxLegalMoves) {
+    throw std::invalid_argument("Invalid legal move count.");
+  }
+}
+
+uint32_t FrequencyTotal(const std::span<const uint32_t> frequencies) {
+  if (frequencies.empty() || frequencies.size() > kMaxLegalMoves) {
+    throw std::invalid_argument("Invalid legal move count.");
+  }
+  uint32_t total = 0;
+  for (const uint32_t frequency : frequencies) {
+    if (frequency == 0 || frequency > kMaxFrequencyTotal - total) {
+      throw std::invalid_argument("Invalid move frequencies.");
+    }
+    total += frequency;
+  }
+  return total;
+}
+}  // namespace
+
+void MoveIndexEncoder::Write(const int move_index, const int legal_move_count) {
+  CheckLegalMoveCount(legal_move_count);
+  if (move_index < 0 || move_index >= legal_move_count) {
+    throw std::invalid_argument("Move index is out of range.");
+  }
+  Encode(move_index, 1, legal_move_count);
+}
+
+void MoveIndexEncoder::Write(const int move_index, const std::span<const uint32_t> frequencies) {
+  const uint32_t total = FrequencyTotal(frequencies);
+  if (move_index < 0 || static_cast<size_t>(move_index) >= frequencies.size()) {
+    throw std::invalid_argument("Move index is out of range.");
+  }
+  const uint32_t start = std::accumulate(frequencies.begin(), frequencies.begin() + move_index, uint32_t{0});
+  Encode(start, frequencies[move_index], total);
+}
+
+void MoveIndexEncoder::Finish(std::vector<uint8_t>& output) {
+  // Any value in [low, low + range) decodes the same, so pick the one ending in the most zero bits. The decoder pads
+  // with zeros, so those bits need not be written.
+  for (int shift = 32; shift > 0; --shift) {
+    const uint64_t mask = (uint64_t{1} << shift) - 1;
+    const uint64_t rounded = (low_ + mask) & ~mask;
+    if (rounded < low_ + range_) {
+      low_ = rounded;
+      break;
+    }
+  }
+  for (int i = 0; i < 5; ++i) {
+    ShiftLow();
+  }
+  // The interval never reaches past the 32 bits it started with, so the first byte shifted out is always zero.
+  const size_t history_start = output.size();
+  output.insert(output.end(), bytes_.begin() + 1, bytes_.end());
+  while (output.size() > history_start && output.back() == 0) {
+    output.pop_back();
+  }
+
+  // Keeps the buffer's capacity for the next history.
+  bytes_.clear();
+  low_ = 0;
+  range_ = std::numeric_limits<uint32_t>::max();
+  cache_ = 0;
+  cache_size_ = 1;
+}
+
+void MoveIndexEncoder::Encode(const uint32_t start, const uint32_t size, const uint32_t total) {
+  const uint32_t step = range_ / total;
+  low_ += uint64_t{step} * start;
+  range_ = step * size;
+  while (range_ < kTopValue) {
+    range_ <<= 8;
+    ShiftLow();
+  }
+}
+
+void MoveIndexEncoder::ShiftLow() {
+  // The top byte of low can only be written once a carry into it is ruled out: either low is below 0xFF000000, so
+  // adding the range can't carry, or the carry has already happened.
+  if (static_cast<uint32_t>(low_) < 0xFF000000 || (low_ >> 32) != 0) {
+    const auto carry = static_cast<uint8_t>(low_ >> 32);
+    uint8_t byte = cache_;
+    for (; cache_size_ > 0; --cache_size_) {
+      bytes_.push_back(static_cast<uint8_t>(byte + carry));
+      byte = 0xFF;
+    }
+    cache_ = static_cast<uint8_t>(low_ >> 24);
+  }
+  cache_size_ += 1;
+  low_ = (low_ & 0x00FFFFFF) << 8;
+}
+
+MoveIndexDecoder::MoveIndexDecoder(const std::span<const uint8_t> bytes) noexcept : bytes_(bytes) {
+  for (int i = 0; i < 4; ++i) {
+    code_ = code_ << 8 | NextByte();
+  }
+}
+
+int MoveIndexDecoder::Read(const int legal_move_count) {
+  CheckLegalMoveCount(legal_move_count);
+  const uint32_t move_index = Target(legal_move_count);
+  Consume(move_index, 1, legal_move_count);
+  return static_cast<int>(move_index);
+}
+
+int MoveIndexDecoder::Read(const std::span<const uint32_t> frequencies) {
+  const uint32_t total = FrequencyTotal(frequencies);
+  const uint32_t target = Target(total);
+  uint32_t start = 0;
+  size_t move_index = 0;
+  while (start + frequencies[move_index] <= target) {
+    start += frequencies[move_index];
+    move_index += 1;
+  }
+  Consume(start, frequencies[move_index], total);
+  return static_cast<int>(move_index);
+}
+
+uint32_t MoveIndexDecoder::Target(const uint32_t total) const {
+  // The last range % total values of the interval belong to no index, so only corrupt data lands there.
+  const uint32_t target = code_ / (range_ / total);
+  if (target >= total) {
+    throw std::invalid_argument("Decoded move index is out of range.");
+  }
+  return target;
+}
+
+void MoveIndexDecoder::Consume(const uint32_t start, const uint32_t size, const uint32_t total) {
+  const uint32_t step = range_ / total;
+  code_ -= step * start;
+  range_ = step * size;
+  while (range_ < kTopValue) {
+    range_ <<= 8;
+    code_ = code_ << 8 | NextByte();
+  }
+}
+
+uint8_t MoveIndexDecoder::NextByte() noexcept {
+  const uint8_t byte = byte_position_ < bytes_.size() ? bytes_[byte_position_] : 0;
+  byte_position_ += 1;
+  return byte;
+}
+
+void EncodeHistory(const PositionState& start, const std::span<const Move> moves, std::vector<uint8_t>& output) {
+  PositionState state = start;
+  MoveIndexEncoder encoder;
+  std::vector<Move> legal_moves;
+  for (const Move move : moves) {
+    LegalMoves(state, legal_moves);
+    const auto legal_move = std::ranges::find(legal_moves, move);
+    if (legal_move == legal_moves.end()) {
+      throw std::invalid_argument("Move is not legal.");
+    }
+    encoder.Write(static_cast<int>(legal_move - legal_moves.begin()), static_cast<int>(legal_moves.size()));
+    AdvanceState(state, move);
+  }
+  encoder.Finish(output);
+}
+
+std::vector<Move> DecodeHistory(const PositionState& start, const std::span<const uint8_t> bytes,
+                                const size_t move_count) {
+  PositionState state = start;
+  MoveIndexDecoder decoder(bytes);
+  std::vector<Move> moves;
+  moves.reserve(move_count);
+  std::vector<Move> legal_moves;
+  for (size_t i = 0; i < move_count; ++i) {
+    LegalMoves(state, legal_moves);
+    if (legal_moves.empty()) {
+      throw std::invalid_argument("The game ended before the last move.");
+    }
+    const Move move = legal_moves.at(decoder.Read(static_cast<int>(legal_moves.size())));
+    AdvanceState(state, move);
+    moves.push_back(move);
+  }
+  return moves;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "search.h"
+#include "transpositiontable.h"
+#include "uci.h"
+
+// A UCI engine: bomchess_uci <network file> [threads] [hash megabytes]
+
+namespace {
+constexpr std::string_view kEngineName = "bomchess";
+constexpr std::string_view kEngineAuthor = "the bomchess authors";
+constexpr int kDefaultThreads = 1;
+constexpr size_t kDefaultHashMegabytes = 64;
+// Moves assumed left in the game when the GUI doesn't send movestogo.
+constexpr int64_t kDefaultMovesToGo = 30;
+// Kept back from the clock for the GUI's and the engine's own overhead.
+constexpr int64_t kMoveOverhead = 50;
+
+std::string ScoreString(const int score) {
+  const int mate_plies = bomchess::kMateScore - std::abs(score);
+  if (mate_plies > bomchess::kMaxSearchDepth) {
+    return "cp " + std::to_string(score);
+  }
+  const int mate_moves = (mate_plies + 1) / 2;
+  return "mate " + std::to_string(score > 0 ? mate_moves : -mate_moves);
+}
+
+std::string InfoString(const bomchess::SearchInfo& info) {
+  std::string line = "depth " + std::to_string(info.depth) + " score " + ScoreString(info.score) + " nodes " +
+                     std::to_string(info.nodes) + " time " + std::to_string(info.time);
+  if (!info.principal_variation.empty()) {
+    line += " pv";
+    for (const bomchess::Move move : info.principal_variation) {
+      line += " " + bomchess::ToUCI(move);
+    }
+  }
+  return line;
+}
+
+bomchess::SearchLimits MakeLimits(const bomchess::GoParameters& parameters, const bomchess::Color side_to_move) {
+  bomchess::SearchLimits limits;
+  if (parameters.depth.has_value()) {
+    limits.depth = static_cast<int>(std::clamp<int64_t>(*parameters.depth, 1, bomchess::kMaxSearchDepth));
+  }
+  if (parameters.nodes.has_value()) {
+    limits.nodes = static_cast<uint64_t>(std::max<int64_t>(*parameters.nodes, 1));
+  }
+  if (parameters.infinite) {
+    return limits;
+  }
+  if (parameters.move_time.has_value()) {
+    limits.move_time = *parameters.move_time;
+    return limits;
+  }
+  const bool white = side_to_move == bomchess::Color::kWhite;
+  const std::optional<int64_t> time = white ? parameters.white_time : parameters.black_time;
+  if (time.has_value()) {
+    const int64_t increment = (white ? parameters.white_increment : parameters.black_increment).value_or(0);
+    const int64_t moves_to_go = std::max<int64_t>(parameters.moves_to_go.value_or(kDefaultMovesToGo), 1);
+    limits.move_time = std::clamp<int64_t>(*time / moves_to_go + increment / 2, 1,
+                                           std::max<int64_t>(*time - kMoveOverhead, 1));
+  }
+  return limits;
+}
+
+/**
+ * Connects UciSession to a Searcher. Searches run on their own thread, and their best move is sent once they end,
+ * except that a ponder or infinite search holds it back until stop or ponderhit, as the protocol requires.
+ */
+class Engine {
+ public:
+  Engine(const bomchess::NnueNetwork& network, const int thread_count, const size_t hash_megabytes)
+      : table_(hash_megabytes),
+        searcher_(network, table_, thread_count),
+        state_(bomchess::ParseFen(bomchess::kUciStartPosition)) {}
+  Engine(const Engine&) = delete;
+  Engine& operator=(const Engine&) = delete;
+  ~Engine() { StopAndJoin(); }
+
+  /**
+   * The session must outlive the engine's searches. Set before the session starts.
+   */
+  void SetSession(bomchess::UciSession& session) { session_ = &session; }
+
+  /**
+   * Ends the running search, if any, and waits for its best move to be sent.
+   */
+  void StopAndJoin() {
+    Stop();
+    if (search_thread_.joinable()) {
+      search_thread_.join();
+    }
+  }
+
+  [[nodiscard]] bomchess::UciCallbacks Callbacks() {
+    return {
+        .position = [this](const std::string_view fen, const std::span<const bomchess::Move> moves,
+                           const bool reset) { SetPosition(fen, moves, reset); },
+        .go = [this](const bomchess::GoParameters& parameters) { Go(parameters); },
+        .stop = [this] { Stop(); },
+        .ponder_hit = [this] { PonderHit(); },
+        .new_game =
+            [this] {
+              StopAndJoin();
+              table_.Clear();
+            },
+        .set_option = {},
+    };
+  }
+
+ private:
+  void SetPosition(const std::string_view fen, const std::span<const bomchess::Move> moves, const bool reset) {
+    bomchess::PositionState state = reset ? bomchess::ParseFen(fen) : state_;
+    for (const bomchess::Move move : moves) {
+      if (move == bomchess::kNullMove) {
+        state.side_to_move = state.side_to_move == bomchess::Color::kWhite ? bomchess::Color::kBlack
+                                                                           : bomchess::Color::kWhite;
+        state.en_passant = bomchess::Square::kNone;
+        state.ply += 1;
+      } else {
+        bomchess::AdvanceState(state, move);
+      }
+    }
+    state_ = state;
+  }
+
+  void Go(const bomchess::GoParameters& parameters) {
+    StopAndJoin();
+    const bomchess::SearchLimits limits = MakeLimits(parameters, state_.side_to_move);
+    {
+      const std::scoped_lock lock(mutex_);
+      stoppable_ = true;
+      holding_ = parameters.ponder || parameters.infinite;
+    }
+    // searchmoves and mate are not supported, the search always considers every move.
+    search_thread_ = std::thread([this, state = state_, limits] { Run(state, limits); });
+  }
+
+  void Stop() {
+    const std::scoped_lock lock(mutex_);
+    // Only a search that has not reached its stopped callback may be stopped. A Stop() after that would carry over to
+    // the next search.
+    if (stoppable_) {
+      searcher_.Stop();
+    }
+    holding_ = false;
+    released_.notify_all();
+  }
+
+  // The opponent played the expected move, so the ponder search becomes a normal one. It was given the time limit the
+  // go command's clock allows, which it has been using up while pondering.
+  void PonderHit() {
+    const std::scoped_lock lock(mutex_);
+    holding_ = false;
+    released_.notify_all();
+  }
+
+  void Run(const bomchess::PositionState& state, const bomchess::SearchLimits& limits) {
+    const bomchess::SearchCallbacks callbacks{
+        .iteration = [this](const bomchess::SearchInfo& info) { session_->SendInfo(InfoString(info)); },
+        .stopped =
+            [this](bomchess::SearchStopReason, const bomchess::SearchInfo&) {
+              const std::scoped_lock lock(mutex_);
+              stoppable_ = false;
+            },
+    };
+    bomchess::SearchResult result;
+    try {
+      result = searcher_.Search(state, limits, callbacks);
+    } catch (const std::exception& error) {
+      session_->SendInfo(std::string("string ") + error.what());
+      const std::scoped_lock lock(mutex_);
+      stoppable_ = false;
+    }
+
+    {
+      std::unique_lock lock(mutex_);
+      released_.wait(lock, [this] { return !holding_; });
+    }
+    const std::vector<bomchess::Move>& variation = result.info.principal_variation;
+    session_->SendBestMove(result.best_move,
+                           variation.size() > 1 ? std::optional<bomchess::Move>(variation.at(1)) : std::nullopt);
+  }
+
+  bomchess::TranspositionTable table_;
+  bomchess::Searcher searcher_;
+  bomchess::UciSession* session_ = nullptr;
+  // Only used on the session's input thread.
+  bomchess::PositionState state_;
+  std::thread search_thread_;
+
+  std::mutex mutex_;
+  std::condition_variable released_;
+  // true from go until the search's stopped callback.
+  bool stoppable_ = false;
+  // true while a ponder or infinite search's best move waits for stop or ponderhit.
+  bool holding_ = false;
+};
+}  // namespace
+
+int main(const int argc, char* argv[]) {
+  if (argc < 2 || argc > 4) {
+    std::cerr << "Usage: bomchess_uci <network file> [threads] [hash megabytes]\n";
+    return EXIT_FAILURE;
+  }
+  try {
+    const bomchess::NnueNetwork network{std::filesystem::path(argv[1])};
+    const int thread_count = argc > 2 ? std::stoi(argv[2]) : kDefaultThreads;
+    const size_t hash_megabytes = argc > 3 ? std::stoul(argv[3]) : kDefaultHashMegabytes;
+
+    Engine engine(network, thread_count, hash_megabytes);
+    bomchess::UciSession session(std::cin, std::cout, engine.Callbacks(), std::string(kEngineName),
+                                 std::string(kEngineAuthor));
+    engine.SetSession(session);
+    session.Start();
+    session.Join();
+    // The last best move must go out while the session is still alive.
+    engine.StopAndJoin();
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
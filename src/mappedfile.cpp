@@ -0,0 +1,77 @@
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bomchess {
+MappedFile::MappedFile(const std::filesystem::path& path, const bool random_access) {
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  random_access ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Could not open file.");
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    throw std::runtime_error("Could not read file size.");
+  }
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    throw std::runtime_error("Could not memory map file.");
+  }
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == nullptr) {
+    throw std::runtime_error("Could not memory map file.");
+  }
+  data_ = static_cast<const std::byte*>(data);
+  size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file == -1) {
+    throw std::runtime_error("Could not open file.");
+  }
+  struct stat file_status {};
+  if (fstat(file, &file_status) == -1 || file_status.st_size == 0) {
+    close(file);
+    throw std::runtime_error("Could not read file size.");
+  }
+  void* data = mmap(nullptr, file_status.st_size, PROT_READ, MAP_SHARED, file, 0);
+  close(file);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Could not memory map file.");
+  }
+  if (random_access) {
+    madvise(data, file_status.st_size, MADV_RANDOM);
+  }
+  data_ = static_cast<const std::byte*>(data);
+  size_ = static_cast<size_t>(file_status.st_size);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<std::byte*>(data_), size_);
+#endif
+}
+
+std::span<const std::byte> MappedFile::Data() const noexcept { return {data_, size_}; }
+
+}  // namespace bomchess
@@ -1,5 +1,355 @@
-//
-// Created by brigh on 6/20/2024.
-//
-
 #include "movegen.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "color.h"
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+struct CastlingSquares {
+  Square king_to;
+  Square rook_from;
+  Square rook_to;
+  Bitboard between;
+};
+
+/**
+ * Everything about a side that pawn moves and castling depend on, as compile time constants so the code for each side
+ * has no branches on the color.
+ */
+template <Color kColor>
+struct ColorTraits;
+
+template <>
+struct ColorTraits<Color::kWhite> {
+  static constexpr Color kOpponent = Color::kBlack;
+  // Square values count down the board from A8, so white moves towards lower values.
+  static constexpr int kForward = -8;
+  // Pawns that got here with a single push can push again.
+  static constexpr Bitboard kDoublePushRank = kRank3;
+  static constexpr Bitboard kLastRank = kRank8;
+  static constexpr Square kKingStart = Square::kE1;
+  static constexpr CastlingSquares kKingSide{Square::kG1, Square::kH1, Square::kF1,
+                                             SquareBitboard(Square::kF1) | SquareBitboard(Square::kG1)};
+  static constexpr CastlingSquares kQueenSide{
+      Square::kC1, Square::kA1, Square::kD1,
+      SquareBitboard(Square::kB1) | SquareBitboard(Square::kC1) | SquareBitboard(Square::kD1)};
+};
+
+template <>
+struct ColorTraits<Color::kBlack> {
+  static constexpr Color kOpponent = Color::kWhite;
+  static constexpr int kForward = 8;
+  static constexpr Bitboard kDoublePushRank = kRank6;
+  static constexpr Bitboard kLastRank = kRank1;
+  static constexpr Square kKingStart = Square::kE8;
+  static constexpr CastlingSquares kKingSide{Square::kG8, Square::kH8, Square::kF8,
+                                             SquareBitboard(Square::kF8) | SquareBitboard(Square::kG8)};
+  static constexpr CastlingSquares kQueenSide{
+      Square::kC8, Square::kA8, Square::kD8,
+      SquareBitboard(Square::kB8) | SquareBitboard(Square::kC8) | SquareBitboard(Square::kD8)};
+};
+
+constexpr std::array<PieceType, 4> kPromotions{PieceType::kQueen, PieceType::kRook, PieceType::kBishop,
+                                               PieceType::kKnight};
+
+template <int kDelta>
+constexpr Bitboard Shift(const Bitboard bitboard) {
+  if constexpr (kDelta > 0) {
+    return bitboard << kDelta;
+  } else {
+    return bitboard >> -kDelta;
+  }
+}
+
+/**
+ * Adds a move to each target square from the square kDelta behind it.
+ */
+template <int kDelta>
+void AddPawnMoves(Bitboard targets, const Bitboard last_rank, std::vector<Move>& moves) {
+  for (; targets != kEmptyBitboard; targets &= targets - 1) {
+    const int to = std::countr_zero(targets);
+    const Move move{static_cast<Square>(to - kDelta), static_cast<Square>(to), PieceType::kNone};
+    if ((SquareBitboard(static_cast<Square>(to)) & last_rank) == kEmptyBitboard) {
+      moves.push_back(move);
+      continue;
+    }
+    for (const PieceType promotion : kPromotions) {
+      moves.emplace_back(move.from_square, move.to_square, promotion);
+    }
+  }
+}
+
+template <Color kColor>
+void GeneratePawnMovesFor(const Position& position, const Square en_passant, std::vector<Move>& moves) {
+  using Traits = ColorTraits<kColor>;
+  const PositionBitboards bitboards = MakeBitboards(position);
+  const Bitboard pawns = bitboards.Pieces(Piece{kColor, PieceType::kPawn});
+  const Bitboard empty = ~bitboards.Occupied();
+  Bitboard targets = bitboards.Pieces(Traits::kOpponent);
+  if (IsValidSquare(en_passant)) {
+    targets |= SquareBitboard(en_passant);
+  }
+
+  const Bitboard single_pushes = Shift<Traits::kForward>(pawns) & empty;
+  const Bitboard double_pushes = Shift<Traits::kForward>(single_pushes & Traits::kDoublePushRank) & empty;
+  AddPawnMoves<Traits::kForward>(single_pushes, Traits::kLastRank, moves);
+  AddPawnMoves<2 * Traits::kForward>(double_pushes, kEmptyBitboard, moves);
+  // Captures towards the a file, then towards the h file.
+  AddPawnMoves<Traits::kForward - 1>(Shift<Traits::kForward - 1>(pawns & ~kFileA) & targets, Traits::kLastRank,
+                                     moves);
+  AddPawnMoves<Traits::kForward + 1>(Shift<Traits::kForward + 1>(pawns & ~kFileH) & targets, Traits::kLastRank,
+                                     moves);
+}
+
+template <Color kColor>
+bool CanCastle(const PositionBitboards& bitboards, const CastlingSquares& castling) {
+  using Traits = ColorTraits<kColor>;
+  if ((bitboards.Occupied() & castling.between) != kEmptyBitboard ||
+      (bitboards.Pieces(Piece{kColor, PieceType::kRook}) & SquareBitboard(castling.rook_from)) == kEmptyBitboard) {
+    return false;
+  }
+  const Bitboard opponent = bitboards.Pieces(Traits::kOpponent);
+  // The king crosses the rook's destination on the way to its own.
+  for (const Square square : {Traits::kKingStart, castling.rook_to, castling.king_to}) {
+    if ((AttackersTo(bitboards, square, bitboards.Occupied()) & opponent) != kEmptyBitboard) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <Color kColor>
+void GenerateCastlingMovesFor(const Position& position, const CastlingRights rights, std::vector<Move>& moves) {
+  using Traits = ColorTraits<kColor>;
+  if (!rights.king_side && !rights.queen_side) {
+    return;
+  }
+  const PositionBitboards bitboards = MakeBitboards(position);
+  if ((bitboards.Pieces(Piece{kColor, PieceType::kKing}) & SquareBitboard(Traits::kKingStart)) == kEmptyBitboard) {
+    return;
+  }
+  if (rights.king_side && CanCastle<kColor>(bitboards, Traits::kKingSide)) {
+    moves.emplace_back(Traits::kKingStart, Traits::kKingSide.king_to, PieceType::kNone);
+  }
+  if (rights.queen_side && CanCastle<kColor>(bitboards, Traits::kQueenSide)) {
+    moves.emplace_back(Traits::kKingStart, Traits::kQueenSide.king_to, PieceType::kNone);
+  }
+}
+
+/**
+ * @return The rook's squares if the king move is castling, otherwise nullptr.
+ */
+template <Color kColor>
+const CastlingSquares* CastlingRookSquares(const PieceType moved, const Move move) {
+  using Traits = ColorTraits<kColor>;
+  if (moved != PieceType::kKing || move.from_square != Traits::kKingStart) {
+    return nullptr;
+  }
+  if (move.to_square == Traits::kKingSide.king_to) {
+    return &Traits::kKingSide;
+  }
+  if (move.to_square == Traits::kQueenSide.king_to) {
+    return &Traits::kQueenSide;
+  }
+  return nullptr;
+}
+
+template <Color kColor>
+UndoInfo MakeMoveFor(Position& position, const Move move) {
+  using Traits = ColorTraits<kColor>;
+  const Piece mover = position.at(move.from_square);
+  UndoInfo undo;
+  if (position.at(move.to_square) != pieces::kNone) {
+    undo = {position.at(move.to_square), move.to_square};
+  } else if (mover.type == PieceType::kPawn && GetFile(move.from_square) != GetFile(move.to_square)) {
+    // The pawn taken en passant is one square behind the target.
+    undo.captured_square = static_cast<Square>(std::to_underlying(move.to_square) - Traits::kForward);
+    undo.captured = position.at(undo.captured_square);
+    position.at(undo.captured_square) = pieces::kNone;
+  } else if (const CastlingSquares* castling = CastlingRookSquares<kColor>(mover.type, move); castling != nullptr) {
+    position.at(castling->rook_to) = position.at(castling->rook_from);
+    position.at(castling->rook_from) = pieces::kNone;
+  }
+  position.at(move.to_square) = move.promotion == PieceType::kNone ? mover : Piece{kColor, move.promotion};
+  position.at(move.from_square) = pieces::kNone;
+  return undo;
+}
+
+template <Color kColor>
+void UnmakeMoveFor(Position& position, const Move move, const UndoInfo undo) {
+  const Piece moved = move.promotion == PieceType::kNone ? position.at(move.to_square)
+                                                         : Piece{kColor, PieceType::kPawn};
+  position.at(move.to_square) = pieces::kNone;
+  position.at(move.from_square) = moved;
+  if (IsValidSquare(undo.captured_square)) {
+    position.at(undo.captured_square) = undo.captured;
+  } else if (const CastlingSquares* castling = CastlingRookSquares<kColor>(moved.type, move); castling != nullptr) {
+    position.at(castling->rook_from) = position.at(castling->rook_to);
+    position.at(castling->rook_to) = pieces::kNone;
+  }
+}
+
+Bitboard PieceAttacks(const PieceType piece_type, const Square square, const Bitboard occupied) {
+  switch (piece_type) {
+    case PieceType::kKnight:
+      return KnightAttacks(square);
+    case PieceType::kBishop:
+      return BishopAttacks(square, occupied);
+    case PieceType::kRook:
+      return RookAttacks(square, occupied);
+    case PieceType::kQueen:
+      return QueenAttacks(square, occupied);
+    case PieceType::kKing:
+      return KingAttacks(square);
+    default:
+      return kEmptyBitboard;
+  }
+}
+
+void CheckSquares(const Move move) {
+  if (!IsValidSquare(move.from_square) || !IsValidSquare(move.to_square)) {
+    throw std::invalid_argument("Invalid move squares.");
+  }
+}
+}  // namespace
+
+void GeneratePawnMoves(const Position& position, const Color side, const Square en_passant, std::vector<Move>& moves) {
+  switch (side) {
+    case Color::kWhite:
+      return GeneratePawnMovesFor<Color::kWhite>(position, en_passant, moves);
+    case Color::kBlack:
+      return GeneratePawnMovesFor<Color::kBlack>(position, en_passant, moves);
+    default:
+      throw std::invalid_argument("Invalid color.");
+  }
+}
+
+void GenerateCastlingMoves(const Position& position, const Color side, const CastlingRights rights,
+                           std::vector<Move>& moves) {
+  switch (side) {
+    case Color::kWhite:
+      return GenerateCastlingMovesFor<Color::kWhite>(position, rights, moves);
+    case Color::kBlack:
+      return GenerateCastlingMovesFor<Color::kBlack>(position, rights, moves);
+    default:
+      throw std::invalid_argument("Invalid color.");
+  }
+}
+
+void GeneratePieceMoves(const Position& position, const Color side, std::vector<Move>& moves) {
+  const PositionBitboards bitboards = MakeBitboards(position);
+  const Bitboard own = bitboards.Pieces(side);
+  for (Bitboard pieces = own & ~bitboards.Pieces(PieceType::kPawn); pieces != kEmptyBitboard; pieces &= pieces - 1) {
+    const Square from = LowestSquare(pieces);
+    Bitboard targets = PieceAttacks(position.at(from).type, from, bitboards.Occupied()) & ~own;
+    for (; targets != kEmptyBitboard; targets &= targets - 1) {
+      moves.emplace_back(from, LowestSquare(targets), PieceType::kNone);
+    }
+  }
+}
+
+void GenerateLegalMoves(const Position& position, const Color side, const Square en_passant,
+                        const CastlingRights rights, std::vector<Move>& moves) {
+  const size_t first = moves.size();
+  GeneratePawnMoves(position, side, en_passant, moves);
+  GeneratePieceMoves(position, side, moves);
+  GenerateCastlingMoves(position, side, rights, moves);
+  const auto illegal = std::remove_if(moves.begin() + static_cast<std::ptrdiff_t>(first), moves.end(),
+                                      [&position, side](const Move move) {
+                                        Position after = position;
+                                        std::ignore = MakeMove(after, move);
+                                        return IsInCheck(after, side);
+                                      });
+  moves.erase(illegal, moves.end());
+}
+
+bool IsInCheck(const Position& position, const Color side) {
+  const PositionBitboards bitboards = MakeBitboards(position);
+  const Bitboard king = bitboards.Pieces(Piece{side, PieceType::kKing});
+  if (king == kEmptyBitboard) {
+    throw std::invalid_argument("Side has no king.");
+  }
+  return (AttackersTo(bitboards, LowestSquare(king), bitboards.Occupied()) & ~bitboards.Pieces(side)) != kEmptyBitboard;
+}
+
+bool IsCapture(const Position& position, const Move move) {
+  return position.at(move.to_square) != pieces::kNone || (position.at(move.from_square).type == PieceType::kPawn &&
+                                                          FileDistance(move.from_square, move.to_square) != 0);
+}
+
+UndoInfo MakeMove(Position& position, const Move move) {
+  CheckSquares(move);
+  switch (position.at(move.from_square).color) {
+    case Color::kWhite:
+      return MakeMoveFor<Color::kWhite>(position, move);
+    case Color::kBlack:
+      return MakeMoveFor<Color::kBlack>(position, move);
+    default:
+      throw std::invalid_argument("No piece to move.");
+  }
+}
+
+void UnmakeMove(Position& position, const Move move, const UndoInfo undo) {
+  CheckSquares(move);
+  switch (position.at(move.to_square).color) {
+    case Color::kWhite:
+      return UnmakeMoveFor<Color::kWhite>(position, move, undo);
+    case Color::kBlack:
+      return UnmakeMoveFor<Color::kBlack>(position, move, undo);
+    default:
+      throw std::invalid_argument("No piece to take back.");
+  }
+}
+
+void AdvanceState(PositionState& state, const Move move) {
+  const Piece mover = state.position.at(move.from_square);
+  if (mover.color != state.side_to_move || mover == pieces::kNone) {
+    throw std::invalid_argument("The side to move has no piece on the from square.");
+  }
+  MakeMove(state.position, move);
+
+  state.en_passant = Square::kNone;
+  if (mover.type == PieceType::kPawn && RankDistance(move.from_square, move.to_square) == 2) {
+    state.en_passant =
+        static_cast<Square>((std::to_underlying(move.from_square) + std::to_underlying(move.to_square)) / 2);
+  }
+  if (mover.type == PieceType::kKing) {
+    state.castling.at(std::to_underlying(mover.color)) = {};
+  }
+  // Moving a rook from its corner or capturing it there loses that side's right.
+  for (const Square square : {move.from_square, move.to_square}) {
+    switch (square) {
+      case Square::kA1:
+        state.castling.front().queen_side = false;
+        break;
+      case Square::kH1:
+        state.castling.front().king_side = false;
+        break;
+      case Square::kA8:
+        state.castling.back().queen_side = false;
+        break;
+      case Square::kH8:
+        state.castling.back().king_side = false;
+        break;
+      default:
+        break;
+    }
+  }
+  state.side_to_move = state.side_to_move == Color::kWhite ? Color::kBlack : Color::kWhite;
+  state.ply += 1;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,164 @@
+#include "movepicker.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "see.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+bool HasValidSquares(const Move move) noexcept {
+  return IsValidSquare(move.from_square) && IsValidSquare(move.to_square);
+}
+}  // namespace
+
+void HistoryTable::Update(const Color color, const Move move, const int bonus) {
+  if (!HasValidSquares(move)) {
+    throw std::invalid_argument("Invalid move squares.");
+  }
+  int& score = scores_.at(ColorIndex(color))
+                   .at(std::to_underlying(move.from_square))
+                   .at(std::to_underlying(move.to_square));
+  const int clamped_bonus = std::clamp(bonus, -kMaxHistory, kMaxHistory);
+  // Scores near the limit move less, so they can't run past it and old results slowly lose their weight.
+  score += clamped_bonus - score * std::abs(clamped_bonus) / kMaxHistory;
+}
+
+int HistoryTable::Get(const Color color, const Move move) const {
+  if (!HasValidSquares(move)) {
+    throw std::invalid_argument("Invalid move squares.");
+  }
+  return scores_.at(ColorIndex(color)).at(std::to_underlying(move.from_square)).at(std::to_underlying(move.to_square));
+}
+
+void HistoryTable::Clear() noexcept { scores_ = {}; }
+
+MovePicker::MovePicker(const Position& position, const Move hash_move, const std::array<Move, 2> killers,
+                       const HistoryTable& history, const MovePickerGenerators& generators)
+    : position_(position), hash_move_(hash_move), killers_(killers), history_(history), generators_(generators) {
+  if (killers_.back() == killers_.front()) {
+    killers_.back() = kNullMove;
+  }
+}
+
+std::optional<Move> MovePicker::Next() {
+  switch (stage_) {
+    case Stage::kHashMove:
+      stage_ = Stage::kGenerateCaptures;
+      if (HasValidSquares(hash_move_) && generators_.is_pseudo_legal(hash_move_)) {
+        return hash_move_;
+      }
+      hash_move_ = kNullMove;
+      [[fallthrough]];
+    case Stage::kGenerateCaptures:
+      generated_.clear();
+      generators_.captures(generated_);
+      scored_.clear();
+      for (const Move capture : generated_) {
+        const Piece attacker = position_.at(capture.from_square);
+        PieceType victim = position_.at(capture.to_square).type;
+        // Search sends queen promotions through this stage too, so only en passant counts as taking a pawn from an
+        // empty square. Other promotions score for the new piece alone.
+        if (victim == PieceType::kNone && IsCapture(position_, capture)) {
+          victim = PieceType::kPawn;
+        }
+        scored_.emplace_back(capture, (PieceValue(victim) + PieceValue(capture.promotion)) * 100 -
+                                          PieceValue(attacker.type));
+      }
+      next_scored_ = 0;
+      bad_captures_.clear();
+      stage_ = Stage::kCaptures;
+      [[fallthrough]];
+    case Stage::kCaptures:
+      for (std::optional<Move> capture = PickBest(); capture.has_value(); capture = PickBest()) {
+        if (SEEGreaterEqual(position_, *capture, 0)) {
+          return capture;
+        }
+        bad_captures_.push_back(*capture);
+      }
+      stage_ = Stage::kKillers;
+      [[fallthrough]];
+    case Stage::kKillers:
+      while (killer_index_ < killers_.size()) {
+        Move& killer = killers_.at(killer_index_);
+        killer_index_ += 1;
+        if (IsPlayableKiller(killer)) {
+          return killer;
+        }
+        // Only killers that were played get skipped in the quiet stage.
+        killer = kNullMove;
+      }
+      stage_ = Stage::kGenerateQuiets;
+      [[fallthrough]];
+    case Stage::kGenerateQuiets:
+      generated_.clear();
+      generators_.quiets(generated_);
+      scored_.clear();
+      for (const Move quiet : generated_) {
+        scored_.emplace_back(quiet, history_.Get(position_.at(quiet.from_square).color, quiet));
+      }
+      next_scored_ = 0;
+      stage_ = Stage::kQuiets;
+      [[fallthrough]];
+    case Stage::kQuiets:
+      if (const std::optional<Move> quiet = PickBest(); quiet.has_value()) {
+        return quiet;
+      }
+      next_bad_capture_ = 0;
+      stage_ = Stage::kBadCaptures;
+      [[fallthrough]];
+    case Stage::kBadCaptures:
+      if (next_bad_capture_ < bad_captures_.size()) {
+        next_bad_capture_ += 1;
+        return bad_captures_.at(next_bad_capture_ - 1);
+      }
+      stage_ = Stage::kDone;
+      [[fallthrough]];
+    case Stage::kDone:
+    default:
+      return std::nullopt;
+  }
+}
+
+bool MovePicker::IsPlayableKiller(const Move killer) const {
+  if (!HasValidSquares(killer) || killer == hash_move_) {
+    return false;
+  }
+  // Killers are quiet moves. generated_ still holds this node's captures, which covers en passant.
+  if (position_.at(killer.to_square) != pieces::kNone || std::ranges::find(generated_, killer) != generated_.end()) {
+    return false;
+  }
+  return generators_.is_pseudo_legal(killer);
+}
+
+bool MovePicker::AlreadyPicked(const Move move) const noexcept {
+  return move == hash_move_ || (stage_ == Stage::kQuiets && std::ranges::find(killers_, move) != killers_.end());
+}
+
+// Selection rather than a full sort, most nodes cut off after a move or two.
+std::optional<Move> MovePicker::PickBest() {
+  while (next_scored_ < scored_.size()) {
+    const auto best = std::ranges::max_element(scored_.begin() + static_cast<std::ptrdiff_t>(next_scored_),
+                                               scored_.end(), {}, &ScoredMove::score);
+    std::iter_swap(best, scored_.begin() + static_cast<std::ptrdiff_t>(next_scored_));
+    const Move move = scored_.at(next_scored_).move;
+    next_scored_ += 1;
+    if (!AlreadyPicked(move)) {
+      return move;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace bomchess
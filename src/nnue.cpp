@@ -0,0 +1,302 @@
+#include "nnue.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BOMCHESS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC allows any intrinsic in any function, GCC and Clang need the instruction set enabled per function.
+#if defined(__GNUC__) || defined(__clang__)
+#define BOMCHESS_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#else
+#define BOMCHESS_TARGET(instruction_set)
+#endif
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+constexpr std::array<char, 4> kMagic{'B', 'N', 'U', 'E'};
+constexpr int kFeatureCount = 768;
+// The SIMD kernels sum in 32 bit lanes. Each product is at most 255 * 32768 in magnitude, and with 1024 hidden values
+// no lane sums more than 256 of them, which just fits. Larger hidden layers could overflow the lanes.
+constexpr int kMaxHiddenSize = 1024;
+// Hidden sizes must fill whole AVX2 registers.
+constexpr int kHiddenSizeMultiple = 16;
+constexpr int kActivationMax = 255;
+constexpr int kOutputQuantization = 64;
+constexpr int kEvaluationScale = 400;
+
+// The whole dot product can be far larger than a lane, so every kernel returns it in 64 bits.
+using ClippedDotKernel = int64_t (*)(const int16_t* activations, const int16_t* weights, int size);
+
+int64_t ClippedDotScalar(const int16_t* activations, const int16_t* weights, const int size) {
+  int64_t sum = 0;
+  for (int i = 0; i < size; ++i) {
+    sum += std::clamp<int32_t>(activations[i], 0, kActivationMax) * weights[i];
+  }
+  return sum;
+}
+
+#ifdef BOMCHESS_X86
+template <size_t kLanes>
+int64_t SumLanes(const std::array<int32_t, kLanes>& lanes) {
+  int64_t sum = 0;
+  for (const int32_t lane : lanes) {
+    sum += lane;
+  }
+  return sum;
+}
+
+BOMCHESS_TARGET("sse2") int64_t ClippedDotSse2(const int16_t* activations, const int16_t* weights, const int size) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i activation_max = _mm_set1_epi16(kActivationMax);
+  __m128i sum = zero;
+  for (int i = 0; i < size; i += 8) {
+    __m128i activation = _mm_loadu_si128(reinterpret_cast<const __m128i*>(activations + i));
+    activation = _mm_min_epi16(_mm_max_epi16(activation, zero), activation_max);
+    const __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(activation, weight));
+  }
+  std::array<int32_t, 4> lanes{};
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.data()), sum);
+  return SumLanes(lanes);
+}
+
+BOMCHESS_TARGET("avx2") int64_t ClippedDotAvx2(const int16_t* activations, const int16_t* weights, const int size) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i activation_max = _mm256_set1_epi16(kActivationMax);
+  __m256i sum = zero;
+  for (int i = 0; i < size; i += 16) {
+    __m256i activation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(activations + i));
+    activation = _mm256_min_epi16(_mm256_max_epi16(activation, zero), activation_max);
+    const __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(activation, weight));
+  }
+  std::array<int32_t, 8> lanes{};
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.data()), sum);
+  return SumLanes(lanes);
+}
+
+bool CpuSupportsSse2() noexcept {
+#ifdef _MSC_VER
+  std::array<int, 4> registers{};
+  __cpuid(registers.data(), 1);
+  return (registers.at(3) & (1 << 26)) != 0;
+#else
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool CpuSupportsAvx2() noexcept {
+#ifdef _MSC_VER
+  std::array<int, 4> registers{};
+  __cpuid(registers.data(), 1);
+  const bool os_saves_registers = (registers.at(2) & (1 << 27)) != 0;
+  const bool has_avx = (registers.at(2) & (1 << 28)) != 0;
+  // The OS must save the full ymm registers on context switches for AVX to be usable.
+  if (!os_saves_registers || !has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(registers.data(), 7, 0);
+  return (registers.at(1) & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+ClippedDotKernel GetKernel(const SimdLevel simd_level) noexcept {
+#ifdef BOMCHESS_X86
+  switch (simd_level) {
+    case SimdLevel::kAvx2:
+      return ClippedDotAvx2;
+    case SimdLevel::kSse2:
+      return ClippedDotSse2;
+    default:
+      break;
+  }
+#endif
+  return ClippedDotScalar;
+}
+
+// Network files are little endian, so big endian hosts swap every value after reading it.
+template <typename T>
+void ReadValues(std::istream& network_stream, std::span<T> values) {
+  network_stream.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+  if (!network_stream) {
+    throw std::runtime_error("Network file is truncated.");
+  }
+  if constexpr (std::endian::native == std::endian::big) {
+    for (T& value : values) {
+      value = std::byteswap(value);
+    }
+  }
+}
+
+template <typename T>
+void ReadValues(std::istream& network_stream, std::vector<T>& values, const size_t count) {
+  values.resize(count);
+  ReadValues(network_stream, std::span(values));
+}
+
+size_t FeatureIndex(const Piece piece, const Square square, const Color perspective) {
+  if (piece.color != Color::kWhite && piece.color != Color::kBlack) {
+    throw std::invalid_argument("Invalid piece color.");
+  }
+  if (std::to_underlying(piece.type) < 0 || piece.type >= PieceType::kNone) {
+    throw std::invalid_argument("Invalid piece type.");
+  }
+  if (!IsValidSquare(square)) {
+    throw std::invalid_argument("Invalid square.");
+  }
+  const size_t opponent_offset = piece.color == perspective ? 0 : 384;
+  // Black sees the board mirrored, so both sides see their own pieces start on the bottom ranks.
+  const size_t relative_square = perspective == Color::kWhite ? std::to_underlying(square)
+                                                              : std::to_underlying(square) ^ 56;
+  return opponent_offset + std::to_underlying(piece.type) * 64 + relative_square;
+}
+}  // namespace
+
+NnueNetwork::NnueNetwork(const std::filesystem::path& path) {
+  std::ifstream network_file(path, std::ios::binary);
+  if (!network_file) {
+    throw std::runtime_error("Could not open network file.");
+  }
+  Load(network_file);
+}
+
+NnueNetwork::NnueNetwork(std::istream& network_stream) { Load(network_stream); }
+
+void NnueNetwork::Load(std::istream& network_stream) {
+  std::array<char, 4> magic{};
+  uint32_t hidden_size = 0;
+  network_stream.read(magic.data(), magic.size());
+  if (!network_stream || magic != kMagic) {
+    throw std::runtime_error("Not a network file.");
+  }
+  ReadValues(network_stream, std::span(&hidden_size, 1));
+  if (hidden_size == 0 || hidden_size > kMaxHiddenSize || hidden_size % kHiddenSizeMultiple != 0) {
+    throw std::runtime_error("Unsupported network hidden layer size.");
+  }
+  hidden_size_ = static_cast<int>(hidden_size);
+  ReadValues(network_stream, feature_weights_, static_cast<size_t>(kFeatureCount) * hidden_size_);
+  ReadValues(network_stream, feature_biases_, hidden_size_);
+  ReadValues(network_stream, output_weights_, 2 * static_cast<size_t>(hidden_size_));
+  ReadValues(network_stream, std::span(&output_bias_, 1));
+}
+
+int NnueNetwork::HiddenSize() const noexcept { return hidden_size_; }
+
+SimdLevel NnueNetwork::SupportedSimdLevel() noexcept {
+#ifdef BOMCHESS_X86
+  static const SimdLevel supported_level = CpuSupportsAvx2()   ? SimdLevel::kAvx2
+                                           : CpuSupportsSse2() ? SimdLevel::kSse2
+                                                               : SimdLevel::kScalar;
+  return supported_level;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+SimdLevel NnueNetwork::GetSimdLevel() const noexcept { return simd_level_; }
+
+void NnueNetwork::SetSimdLevel(const SimdLevel simd_level) {
+  if (std::to_underlying(simd_level) < 0 || simd_level > SupportedSimdLevel()) {
+    throw std::invalid_argument("SIMD level is not supported on this CPU.");
+  }
+  simd_level_ = simd_level;
+}
+
+NnueAccumulator NnueNetwork::MakeAccumulator(const Position& position) const {
+  NnueAccumulator accumulator{feature_biases_, feature_biases_};
+  for (const Square square : kAllSquares) {
+    if (const Piece piece = position.at(square); piece != pieces::kNone) {
+      AddPiece(accumulator, piece, square);
+    }
+  }
+  return accumulator;
+}
+
+void NnueNetwork::AddPiece(NnueAccumulator& accumulator, const Piece piece, const Square square) const {
+  UpdateFeature(accumulator, piece, square, 1);
+}
+
+void NnueNetwork::RemovePiece(NnueAccumulator& accumulator, const Piece piece, const Square square) const {
+  UpdateFeature(accumulator, piece, square, -1);
+}
+
+void NnueNetwork::UpdateFeature(NnueAccumulator& accumulator, const Piece piece, const Square square,
+                                const int sign) const {
+  const size_t white_offset = FeatureIndex(piece, square, Color::kWhite) * hidden_size_;
+  const size_t black_offset = FeatureIndex(piece, square, Color::kBlack) * hidden_size_;
+  // Plain loops over int16, the compiler vectorizes these for whatever instruction set the library is built with.
+  for (int i = 0; i < hidden_size_; ++i) {
+    accumulator.white_perspective[i] += static_cast<int16_t>(sign * feature_weights_[white_offset + i]);
+    accumulator.black_perspective[i] += static_cast<int16_t>(sign * feature_weights_[black_offset + i]);
+  }
+}
+
+int NnueNetwork::Evaluate(const NnueAccumulator& accumulator, const Color side_to_move) const {
+  if (side_to_move != Color::kWhite && side_to_move != Color::kBlack) {
+    throw std::invalid_argument("Side to move must be white or black.");
+  }
+  const std::vector<int16_t>& own = side_to_move == Color::kWhite ? accumulator.white_perspective
+                                                                   : accumulator.black_perspective;
+  const std::vector<int16_t>& opponent = side_to_move == Color::kWhite ? accumulator.black_perspective
+                                                                        : accumulator.white_perspective;
+  const ClippedDotKernel kernel = GetKernel(simd_level_);
+  const int64_t output = output_bias_ + kernel(own.data(), output_weights_.data(), hidden_size_) +
+                         kernel(opponent.data(), output_weights_.data() + hidden_size_, hidden_size_);
+  return static_cast<int>(output * kEvaluationScale / (kActivationMax * kOutputQuantization));
+}
+
+std::vector<int> NnueNetwork::EvaluateBatch(const std::span<const Position> positions,
+                                            const std::span<const Color> sides_to_move) const {
+  if (positions.size() != sides_to_move.size()) {
+    throw std::invalid_argument("Every position needs a side to move.");
+  }
+  std::vector<int> evaluations;
+  evaluations.reserve(positions.size());
+  if (positions.empty()) {
+    return evaluations;
+  }
+  NnueAccumulator accumulator = MakeAccumulator(positions.front());
+  evaluations.push_back(Evaluate(accumulator, sides_to_move.front()));
+  for (size_t i = 1; i < positions.size(); ++i) {
+    for (const Square square : kAllSquares) {
+      const Piece previous_piece = positions[i - 1].at(square);
+      const Piece piece = positions[i].at(square);
+      if (previous_piece == piece) {
+        continue;
+      }
+      if (previous_piece != pieces::kNone) {
+        RemovePiece(accumulator, previous_piece, square);
+      }
+      if (piece != pieces::kNone) {
+        AddPiece(accumulator, piece, square);
+      }
+    }
+    evaluations.push_back(Evaluate(accumulator, sides_to_move[i]));
+  }
+  return evaluations;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,159 @@
+#include "pgnannotations.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bomchess {
+namespace {
+// Anything larger is surely a typo, and keeps well clear of the mate range.
+constexpr double kMaxPawns = 9000;
+
+std::optional<int64_t> ParseDigits(const std::string_view digits) noexcept {
+  int64_t value = 0;
+  const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+  if (digits.empty() || digits.front() == '-' || error != std::errc{} || end != digits.data() + digits.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+void AppendNumber(const int64_t number, const int width, std::string& buffer) {
+  std::array<char, 24> digits{};
+  const char* end = std::to_chars(digits.data(), digits.data() + digits.size(), number).ptr;
+  const std::string_view number_text(digits.data(), end);
+  buffer.append(static_cast<size_t>(std::max(width - static_cast<int>(number_text.size()), 0)), '0');
+  buffer += number_text;
+}
+
+void AppendClock(const int32_t milliseconds, std::string& buffer) {
+  const int64_t seconds = milliseconds / 1000;
+  AppendNumber(seconds / 3600, 1, buffer);
+  buffer += ':';
+  AppendNumber(seconds / 60 % 60, 2, buffer);
+  buffer += ':';
+  AppendNumber(seconds % 60, 2, buffer);
+  if (const int32_t fraction = milliseconds % 1000; fraction != 0) {
+    std::string fraction_digits;
+    AppendNumber(fraction, 3, fraction_digits);
+    buffer += '.';
+    buffer += std::string_view(fraction_digits).substr(0, fraction_digits.find_last_not_of('0') + 1);
+  }
+}
+
+void AppendEvaluation(const int32_t evaluation, std::string& buffer) {
+  if (IsMateEvaluation(evaluation)) {
+    buffer += '#';
+    AppendNumber(evaluation > 0 ? kMateEvaluation - evaluation : -kMateEvaluation - evaluation, 1, buffer);
+    return;
+  }
+  if (evaluation < 0) {
+    buffer += '-';
+  }
+  const int32_t centipawns = std::abs(evaluation);
+  AppendNumber(centipawns / 100, 1, buffer);
+  buffer += '.';
+  AppendNumber(centipawns % 100, 2, buffer);
+}
+
+int32_t At(const std::vector<int32_t>& values, const size_t move) noexcept {
+  return move < values.size() ? values[move] : kNoAnnotation;
+}
+}  // namespace
+
+std::optional<int32_t> ParseClock(std::string_view clock) noexcept {
+  int64_t fraction_ms = 0;
+  if (const size_t point = clock.find('.'); point != std::string_view::npos) {
+    // Only milliseconds are kept, further digits are dropped.
+    const std::string_view fraction = clock.substr(point + 1, 3);
+    const std::optional<int64_t> digits = ParseDigits(fraction);
+    if (!digits.has_value() || clock.substr(point + 1).find_first_not_of("0123456789") != std::string_view::npos) {
+      return std::nullopt;
+    }
+    fraction_ms = *digits * (fraction.size() == 1 ? 100 : fraction.size() == 2 ? 10 : 1);
+    clock = clock.substr(0, point);
+  }
+  if (clock.empty()) {
+    return std::nullopt;
+  }
+  int64_t seconds = 0;
+  for (int part = 0; part < 3 && !clock.empty(); ++part) {
+    const size_t colon = clock.find(':');
+    const std::optional<int64_t> value = ParseDigits(clock.substr(0, colon));
+    if (!value.has_value() || *value > std::numeric_limits<int32_t>::max() / 1000) {
+      return std::nullopt;
+    }
+    seconds = seconds * 60 + *value;
+    clock = colon == std::string_view::npos ? std::string_view() : clock.substr(colon + 1);
+    if (colon != std::string_view::npos && clock.empty()) {
+      return std::nullopt;
+    }
+  }
+  const int64_t milliseconds = seconds * 1000 + fraction_ms;
+  if (!clock.empty() || milliseconds >= std::numeric_limits<int32_t>::max()) {
+    return std::nullopt;
+  }
+  return static_cast<int32_t>(milliseconds);
+}
+
+std::optional<int32_t> ParseEvaluation(std::string_view evaluation) noexcept {
+  evaluation = evaluation.substr(0, evaluation.find(','));
+  if (evaluation.starts_with('#')) {
+    evaluation.remove_prefix(1);
+    const bool black_mates = evaluation.starts_with('-');
+    if (black_mates || evaluation.starts_with('+')) {
+      evaluation.remove_prefix(1);
+    }
+    const std::optional<int64_t> moves = ParseDigits(evaluation);
+    if (!moves.has_value() || *moves >= 1000) {
+      return std::nullopt;
+    }
+    return MateEvaluation(static_cast<int32_t>(black_mates ? -*moves : *moves));
+  }
+  if (evaluation.starts_with('+')) {
+    evaluation.remove_prefix(1);
+  }
+  double pawns = 0;
+  const auto [end, error] = std::from_chars(evaluation.data(), evaluation.data() + evaluation.size(), pawns);
+  if (evaluation.empty() || error != std::errc{} || end != evaluation.data() + evaluation.size() ||
+      !(std::abs(pawns) <= kMaxPawns)) {
+    return std::nullopt;
+  }
+  return static_cast<int32_t>(std::lround(pawns * 100));
+}
+
+void AppendAnnotations(const MoveAnnotations& annotations, const size_t move, std::string& buffer) {
+  const auto start_command = [&buffer](const std::string_view name) {
+    if (!buffer.empty() && buffer.back() != ' ') {
+      buffer += ' ';
+    }
+    buffer += "[%";
+    buffer += name;
+    buffer += ' ';
+  };
+  if (const int32_t evaluation = At(annotations.evaluation, move); evaluation != kNoAnnotation) {
+    start_command("eval");
+    AppendEvaluation(evaluation, buffer);
+    buffer += ']';
+  }
+  if (const int32_t clock = At(annotations.clock_ms, move); clock != kNoAnnotation) {
+    start_command("clk");
+    AppendClock(clock, buffer);
+    buffer += ']';
+  }
+  if (const int32_t elapsed = At(annotations.elapsed_ms, move); elapsed != kNoAnnotation) {
+    start_command("emt");
+    AppendClock(elapsed, buffer);
+    buffer += ']';
+  }
+}
+
+}  // namespace bomchess
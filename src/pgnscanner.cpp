@@ -0,0 +1,353 @@
+#include "pgnscanner.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "game.h"
+#include "pgnannotations.h"
+#include "pgnwriter.h"
+
+namespace bomchess {
+namespace {
+constexpr std::array<std::string_view, 4> kTerminationMarkers{"1-0", "0-1", "1/2-1/2", "*"};
+constexpr std::string_view kTokenDelimiters = "{}();$";
+// Indexed by LazyPgnGame::AnnotationType.
+constexpr std::array<std::string_view, 3> kAnnotationNames{"clk", "emt", "eval"};
+
+bool IsSpace(const char c) noexcept { return std::isspace(static_cast<unsigned char>(c)) != 0; }
+
+bool IsDigit(const char c) noexcept { return std::isdigit(static_cast<unsigned char>(c)) != 0; }
+
+// Returns 0 if the text doesn't start with a termination marker token.
+size_t TerminationLength(const std::string_view text) noexcept {
+  for (const std::string_view marker : kTerminationMarkers) {
+    if (text.starts_with(marker) && (text.size() == marker.size() || IsSpace(text[marker.size()]))) {
+      return marker.size();
+    }
+  }
+  return 0;
+}
+
+bool IsTokenStart(const std::string_view text, const size_t position) noexcept {
+  return position == 0 || IsSpace(text[position - 1]) || text[position - 1] == '}' || text[position - 1] == ')';
+}
+
+// Comments are written on one line, with single spaces between words.
+void AppendComment(const std::string_view comment, std::string& target) {
+  auto word_end = comment.begin();
+  while (word_end != comment.end()) {
+    const auto word_start = std::find_if_not(word_end, comment.end(), IsSpace);
+    word_end = std::find_if(word_start, comment.end(), IsSpace);
+    if (word_start != word_end) {
+      if (!target.empty()) {
+        target += ' ';
+      }
+      target.append(word_start, word_end);
+    }
+  }
+}
+
+// Returns the position after the variation starting at the given '('.
+size_t SkipVariation(const std::string_view text, size_t position) noexcept {
+  size_t depth = 0;
+  while (position < text.size()) {
+    switch (text[position]) {
+      case '{':
+        position = std::min(text.find('}', position), text.size());
+        break;
+      case ';':
+        position = std::min(text.find('\n', position), text.size());
+        break;
+      case '(':
+        depth += 1;
+        break;
+      case ')':
+        depth -= 1;
+        if (depth == 0) {
+          return position + 1;
+        }
+        break;
+      default:
+        break;
+    }
+    position += 1;
+  }
+  return position;
+}
+}  // namespace
+
+LazyPgnGame::LazyPgnGame(TagPairs tags, const std::string_view movetext, const size_t offset)
+    : tags_(std::move(tags)), movetext_(movetext), offset_(offset) {}
+
+const TagPairs& LazyPgnGame::Tags() const noexcept { return tags_; }
+
+std::string_view LazyPgnGame::GetTag(const std::string_view name) const noexcept { return tags_.Get(name); }
+
+std::string_view LazyPgnGame::Movetext() const noexcept { return movetext_; }
+
+size_t LazyPgnGame::Offset() const noexcept { return offset_; }
+
+bool LazyPgnGame::IsMovetextParsed() const noexcept { return parsed_; }
+
+std::span<const std::string> LazyPgnGame::SanMoves() {
+  ParseMovetext();
+  return san_moves_;
+}
+
+std::span<const std::string> LazyPgnGame::Comments() {
+  ParseMovetext();
+  return comments_;
+}
+
+const MoveAnnotations& LazyPgnGame::Annotations() {
+  ParseMovetext();
+  if (annotations_decoded_) {
+    return annotations_;
+  }
+  annotations_decoded_ = true;
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    const auto [type, value] = annotation_commands_.at(i);
+    std::vector<int32_t>& values = type == AnnotationType::kClock     ? annotations_.clock_ms
+                                   : type == AnnotationType::kElapsed ? annotations_.elapsed_ms
+                                                                      : annotations_.evaluation;
+    values.resize(san_moves_.size(), kNoAnnotation);
+    values.at(commands_.at(i).move) = value;
+  }
+  return annotations_;
+}
+
+std::span<const PgnCommand> LazyPgnGame::Commands() {
+  ParseMovetext();
+  return commands_;
+}
+
+std::string_view LazyPgnGame::InitialComment() {
+  ParseMovetext();
+  return initial_comment_;
+}
+
+std::string_view LazyPgnGame::Termination() {
+  ParseMovetext();
+  return termination_;
+}
+
+PgnGameView LazyPgnGame::View() {
+  ParseMovetext();
+  return {&tags_, san_moves_, comments_, first_move_number_, first_to_move_, nullptr, commands_};
+}
+
+void LazyPgnGame::ParseMovetext() {
+  if (parsed_) {
+    return;
+  }
+  parsed_ = true;
+  const std::string_view text = movetext_;
+  size_t position = 0;
+  while (position < text.size()) {
+    const char c = text[position];
+    if (IsSpace(c) || c == ')') {
+      position += 1;
+    } else if (c == '{' || c == ';') {
+      const size_t end = std::min(text.find(c == '{' ? '}' : '\n', position), text.size());
+      AddComment(text.substr(position + 1, end - position - 1));
+      position = end + 1;
+    } else if (c == '(') {
+      position = SkipVariation(text, position);
+    } else if (c == '$') {
+      position = static_cast<size_t>(std::find_if_not(text.begin() + static_cast<std::ptrdiff_t>(position) + 1,
+                                                      text.end(), IsDigit) -
+                                     text.begin());
+    } else if (const size_t length = TerminationLength(text.substr(position)); length > 0) {
+      termination_ = text.substr(position, length);
+      return;
+    } else {
+      const size_t end = std::min(text.find_first_of(kTokenDelimiters, position), text.size());
+      std::string_view token = text.substr(position, end - position);
+      token = token.substr(0, static_cast<size_t>(std::ranges::find_if(token, IsSpace) - token.begin()));
+      position += token.size();
+
+      // A move number may be glued to its move, as in "1.e4". Digits not followed by a dot are castling written
+      // with zeros.
+      const size_t digits = static_cast<size_t>(std::ranges::find_if_not(token, IsDigit) - token.begin());
+      const size_t dots = token.find_first_not_of('.', digits) == std::string_view::npos
+                              ? token.size() - digits
+                              : token.find_first_not_of('.', digits) - digits;
+      if (dots > 0) {
+        // A number too large for an int fails to parse and the numbering stays at its default.
+        int number = 0;
+        if (san_moves_.empty() && digits > 0 &&
+            std::from_chars(token.data(), token.data() + digits, number).ec == std::errc{}) {
+          first_move_number_ = number;
+          first_to_move_ = dots >= 3 ? Color::kBlack : Color::kWhite;
+        }
+        token.remove_prefix(digits + dots);
+      }
+      while (!token.empty() && (token.back() == '!' || token.back() == '?')) {
+        token.remove_suffix(1);
+      }
+      if (!token.empty()) {
+        san_moves_.emplace_back(token);
+        comments_.emplace_back();
+      }
+    }
+  }
+}
+
+// Clock and evaluation commands with a valid value are kept apart from the comment text, everything else stays in the
+// comment.
+void LazyPgnGame::AddComment(std::string_view comment) {
+  if (comments_.empty()) {
+    AppendComment(comment, initial_comment_);
+    return;
+  }
+  std::string& target = comments_.back();
+  size_t search_from = 0;
+  for (size_t start = comment.find("[%"); start != std::string_view::npos; start = comment.find("[%", search_from)) {
+    const size_t end = comment.find(']', start);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    search_from = end + 1;
+    const std::string_view command = comment.substr(start + 2, end - start - 2);
+    const size_t name_end = std::min(command.find(' '), command.size());
+    const auto type = std::ranges::find(kAnnotationNames, command.substr(0, name_end));
+    if (type == kAnnotationNames.end()) {
+      continue;
+    }
+    std::string_view value = command.substr(name_end);
+    value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+    value = value.substr(0, value.find(' '));
+    const auto annotation_type = static_cast<AnnotationType>(type - kAnnotationNames.begin());
+    const std::optional<int32_t> decoded =
+        annotation_type == AnnotationType::kEvaluation ? ParseEvaluation(value) : ParseClock(value);
+    if (!decoded.has_value()) {
+      continue;
+    }
+    commands_.push_back({comments_.size() - 1, comment.substr(start, end + 1 - start)});
+    annotation_commands_.push_back({annotation_type, *decoded});
+    AppendComment(comment.substr(0, start), target);
+    comment.remove_prefix(end + 1);
+    search_from = 0;
+  }
+  AppendComment(comment, target);
+}
+
+PgnScanner::PgnScanner(const std::string_view pgn, std::pmr::memory_resource* memory_resource)
+    : pgn_(pgn), memory_resource_(memory_resource) {}
+
+std::optional<LazyPgnGame> PgnScanner::Next() {
+  SkipWhitespace();
+  if (position_ >= pgn_.size()) {
+    return std::nullopt;
+  }
+  const size_t offset = position_;
+  TagPairs tags = ScanTags();
+  const size_t movetext_start = position_;
+  std::string_view movetext = pgn_.substr(movetext_start, ScanMovetext() - movetext_start);
+  while (!movetext.empty() && IsSpace(movetext.back())) {
+    movetext.remove_suffix(1);
+  }
+  return LazyPgnGame(std::move(tags), movetext, offset);
+}
+
+// Lines starting with '%' are escaped and skipped along with the whitespace.
+void PgnScanner::SkipWhitespace() noexcept {
+  while (position_ < pgn_.size()) {
+    if (pgn_[position_] == '%' && (position_ == 0 || pgn_[position_ - 1] == '\n')) {
+      position_ = std::min(pgn_.find('\n', position_), pgn_.size());
+    } else if (IsSpace(pgn_[position_])) {
+      position_ += 1;
+    } else {
+      return;
+    }
+  }
+}
+
+TagPairs PgnScanner::ScanTags() {
+  TagPairs tags(memory_resource_);
+  std::string value;
+  while (position_ < pgn_.size() && pgn_[position_] == '[') {
+    position_ += 1;
+    SkipWhitespace();
+    const size_t name_end = std::min(pgn_.find_first_of(" \t\r\n\"]", position_), pgn_.size());
+    const std::string_view name = pgn_.substr(position_, name_end - position_);
+    position_ = name_end;
+    SkipWhitespace();
+    if (name.empty() || position_ >= pgn_.size() || pgn_[position_] != '"') {
+      throw std::invalid_argument("Malformed PGN tag.");
+    }
+    position_ += 1;
+    value.clear();
+    while (position_ < pgn_.size() && pgn_[position_] != '"') {
+      if (pgn_[position_] == '\\' && position_ + 1 < pgn_.size()) {
+        position_ += 1;
+      }
+      value += pgn_[position_];
+      position_ += 1;
+    }
+    position_ += 1;
+    SkipWhitespace();
+    if (position_ >= pgn_.size() || pgn_[position_] != ']') {
+      throw std::invalid_argument("Malformed PGN tag.");
+    }
+    position_ += 1;
+    tags.Set(name, value);
+    SkipWhitespace();
+  }
+  return tags;
+}
+
+// Finds the end of the movetext without tokenizing it, only comments and variations need to be tracked.
+size_t PgnScanner::ScanMovetext() {
+  size_t depth = 0;
+  while (position_ < pgn_.size()) {
+    switch (pgn_[position_]) {
+      case '{':
+        position_ = pgn_.find('}', position_);
+        if (position_ == std::string_view::npos) {
+          throw std::invalid_argument("Unterminated PGN comment.");
+        }
+        break;
+      case ';':
+        position_ = std::min(pgn_.find('\n', position_), pgn_.size() - 1);
+        break;
+      case '(':
+        depth += 1;
+        break;
+      case ')':
+        depth -= depth > 0 ? 1 : 0;
+        break;
+      case '[':
+        // A game without a termination marker ends at the next tag section.
+        if (depth == 0 && (position_ == 0 || pgn_[position_ - 1] == '\n')) {
+          return position_;
+        }
+        break;
+      default:
+        if (depth == 0 && IsTokenStart(pgn_, position_)) {
+          if (const size_t length = TerminationLength(pgn_.substr(position_)); length > 0) {
+            position_ += length;
+            return position_;
+          }
+        }
+        break;
+    }
+    position_ += 1;
+  }
+  return position_;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,290 @@
+#include "pgnwriter.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "color.h"
+#include "game.h"
+#include "pgnannotations.h"
+
+namespace bomchess {
+namespace {
+// Enough to keep the writer busy without holding much of a large export in memory.
+constexpr size_t kGamesPerChunk = 256;
+constexpr size_t kChunksPerThread = 4;
+
+void AppendTag(const std::string_view name, const std::string_view value, std::string& buffer) {
+  buffer += '[';
+  buffer += name;
+  buffer += " \"";
+  for (const char character : value) {
+    if (character == '\\' || character == '"') {
+      buffer += '\\';
+    }
+    buffer += character;
+  }
+  buffer += "\"]\n";
+}
+
+std::string_view MissingTagValue(const std::string_view name) {
+  if (name == tags::kDate) {
+    return "????.??.??";
+  }
+  if (name == tags::kResult) {
+    return "*";
+  }
+  return "?";
+}
+
+/**
+ * Appends space separated tokens, starting a new line whenever the next token would make the line too long.
+ */
+class MovetextWriter {
+ public:
+  explicit MovetextWriter(std::string& buffer) : buffer_(buffer) {}
+
+  void Add(const std::string_view token) {
+    if (line_length_ > 0) {
+      if (line_length_ + 1 + token.size() > kPgnLineLength) {
+        buffer_ += '\n';
+        line_length_ = 0;
+      } else {
+        buffer_ += ' ';
+        line_length_ += 1;
+      }
+    }
+    buffer_ += token;
+    line_length_ += token.size();
+  }
+
+  // "12." before a white move, "12..." before a black move.
+  void AddMoveNumber(const int move_number, const Color to_move) {
+    std::array<char, 16> token{};
+    char* end = std::to_chars(token.data(), token.data() + token.size(), move_number).ptr;
+    end = std::ranges::copy(to_move == Color::kWhite ? std::string_view(".") : std::string_view("..."), end).out;
+    Add(std::string_view(token.data(), end));
+  }
+
+  // Comments are split on spaces so they wrap like the rest of the movetext.
+  void AddComment(const std::string_view comment) {
+    std::string token = "{";
+    size_t start = comment.find_first_not_of(' ');
+    while (start != std::string_view::npos) {
+      const size_t end = std::min(comment.find(' ', start), comment.size());
+      token += comment.substr(start, end - start);
+      start = comment.find_first_not_of(' ', end);
+      if (start == std::string_view::npos) {
+        token += '}';
+      }
+      Add(token);
+      token.clear();
+    }
+  }
+
+ private:
+  std::string& buffer_;
+  size_t line_length_ = 0;
+};
+
+bool IsBlank(const std::string_view comment) { return comment.find_first_not_of(' ') == std::string_view::npos; }
+
+bool MatchesMoveCount(const std::vector<int32_t>& annotations, const size_t move_count) {
+  return annotations.empty() || annotations.size() == move_count;
+}
+}  // namespace
+
+void AppendPGN(const PgnGameView& game, std::string& buffer) {
+  if (game.tags == nullptr) {
+    throw std::invalid_argument("Game has no tags.");
+  }
+  if (!game.comments.empty() && game.comments.size() != game.san_moves.size()) {
+    throw std::invalid_argument("Comment count doesn't match move count.");
+  }
+  if (game.annotations != nullptr && (!MatchesMoveCount(game.annotations->clock_ms, game.san_moves.size()) ||
+                                     !MatchesMoveCount(game.annotations->elapsed_ms, game.san_moves.size()) ||
+                                     !MatchesMoveCount(game.annotations->evaluation, game.san_moves.size()))) {
+    throw std::invalid_argument("Annotation count doesn't match move count.");
+  }
+  if (!std::ranges::is_sorted(game.commands, {}, &PgnCommand::move) ||
+      (!game.commands.empty() && game.commands.back().move >= game.san_moves.size())) {
+    throw std::invalid_argument("Commands are out of order.");
+  }
+  if (std::ranges::any_of(game.comments, [](const std::string& comment) { return comment.contains('}'); }) ||
+      std::ranges::any_of(game.commands, [](const PgnCommand& command) { return command.text.contains('}'); })) {
+    throw std::invalid_argument("Comment contains '}'.");
+  }
+  if ((game.first_to_move != Color::kWhite && game.first_to_move != Color::kBlack) || game.first_move_number < 1) {
+    throw std::invalid_argument("Invalid first move.");
+  }
+
+  for (const std::string_view name : tags::kSevenTagRoster) {
+    const std::string_view value = game.tags->Get(name);
+    AppendTag(name, value.empty() ? MissingTagValue(name) : value, buffer);
+  }
+  for (const TagPair& tag : game.tags->SupplementalTags()) {
+    AppendTag(tag.name, tag.value, buffer);
+  }
+  buffer += '\n';
+
+  MovetextWriter movetext(buffer);
+  int move_number = game.first_move_number;
+  Color to_move = game.first_to_move;
+  // Black's move only needs its number at the start of the game or after a comment.
+  bool number_black_move = true;
+  std::string comment;
+  auto command = game.commands.begin();
+  for (size_t i = 0; i < game.san_moves.size(); ++i) {
+    if (to_move == Color::kWhite || number_black_move) {
+      movetext.AddMoveNumber(move_number, to_move);
+    }
+    movetext.Add(game.san_moves[i]);
+    comment.clear();
+    if (game.annotations != nullptr) {
+      AppendAnnotations(*game.annotations, i, comment);
+    }
+    for (; command != game.commands.end() && command->move == i; ++command) {
+      comment += comment.empty() ? "" : " ";
+      comment += command->text;
+    }
+    if (!game.comments.empty() && !IsBlank(game.comments[i])) {
+      comment += comment.empty() ? "" : " ";
+      comment += game.comments[i];
+    }
+    number_black_move = !comment.empty();
+    if (number_black_move) {
+      movetext.AddComment(comment);
+    }
+    if (to_move == Color::kBlack) {
+      move_number += 1;
+      to_move = Color::kWhite;
+    } else {
+      to_move = Color::kBlack;
+    }
+  }
+  const std::string_view result = game.tags->Get(tags::kResult);
+  movetext.Add(result.empty() ? MissingTagValue(tags::kResult) : result);
+  buffer += "\n\n";
+}
+
+PgnWriter::PgnWriter(const std::filesystem::path& path, const unsigned thread_count)
+    : thread_count_(std::max(thread_count, 1U)) {
+#ifdef _WIN32
+  file_descriptor_ = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  file_descriptor_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+  if (file_descriptor_ == -1) {
+    throw std::runtime_error("Could not open PGN file.");
+  }
+}
+
+PgnWriter::~PgnWriter() {
+#ifdef _WIN32
+  _close(file_descriptor_);
+#else
+  close(file_descriptor_);
+#endif
+}
+
+void PgnWriter::Write(const std::span<const PgnGameView> games) {
+  const size_t chunk_count = (games.size() + kGamesPerChunk - 1) / kGamesPerChunk;
+  const size_t max_pending_chunks = kChunksPerThread * thread_count_;
+  std::vector<std::string> buffers(chunk_count);
+  std::vector<std::exception_ptr> errors(chunk_count);
+  std::vector<std::atomic<bool>> formatted(chunk_count);
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<size_t> written_chunks = 0;
+  std::atomic<bool> stopped = false;
+
+  const auto format_chunks = [&] {
+    for (size_t chunk = next_chunk.fetch_add(1); chunk < chunk_count; chunk = next_chunk.fetch_add(1)) {
+      for (size_t written = written_chunks.load(); chunk >= written + max_pending_chunks && !stopped.load();
+           written = written_chunks.load()) {
+        written_chunks.wait(written);
+      }
+      if (stopped.load()) {
+        return;
+      }
+      try {
+        for (const PgnGameView& game : games.subspan(chunk * kGamesPerChunk).first(
+                 std::min(kGamesPerChunk, games.size() - chunk * kGamesPerChunk))) {
+          AppendPGN(game, buffers[chunk]);
+        }
+      } catch (...) {
+        errors[chunk] = std::current_exception();
+      }
+      formatted[chunk].store(true, std::memory_order_release);
+      formatted[chunk].notify_one();
+    }
+  };
+
+  std::exception_ptr error;
+  {
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < std::min<size_t>(thread_count_, chunk_count); ++i) {
+      threads.emplace_back(format_chunks);
+    }
+    for (size_t chunk = 0; chunk < chunk_count && !error; ++chunk) {
+      formatted[chunk].wait(false, std::memory_order_acquire);
+      error = errors[chunk];
+      if (!error) {
+        try {
+          WriteBuffer(buffers[chunk]);
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      std::string().swap(buffers[chunk]);
+      if (error) {
+        stopped.store(true);
+      }
+      written_chunks.store(chunk + 1);
+      written_chunks.notify_all();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void PgnWriter::WriteBuffer(std::string_view buffer) const {
+  while (!buffer.empty()) {
+#ifdef _WIN32
+    const int written = _write(file_descriptor_, buffer.data(),
+                               static_cast<unsigned>(std::min<size_t>(buffer.size(), 1U << 30)));
+#else
+    const ssize_t written = write(file_descriptor_, buffer.data(), buffer.size());
+    if (written == -1 && errno == EINTR) {
+      continue;
+    }
+#endif
+    if (written <= 0) {
+      throw std::runtime_error("Could not write to PGN file.");
+    }
+    buffer.remove_prefix(static_cast<size_t>(written));
+  }
+}
+
+}  // namespace bomchess
@@ -0,0 +1,204 @@
+#include "positionbatch.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "color.h"
+#include "hash.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+// Loops over whole columns index with [] rather than at(). Every column has Size() rows, and bounds checks would keep
+// the compiler from vectorizing them.
+
+namespace bomchess {
+namespace {
+constexpr size_t kPieceTypeCount = 6;
+
+constexpr std::array<uint64_t, 12> kColumnKeys = [] {
+  std::array<uint64_t, 12> keys{};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys.at(i) = Mix64(i + 1) | 1;
+  }
+  return keys;
+}();
+
+size_t ColumnIndex(const Piece piece) {
+  if (std::to_underlying(piece.type) < 0 || piece.type >= PieceType::kNone) {
+    throw std::invalid_argument("Invalid piece type.");
+  }
+  return ColorIndex(piece.color) * kPieceTypeCount + std::to_underlying(piece.type);
+}
+}  // namespace
+
+PositionBatch::PositionBatch(const std::span<const Position> positions) {
+  Reserve(positions.size());
+  for (const Position& position : positions) {
+    Add(position);
+  }
+}
+
+void PositionBatch::Add(const Position& position) {
+  const PositionBitboards bitboards = MakeBitboards(position);
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    columns_.at(column).push_back(bitboards.piece_types.at(column % kPieceTypeCount) &
+                                  bitboards.colors.at(column / kPieceTypeCount));
+  }
+}
+
+Position PositionBatch::Get(const size_t index) const {
+  if (index >= Size()) {
+    throw std::out_of_range("Position index out of range.");
+  }
+  Position position;
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    const Piece piece{static_cast<Color>(column / kPieceTypeCount), static_cast<PieceType>(column % kPieceTypeCount)};
+    for (Bitboard bitboard = columns_.at(column).at(index); bitboard != kEmptyBitboard; bitboard &= bitboard - 1) {
+      position.at(LowestSquare(bitboard)) = piece;
+    }
+  }
+  return position;
+}
+
+size_t PositionBatch::Size() const noexcept { return columns_.front().size(); }
+
+void PositionBatch::Reserve(const size_t size) {
+  for (std::vector<Bitboard>& column : columns_) {
+    column.reserve(size);
+  }
+}
+
+void PositionBatch::Clear() noexcept {
+  for (std::vector<Bitboard>& column : columns_) {
+    column.clear();
+  }
+}
+
+std::span<const Bitboard> PositionBatch::Column(const Piece piece) const { return columns_.at(ColumnIndex(piece)); }
+
+std::vector<uint8_t> PositionBatch::PieceCounts(const Piece piece) const {
+  const std::vector<Bitboard>& column = columns_.at(ColumnIndex(piece));
+  std::vector<uint8_t> counts(column.size());
+  for (size_t i = 0; i < column.size(); ++i) {
+    counts[i] = static_cast<uint8_t>(std::popcount(column[i]));
+  }
+  return counts;
+}
+
+std::vector<int> PositionBatch::MaterialBalance() const {
+  std::vector<int> balance(Size());
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    const int sign = column < kPieceTypeCount ? 1 : -1;
+    const int value = PieceValue(static_cast<PieceType>(column % kPieceTypeCount)) * sign;
+    if (value == 0) {
+      continue;
+    }
+    const std::vector<Bitboard>& bitboards = columns_.at(column);
+    for (size_t i = 0; i < bitboards.size(); ++i) {
+      balance[i] += std::popcount(bitboards[i]) * value;
+    }
+  }
+  return balance;
+}
+
+void PositionBatch::PieceSquareFeatures(std::vector<uint16_t>& features, std::vector<uint32_t>& offsets) const {
+  offsets.reserve(offsets.size() + Size() + 1);
+  offsets.push_back(static_cast<uint32_t>(features.size()));
+  for (size_t i = 0; i < Size(); ++i) {
+    for (size_t column = 0; column < columns_.size(); ++column) {
+      for (Bitboard bitboard = columns_.at(column)[i]; bitboard != kEmptyBitboard; bitboard &= bitboard - 1) {
+        features.push_back(static_cast<uint16_t>(column * 64 + std::countr_zero(bitboard)));
+      }
+    }
+    offsets.push_back(static_cast<uint32_t>(features.size()));
+  }
+}
+
+std::vector<uint8_t> PositionBatch::KingInCheck(const Color color) const {
+  const size_t us = ColorIndex(color);
+  const size_t them = 1 - us;
+  const auto column = [&](const size_t color_index, const PieceType piece_type) -> const std::vector<Bitboard>& {
+    return columns_.at(color_index * kPieceTypeCount + std::to_underlying(piece_type));
+  };
+  const std::vector<Bitboard>& kings = column(us, PieceType::kKing);
+  const std::vector<Bitboard>& pawns = column(them, PieceType::kPawn);
+  const std::vector<Bitboard>& knights = column(them, PieceType::kKnight);
+  const std::vector<Bitboard>& enemy_kings = column(them, PieceType::kKing);
+  const std::vector<Bitboard>& bishops = column(them, PieceType::kBishop);
+  const std::vector<Bitboard>& rooks = column(them, PieceType::kRook);
+  const std::vector<Bitboard>& queens = column(them, PieceType::kQueen);
+  const auto attacker = static_cast<Color>(them);
+
+  // Leapers first, branch free over the whole batch.
+  std::vector<uint8_t> in_check(Size());
+  for (size_t i = 0; i < in_check.size(); ++i) {
+    const Bitboard king = kings[i];
+    in_check[i] = ((PawnAttackerSquares(king, attacker) & pawns[i]) | (KnightSpread(king) & knights[i]) |
+                   (KingSpread(king) & enemy_kings[i])) != kEmptyBitboard;
+  }
+  // Sliders need the occupancy, and only positions with a slider on one of the king's lines are worth a look.
+  for (size_t i = 0; i < in_check.size(); ++i) {
+    const Bitboard diagonal = bishops[i] | queens[i];
+    const Bitboard straight = rooks[i] | queens[i];
+    if (in_check[i] != 0 || (diagonal | straight) == kEmptyBitboard) {
+      continue;
+    }
+    Bitboard occupied = kEmptyBitboard;
+    for (const std::vector<Bitboard>& pieces : columns_) {
+      occupied |= pieces[i];
+    }
+    for (Bitboard king = kings[i]; king != kEmptyBitboard; king &= king - 1) {
+      const Square square = LowestSquare(king);
+      if ((BishopAttacks(square, occupied) & diagonal) != kEmptyBitboard ||
+          (RookAttacks(square, occupied) & straight) != kEmptyBitboard) {
+        in_check[i] = 1;
+        break;
+      }
+    }
+  }
+  return in_check;
+}
+
+std::vector<uint64_t> PositionBatch::Hashes() const {
+  std::vector<uint64_t> hashes(Size());
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    const std::vector<Bitboard>& bitboards = columns_.at(column);
+    const uint64_t key = kColumnKeys.at(column);
+    for (size_t i = 0; i < bitboards.size(); ++i) {
+      hashes[i] = std::rotl(hashes[i] ^ bitboards[i] * key, 29);
+    }
+  }
+  for (uint64_t& hash : hashes) {
+    hash = Mix64(hash);
+  }
+  return hashes;
+}
+
+std::vector<uint8_t> PositionBatch::Equal(const PositionBatch& other) const {
+  if (other.Size() != Size()) {
+    throw std::invalid_argument("Position batches differ in size.");
+  }
+  std::vector<Bitboard> differences(Size());
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    const std::vector<Bitboard>& ours = columns_.at(column);
+    const std::vector<Bitboard>& theirs = other.columns_.at(column);
+    for (size_t i = 0; i < differences.size(); ++i) {
+      differences[i] |= ours[i] ^ theirs[i];
+    }
+  }
+  std::vector<uint8_t> equal(Size());
+  for (size_t i = 0; i < equal.size(); ++i) {
+    equal[i] = differences[i] == kEmptyBitboard;
+  }
+  return equal;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,243 @@
+#include "route.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+using DistanceTable = std::array<std::array<int8_t, 64>, 64>;
+
+// Files and ranks count from 0, rank 0 being the first rank.
+constexpr int FileOf(const int square) { return square % 8; }
+constexpr int RankOf(const int square) { return 7 - square / 8; }
+constexpr int Absolute(const int value) { return value < 0 ? -value : value; }
+
+constexpr int8_t PawnDistance(const int from, const int to, const int direction, const int start_rank) {
+  const int rank_difference = (RankOf(to) - RankOf(from)) * direction;
+  if (FileOf(from) != FileOf(to) || rank_difference < 0) {
+    return kUnreachable;
+  }
+  // The double push saves a move on the way to anything two or more squares past the starting rank.
+  const bool double_push =
+      (start_rank - RankOf(from)) * direction >= 0 && (RankOf(to) - start_rank) * direction >= 2;
+  return static_cast<int8_t>(rank_difference - (double_push ? 1 : 0));
+}
+
+constexpr int8_t SliderDistance(const int from, const int to, const bool straight, const bool diagonal) {
+  const int file_difference = Absolute(FileOf(to) - FileOf(from));
+  const int rank_difference = Absolute(RankOf(to) - RankOf(from));
+  if (from == to) {
+    return 0;
+  }
+  if ((straight && (file_difference == 0 || rank_difference == 0)) ||
+      (diagonal && file_difference == rank_difference)) {
+    return 1;
+  }
+  // A bishop never leaves its square color.
+  if (!straight && (file_difference + rank_difference) % 2 != 0) {
+    return kUnreachable;
+  }
+  return 2;
+}
+
+constexpr DistanceTable MakeKnightTable() {
+  constexpr std::array<std::pair<int, int>, 8> kSteps{
+      {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}};
+  DistanceTable table{};
+  for (int from = 0; from < 64; ++from) {
+    std::array<int8_t, 64>& distances = table.at(from);
+    distances.fill(kUnreachable);
+    distances.at(from) = 0;
+    std::array<int, 64> queue{from};
+    for (size_t head = 0, tail = 1; head < tail; ++head) {
+      const int square = queue.at(head);
+      for (const auto& [file_step, rank_step] : kSteps) {
+        const int file = FileOf(square) + file_step;
+        const int rank = RankOf(square) + rank_step;
+        if (file < 0 || file > 7 || rank < 0 || rank > 7 || distances.at((7 - rank) * 8 + file) != kUnreachable) {
+          continue;
+        }
+        distances.at((7 - rank) * 8 + file) = static_cast<int8_t>(distances.at(square) + 1);
+        queue.at(tail++) = (7 - rank) * 8 + file;
+      }
+    }
+  }
+  return table;
+}
+
+// Tables 0 and 1 are white and black pawns, the rest follow PieceType, one table further along.
+constexpr std::array<DistanceTable, 7> MakeDistanceTables() {
+  std::array<DistanceTable, 7> tables{};
+  tables.at(1 + std::to_underlying(PieceType::kKnight)) = MakeKnightTable();
+  for (int from = 0; from < 64; ++from) {
+    for (int to = 0; to < 64; ++to) {
+      tables.at(0).at(from).at(to) = PawnDistance(from, to, 1, 1);
+      tables.at(1).at(from).at(to) = PawnDistance(from, to, -1, 6);
+      tables.at(1 + std::to_underlying(PieceType::kRook)).at(from).at(to) = SliderDistance(from, to, true, false);
+      tables.at(1 + std::to_underlying(PieceType::kBishop)).at(from).at(to) = SliderDistance(from, to, false, true);
+      tables.at(1 + std::to_underlying(PieceType::kQueen)).at(from).at(to) = SliderDistance(from, to, true, true);
+      tables.at(1 + std::to_underlying(PieceType::kKing)).at(from).at(to) = static_cast<int8_t>(
+          std::max(Absolute(FileOf(to) - FileOf(from)), Absolute(RankOf(to) - RankOf(from))));
+    }
+  }
+  return tables;
+}
+
+constexpr std::array<DistanceTable, 7> kDistanceTables = MakeDistanceTables();
+
+size_t TableIndex(const Piece piece) {
+  if ((piece.color != Color::kWhite && piece.color != Color::kBlack) ||
+      std::to_underlying(piece.type) >= std::to_underlying(PieceType::kNone)) {
+    throw std::invalid_argument("Invalid piece.");
+  }
+  if (piece.type == PieceType::kPawn) {
+    return std::to_underlying(piece.color);
+  }
+  return 1 + std::to_underlying(piece.type);
+}
+
+/**
+ * The squares the piece can move to in one move, given what's blocking it and what it may capture.
+ */
+Bitboard Moves(const Piece piece, const Square square, const Bitboard occupied, const Bitboard capturable) {
+  switch (piece.type) {
+    case PieceType::kPawn: {
+      const int index = std::to_underlying(square);
+      const bool white = piece.color == Color::kWhite;
+      const int forward = white ? -8 : 8;
+      Bitboard moves = PawnAttacks(piece.color, square) & capturable;
+      if (index + forward < 0 || index + forward >= 64) {
+        return moves;
+      }
+      const Bitboard single_push = Bitboard{1} << (index + forward) & ~occupied;
+      moves |= single_push;
+      if (single_push != kEmptyBitboard && RankOf(index) == (white ? 1 : 6)) {
+        moves |= Bitboard{1} << (index + 2 * forward) & ~occupied;
+      }
+      return moves;
+    }
+    case PieceType::kRook:
+      return RookAttacks(square, occupied) & (~occupied | capturable);
+    case PieceType::kKnight:
+      return KnightAttacks(square) & (~occupied | capturable);
+    case PieceType::kBishop:
+      return BishopAttacks(square, occupied) & (~occupied | capturable);
+    case PieceType::kQueen:
+      return QueenAttacks(square, occupied) & (~occupied | capturable);
+    case PieceType::kKing:
+      return KingAttacks(square) & (~occupied | capturable);
+    default:
+      throw std::invalid_argument("Invalid piece.");
+  }
+}
+
+/**
+ * A breadth first search run on whole bitboards, one move count at a time.
+ */
+struct RouteSearch {
+  Piece piece;
+  Bitboard occupied;
+  Bitboard capturable;
+  // layers.at(n) holds the squares first reached in n moves.
+  std::vector<Bitboard> layers;
+};
+
+RouteSearch Search(const Position& position, const PositionBitboards& bitboards, const Square from) {
+  const Piece piece = position.at(from);
+  if (piece == pieces::kNone) {
+    throw std::invalid_argument("No piece on the from square.");
+  }
+  const Color opponent = piece.color == Color::kWhite ? Color::kBlack : Color::kWhite;
+  RouteSearch search{piece, bitboards.Occupied() & ~SquareBitboard(from), bitboards.Pieces(opponent), {}};
+  Bitboard reached = SquareBitboard(from);
+  for (Bitboard frontier = reached; frontier != kEmptyBitboard;) {
+    search.layers.push_back(frontier);
+    Bitboard next = kEmptyBitboard;
+    // A capture ends the route, so captured squares aren't searched from.
+    for (Bitboard squares = frontier & ~search.capturable; squares != kEmptyBitboard; squares &= squares - 1) {
+      next |= Moves(piece, LowestSquare(squares), search.occupied, search.capturable);
+    }
+    frontier = next & ~reached;
+    reached |= frontier;
+  }
+  return search;
+}
+
+std::array<int8_t, 64> Distances(const RouteSearch& search) {
+  std::array<int8_t, 64> distances{};
+  distances.fill(kUnreachable);
+  for (size_t distance = 0; distance < search.layers.size(); ++distance) {
+    for (Bitboard squares = search.layers.at(distance); squares != kEmptyBitboard; squares &= squares - 1) {
+      distances.at(std::countr_zero(squares)) = static_cast<int8_t>(distance);
+    }
+  }
+  return distances;
+}
+}  // namespace
+
+int8_t PieceDistance(const Piece piece, const Square from, const Square to) {
+  if (!IsValidSquare(from) || !IsValidSquare(to)) {
+    throw std::invalid_argument("Invalid squares.");
+  }
+  return kDistanceTables.at(TableIndex(piece)).at(std::to_underlying(from)).at(std::to_underlying(to));
+}
+
+PieceRoute FindRoute(const Position& position, const Square from, const Square to) {
+  const Bitboard target = SquareBitboard(to);
+  const RouteSearch search = Search(position, MakeBitboards(position), from);
+  PieceRoute route;
+  for (size_t distance = 0; distance < search.layers.size(); ++distance) {
+    if ((search.layers.at(distance) & target) != kEmptyBitboard) {
+      route.distance = static_cast<int8_t>(distance);
+      break;
+    }
+  }
+  if (route.distance == kUnreachable) {
+    return route;
+  }
+  // Walk back one layer at a time to any square that could have moved to the current one.
+  route.squares.resize(route.distance + 1);
+  route.squares.back() = to;
+  for (int distance = route.distance - 1; distance >= 0; --distance) {
+    const Bitboard next = SquareBitboard(route.squares.at(distance + 1));
+    for (Bitboard squares = search.layers.at(distance) & ~search.capturable; squares != kEmptyBitboard;
+         squares &= squares - 1) {
+      const Square square = LowestSquare(squares);
+      if ((Moves(search.piece, square, search.occupied, search.capturable) & next) != kEmptyBitboard) {
+        route.squares.at(distance) = square;
+        break;
+      }
+    }
+  }
+  return route;
+}
+
+std::array<int8_t, 64> RouteDistances(const Position& position, const Square from) {
+  return Distances(Search(position, MakeBitboards(position), from));
+}
+
+std::array<std::array<int8_t, 64>, 64> RouteDistances(const Position& position) {
+  const PositionBitboards bitboards = MakeBitboards(position);
+  std::array<std::array<int8_t, 64>, 64> distances{};
+  for (const Square square : kAllSquares) {
+    if (position.at(square) == pieces::kNone) {
+      distances.at(std::to_underlying(square)).fill(kUnreachable);
+    } else {
+      distances.at(std::to_underlying(square)) = Distances(Search(position, bitboards, square));
+    }
+  }
+  return distances;
+}
+
+}  // namespace bomchess
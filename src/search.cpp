@@ -0,0 +1,694 @@
+#include "search.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "hash.h"
+#include "move.h"
+#include "movegen.h"
+#include "movepicker.h"
+#include "nnue.h"
+#include "piece.h"
+#include "position.h"
+#include "see.h"
+#include "square.h"
+#include "transpositiontable.h"
+
+namespace bomchess {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Lines can run past the nominal depth through checks and captures in the quiescence search.
+constexpr int kMaxPly = 2 * kMaxSearchDepth;
+constexpr int kInfinity = kMateScore + 1;
+// Scores beyond this are mates.
+constexpr int kMateBound = kMateScore - kMaxPly;
+// Evaluations are kept clear of mate scores.
+constexpr int kMaxEvaluation = kMateBound - 1;
+constexpr int kAspirationWindow = 25;
+constexpr int kAspirationMinDepth = 5;
+// Nodes each thread counts before adding them to the shared count and checking the limits.
+constexpr uint64_t kNodesPerCheck = 1024;
+constexpr int kMaxQuietsTried = 64;
+
+// Zobrist keys: one per piece type, color and square, then the side to move, castling rights and en passant squares.
+constexpr size_t kPieceKeys = 2 * 6 * 64;
+constexpr size_t kBlackToMoveKey = kPieceKeys;
+constexpr size_t kCastlingKeys = kBlackToMoveKey + 1;
+constexpr size_t kEnPassantKeys = kCastlingKeys + 4;
+
+constexpr std::array<uint64_t, kEnPassantKeys + 64> MakeZobristKeys() {
+  std::array<uint64_t, kEnPassantKeys + 64> keys{};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys.at(i) = Mix64(0x9e3779b97f4a7c15 * (i + 1));
+  }
+  return keys;
+}
+
+constexpr std::array<uint64_t, kEnPassantKeys + 64> kZobristKeys = MakeZobristKeys();
+
+uint64_t PieceKey(const Piece piece, const Square square) {
+  return kZobristKeys.at((ColorIndex(piece.color) * 6 + std::to_underlying(piece.type)) * 64 +
+                        std::to_underlying(square));
+}
+
+// Everything but the pieces.
+uint64_t StateKey(const PositionState& state) {
+  uint64_t key = state.side_to_move == Color::kBlack ? kZobristKeys.at(kBlackToMoveKey) : 0;
+  for (size_t color = 0; color < state.castling.size(); ++color) {
+    if (state.castling.at(color).king_side) {
+      key ^= kZobristKeys.at(kCastlingKeys + 2 * color);
+    }
+    if (state.castling.at(color).queen_side) {
+      key ^= kZobristKeys.at(kCastlingKeys + 2 * color + 1);
+    }
+  }
+  if (state.en_passant != Square::kNone) {
+    key ^= kZobristKeys.at(kEnPassantKeys + std::to_underlying(state.en_passant));
+  }
+  return key;
+}
+
+uint64_t PositionKey(const PositionState& state) {
+  uint64_t key = StateKey(state);
+  for (const Square square : kAllSquares) {
+    if (const Piece piece = state.position.at(square); piece != pieces::kNone) {
+      key ^= PieceKey(piece, square);
+    }
+  }
+  return key;
+}
+
+// Late move reductions grow with the log of both the depth and the number of moves searched before.
+const std::array<std::array<int, 64>, kMaxSearchDepth + 1> kReductions = [] {
+  std::array<std::array<int, 64>, kMaxSearchDepth + 1> reductions{};
+  for (int depth = 1; depth <= kMaxSearchDepth; ++depth) {
+    for (int move_number = 1; move_number < 64; ++move_number) {
+      reductions.at(depth).at(move_number) =
+          static_cast<int>(0.75 + std::log(depth) * std::log(move_number) / 2.25);
+    }
+  }
+  return reductions;
+}();
+
+// Captures and queen promotions are searched by the quiescence search and ordered before quiet moves.
+bool IsTactical(const Position& position, const Move move) {
+  return move.promotion == PieceType::kQueen || IsCapture(position, move);
+}
+
+// Without pieces besides pawns, passing can be the best move, so null move pruning is unsafe.
+bool HasNonPawnMaterial(const Position& position, const Color color) {
+  return std::ranges::any_of(position, [color](const Piece piece) {
+    return piece.color == color && piece.type != PieceType::kPawn && piece.type != PieceType::kKing;
+  });
+}
+
+// Mate scores are stored relative to the position rather than the root, so they stay correct wherever the position is
+// reached.
+int16_t ToTableScore(const int score, const int ply) {
+  if (score >= kMateBound) {
+    return static_cast<int16_t>(score + ply);
+  }
+  if (score <= -kMateBound) {
+    return static_cast<int16_t>(score - ply);
+  }
+  return static_cast<int16_t>(score);
+}
+
+int FromTableScore(const int score, const int ply) {
+  if (score >= kMateBound) {
+    return score - ply;
+  }
+  if (score <= -kMateBound) {
+    return score + ply;
+  }
+  return score;
+}
+
+int64_t ElapsedMilliseconds(const Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+/**
+ * The pseudo legal moves of one node, generated the first time MovePicker asks for any of them.
+ */
+class NodeMoves {
+ public:
+  explicit NodeMoves(const PositionState& state) : state_(state) {}
+
+  void Captures(std::vector<Move>& moves) {
+    std::ranges::copy_if(All(), std::back_inserter(moves),
+                         [this](const Move move) { return IsTactical(state_.position, move); });
+  }
+
+  void Quiets(std::vector<Move>& moves) {
+    std::ranges::copy_if(All(), std::back_inserter(moves),
+                         [this](const Move move) { return !IsTactical(state_.position, move); });
+  }
+
+  bool IsPseudoLegal(const Move move) { return std::ranges::find(All(), move) != All().end(); }
+
+ private:
+  const std::vector<Move>& All() {
+    if (!generated_) {
+      const Color side = state_.side_to_move;
+      GeneratePawnMoves(state_.position, side, state_.en_passant, moves_);
+      GeneratePieceMoves(state_.position, side, moves_);
+      GenerateCastlingMoves(state_.position, side, state_.castling.at(ColorIndex(side)), moves_);
+      generated_ = true;
+    }
+    return moves_;
+  }
+
+  const PositionState& state_;
+  std::vector<Move> moves_;
+  bool generated_ = false;
+};
+}  // namespace
+
+/**
+ * One search thread. Each keeps its own copy of the line being searched (states, keys and accumulators per ply), its
+ * own killers and history, and shares only the transposition table, the stop flag and the node count.
+ */
+class Searcher::Worker {
+ public:
+  Worker(Searcher& searcher, const PositionState& root, const SearchLimits& limits, Clock::time_point start);
+
+  /**
+   * Iterative deepening from first_depth up to the depth limit, until the search is stopped.
+   * @param callbacks Reports each iteration if set, only the main thread has them.
+   */
+  void Run(int first_depth, const SearchCallbacks* callbacks);
+
+  /**
+   * Adds the nodes not counted yet to the shared count.
+   */
+  void FlushNodes() noexcept;
+
+  /**
+   * The last completed iteration, if any.
+   */
+  std::optional<SearchInfo> completed;
+
+ private:
+  int Search(int alpha, int beta, int depth, int ply);
+  int Quiescence(int alpha, int beta, int ply);
+
+  // Plays the move into the next ply, or returns false if it leaves the king in check.
+  bool PlayMove(int ply, Move move);
+  void PlayNullMove(int ply);
+  [[nodiscard]] int Evaluate(int ply) const;
+  [[nodiscard]] bool IsRepetition(int ply) const noexcept;
+  void UpdatePrincipalVariation(int ply, Move move);
+  void UpdateQuietHistory(int ply, int depth, Move best_move, std::span<const Move> quiets_tried);
+  // Counts a node, and returns true if the search has been stopped.
+  bool CountNode();
+  void CheckLimits();
+
+  Searcher& searcher_;
+  const SearchLimits& limits_;
+  Clock::time_point start_;
+  uint64_t unflushed_nodes_ = 0;
+  std::vector<PositionState> states_;
+  std::vector<NnueAccumulator> accumulators_;
+  std::vector<uint64_t> keys_;
+  std::vector<uint8_t> in_check_;
+  // Plies since the last capture or pawn move, before which no position can repeat.
+  std::vector<int> reversible_plies_;
+  std::vector<uint8_t> after_null_move_;
+  std::vector<std::array<Move, 2>> killers_;
+  std::vector<std::array<Move, kMaxPly + 1>> principal_variations_;
+  std::vector<int> principal_variation_lengths_;
+  HistoryTable history_;
+};
+
+Searcher::Worker::Worker(Searcher& searcher, const PositionState& root, const SearchLimits& limits,
+                         const Clock::time_point start)
+    : searcher_(searcher),
+      limits_(limits),
+      start_(start),
+      states_(kMaxPly + 1, root),
+      accumulators_(kMaxPly + 1, searcher.network_.MakeAccumulator(root.position)),
+      keys_(kMaxPly + 1, PositionKey(root)),
+      in_check_(kMaxPly + 1, IsInCheck(root.position, root.side_to_move)),
+      reversible_plies_(kMaxPly + 1, 0),
+      after_null_move_(kMaxPly + 1, false),
+      killers_(kMaxPly + 1, {kNullMove, kNullMove}),
+      principal_variations_(kMaxPly + 1),
+      principal_variation_lengths_(kMaxPly + 1, 0) {}
+
+void Searcher::Worker::Run(const int first_depth, const SearchCallbacks* callbacks) {
+  const int max_depth = limits_.depth.value_or(kMaxSearchDepth);
+  int score = 0;
+  for (int depth = first_depth; depth <= max_depth; ++depth) {
+    // Search a narrow window around the last score, widening it on the side that failed until the score fits.
+    int window = kAspirationWindow;
+    int alpha = depth >= kAspirationMinDepth ? std::max(score - window, -kInfinity) : -kInfinity;
+    int beta = depth >= kAspirationMinDepth ? std::min(score + window, kInfinity) : kInfinity;
+    while (true) {
+      score = Search(alpha, beta, depth, 0);
+      if (searcher_.stop_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      window *= 2;
+      if (score <= alpha) {
+        alpha = std::max(score - window, -kInfinity);
+      } else if (score >= beta) {
+        beta = std::min(score + window, kInfinity);
+      } else {
+        break;
+      }
+    }
+
+    // The flush can take the shared count past the node limit between two checks.
+    FlushNodes();
+    CheckLimits();
+    const auto line = principal_variations_.front().begin();
+    completed = SearchInfo{depth, score, searcher_.nodes_.load(std::memory_order_relaxed), ElapsedMilliseconds(start_),
+                           std::vector<Move>(line, line + principal_variation_lengths_.front())};
+    if (callbacks != nullptr && callbacks->iteration) {
+      callbacks->iteration(*completed);
+    }
+  }
+}
+
+void Searcher::Worker::FlushNodes() noexcept {
+  searcher_.nodes_.fetch_add(unflushed_nodes_, std::memory_order_relaxed);
+  unflushed_nodes_ = 0;
+}
+
+int Searcher::Worker::Search(int alpha, int beta, const int depth, const int ply) {
+  if (depth <= 0) {
+    return Quiescence(alpha, beta, ply);
+  }
+  principal_variation_lengths_.at(ply) = 0;
+  if (CountNode()) {
+    return 0;
+  }
+  const PositionState& state = states_.at(ply);
+  const bool pv_node = beta - alpha > 1;
+  // Killers two plies down are from a different part of the tree.
+  killers_.at(std::min(ply + 2, kMaxPly)) = {kNullMove, kNullMove};
+  if (ply > 0) {
+    if (IsRepetition(ply)) {
+      return 0;
+    }
+    if (ply >= kMaxPly) {
+      return Evaluate(ply);
+    }
+    // No line from here can beat a mate found closer to the root.
+    alpha = std::max(alpha, -kMateScore + ply);
+    beta = std::min(beta, kMateScore - ply - 1);
+    if (alpha >= beta) {
+      return alpha;
+    }
+  }
+
+  Move hash_move = kNullMove;
+  if (const std::optional<TranspositionEntry> entry = searcher_.table_.Probe(keys_.at(ply)); entry.has_value()) {
+    hash_move = entry->move;
+    const int score = FromTableScore(entry->score, ply);
+    if (!pv_node && entry->depth >= depth &&
+        (entry->bound == Bound::kExact || (entry->bound == Bound::kLower && score >= beta) ||
+         (entry->bound == Bound::kUpper && score <= alpha))) {
+      return score;
+    }
+  }
+
+  const bool in_check = in_check_.at(ply);
+  // If passing still fails high, a real move almost certainly would too.
+  if (!pv_node && !in_check && ply > 0 && depth >= 3 && !after_null_move_.at(ply) &&
+      HasNonPawnMaterial(state.position, state.side_to_move) && Evaluate(ply) >= beta) {
+    const int reduction = 3 + depth / 4;
+    PlayNullMove(ply);
+    const int score = -Search(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+    if (searcher_.stop_.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+    if (score >= beta) {
+      return score >= kMateBound ? beta : score;
+    }
+  }
+
+  NodeMoves node_moves(state);
+  const MovePickerGenerators generators{
+      [&node_moves](std::vector<Move>& moves) { node_moves.Captures(moves); },
+      [&node_moves](std::vector<Move>& moves) { node_moves.Quiets(moves); },
+      [&node_moves](const Move move) { return node_moves.IsPseudoLegal(move); }};
+  MovePicker picker(state.position, hash_move, killers_.at(ply), history_, generators);
+
+  const int original_alpha = alpha;
+  int best_score = -kInfinity;
+  Move best_move = kNullMove;
+  int legal_moves = 0;
+  std::array<Move, kMaxQuietsTried> quiets_tried{};
+  size_t quiets_tried_count = 0;
+  for (std::optional<Move> move = picker.Next(); move.has_value(); move = picker.Next()) {
+    const bool quiet = !IsTactical(state.position, *move);
+    if (!PlayMove(ply, *move)) {
+      continue;
+    }
+    legal_moves += 1;
+
+    int score = 0;
+    if (legal_moves == 1) {
+      score = -Search(-beta, -alpha, depth - 1, ply + 1);
+    } else {
+      // Later moves are searched with a null window to prove they are no better, and quiet ones at reduced depth.
+      int reduction = 0;
+      if (depth >= 3 && quiet && !in_check && !in_check_.at(ply + 1) && legal_moves > (pv_node ? 3 : 2)) {
+        reduction = kReductions.at(std::min(depth, kMaxSearchDepth)).at(std::min(legal_moves, 63)) - (pv_node ? 1 : 0);
+        reduction = std::clamp(reduction, 0, depth - 2);
+      }
+      score = -Search(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+      if (score > alpha && reduction > 0) {
+        score = -Search(-alpha - 1, -alpha, depth - 1, ply + 1);
+      }
+      if (score > alpha && score < beta) {
+        score = -Search(-beta, -alpha, depth - 1, ply + 1);
+      }
+    }
+    if (searcher_.stop_.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        best_move = *move;
+        alpha = score;
+        UpdatePrincipalVariation(ply, *move);
+        if (score >= beta) {
+          if (quiet) {
+            UpdateQuietHistory(ply, depth, *move, std::span(quiets_tried).first(quiets_tried_count));
+          }
+          break;
+        }
+      }
+    }
+    if (quiet && quiets_tried_count < quiets_tried.size()) {
+      quiets_tried.at(quiets_tried_count++) = *move;
+    }
+  }
+
+  if (legal_moves == 0) {
+    return in_check ? -kMateScore + ply : 0;
+  }
+  const Bound bound = best_score >= beta             ? Bound::kLower
+                      : best_score > original_alpha ? Bound::kExact
+                                                    : Bound::kUpper;
+  searcher_.table_.Store(keys_.at(ply), {best_move, ToTableScore(best_score, ply), static_cast<int8_t>(depth), bound});
+  return best_score;
+}
+
+// Searches captures until the position is quiet, so lines don't end in the middle of an exchange. In check every
+// move is searched, as standing pat isn't an option.
+int Searcher::Worker::Quiescence(int alpha, const int beta, const int ply) {
+  principal_variation_lengths_.at(ply) = 0;
+  if (CountNode()) {
+    return 0;
+  }
+  if (ply >= kMaxPly) {
+    return Evaluate(ply);
+  }
+  const PositionState& state = states_.at(ply);
+  const bool in_check = in_check_.at(ply);
+  int best_score = -kInfinity;
+  if (!in_check) {
+    best_score = Evaluate(ply);
+    if (best_score >= beta) {
+      return best_score;
+    }
+    alpha = std::max(alpha, best_score);
+  }
+
+  NodeMoves node_moves(state);
+  const MovePickerGenerators generators{
+      [&node_moves](std::vector<Move>& moves) { node_moves.Captures(moves); },
+      [&node_moves, in_check](std::vector<Move>& moves) {
+        if (in_check) {
+          node_moves.Quiets(moves);
+        }
+      },
+      [&node_moves](const Move move) { return node_moves.IsPseudoLegal(move); }};
+  MovePicker picker(state.position, kNullMove, {kNullMove, kNullMove}, history_, generators);
+  int legal_moves = 0;
+  for (std::optional<Move> move = picker.Next(); move.has_value(); move = picker.Next()) {
+    // Captures that lose material can't improve on standing pat.
+    if (!in_check && !SEEGreaterEqual(state.position, *move, 0)) {
+      continue;
+    }
+    if (!PlayMove(ply, *move)) {
+      continue;
+    }
+    legal_moves += 1;
+    const int score = -Quiescence(-beta, -alpha, ply + 1);
+    if (searcher_.stop_.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        alpha = score;
+        UpdatePrincipalVariation(ply, *move);
+        if (score >= beta) {
+          break;
+        }
+      }
+    }
+  }
+  if (in_check && legal_moves == 0) {
+    return -kMateScore + ply;
+  }
+  return best_score;
+}
+
+bool Searcher::Worker::PlayMove(const int ply, const Move move) {
+  const PositionState& state = states_.at(ply);
+  PositionState& next = states_.at(ply + 1);
+  next = state;
+  AdvanceState(next, move);
+  if (IsInCheck(next.position, state.side_to_move)) {
+    return false;
+  }
+
+  // Only the squares the move changed update the accumulator and key.
+  NnueAccumulator& accumulator = accumulators_.at(ply + 1);
+  accumulator = accumulators_.at(ply);
+  uint64_t key = keys_.at(ply) ^ StateKey(state) ^ StateKey(next);
+  for (const Square square : kAllSquares) {
+    const Piece before = state.position.at(square);
+    const Piece after = next.position.at(square);
+    if (before == after) {
+      continue;
+    }
+    if (before != pieces::kNone) {
+      searcher_.network_.RemovePiece(accumulator, before, square);
+      key ^= PieceKey(before, square);
+    }
+    if (after != pieces::kNone) {
+      searcher_.network_.AddPiece(accumulator, after, square);
+      key ^= PieceKey(after, square);
+    }
+  }
+  keys_.at(ply + 1) = key;
+  in_check_.at(ply + 1) = IsInCheck(next.position, next.side_to_move);
+  const bool irreversible =
+      IsCapture(state.position, move) || state.position.at(move.from_square).type == PieceType::kPawn;
+  reversible_plies_.at(ply + 1) = irreversible ? 0 : reversible_plies_.at(ply) + 1;
+  after_null_move_.at(ply + 1) = false;
+  return true;
+}
+
+void Searcher::Worker::PlayNullMove(const int ply) {
+  const PositionState& state = states_.at(ply);
+  PositionState& next = states_.at(ply + 1);
+  next = state;
+  next.side_to_move = state.side_to_move == Color::kWhite ? Color::kBlack : Color::kWhite;
+  next.en_passant = Square::kNone;
+  next.ply += 1;
+  accumulators_.at(ply + 1) = accumulators_.at(ply);
+  keys_.at(ply + 1) = keys_.at(ply) ^ StateKey(state) ^ StateKey(next);
+  in_check_.at(ply + 1) = false;
+  // Passing twice would repeat the position, which isn't a real repetition.
+  reversible_plies_.at(ply + 1) = 0;
+  after_null_move_.at(ply + 1) = true;
+}
+
+int Searcher::Worker::Evaluate(const int ply) const {
+  const int evaluation = searcher_.network_.Evaluate(accumulators_.at(ply), states_.at(ply).side_to_move);
+  return std::clamp(evaluation, -kMaxEvaluation, kMaxEvaluation);
+}
+
+bool Searcher::Worker::IsRepetition(const int ply) const noexcept {
+  for (int distance = 4; distance <= reversible_plies_[ply] && distance <= ply; distance += 2) {
+    if (keys_[ply - distance] == keys_[ply]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Searcher::Worker::UpdatePrincipalVariation(const int ply, const Move move) {
+  std::array<Move, kMaxPly + 1>& line = principal_variations_.at(ply);
+  const int child_length = principal_variation_lengths_.at(ply + 1);
+  line.front() = move;
+  std::copy_n(principal_variations_.at(ply + 1).begin(), child_length, line.begin() + 1);
+  principal_variation_lengths_.at(ply) = child_length + 1;
+}
+
+void Searcher::Worker::UpdateQuietHistory(const int ply, const int depth, const Move best_move,
+                                          const std::span<const Move> quiets_tried) {
+  std::array<Move, 2>& killers = killers_.at(ply);
+  if (killers.front() != best_move) {
+    killers.back() = killers.front();
+    killers.front() = best_move;
+  }
+  const Color side = states_.at(ply).side_to_move;
+  const int bonus = depth * depth;
+  history_.Update(side, best_move, bonus);
+  // The quiet moves tried first failed to cut off, so they were ordered too early.
+  for (const Move move : quiets_tried) {
+    history_.Update(side, move, -bonus);
+  }
+}
+
+bool Searcher::Worker::CountNode() {
+  unflushed_nodes_ += 1;
+  if (unflushed_nodes_ >= kNodesPerCheck) {
+    FlushNodes();
+    CheckLimits();
+  }
+  return searcher_.stop_.load(std::memory_order_relaxed);
+}
+
+void Searcher::Worker::CheckLimits() {
+  if (limits_.nodes.has_value() && searcher_.nodes_.load(std::memory_order_relaxed) >= *limits_.nodes) {
+    searcher_.RequestStop(SearchStopReason::kNodes);
+  } else if (limits_.move_time.has_value() && ElapsedMilliseconds(start_) >= *limits_.move_time) {
+    searcher_.RequestStop(SearchStopReason::kTime);
+  }
+}
+
+Searcher::Searcher(const NnueNetwork& network, TranspositionTable& table, const int thread_count)
+    : network_(network), table_(table), thread_count_(thread_count) {
+  if (thread_count < 1) {
+    throw std::invalid_argument("A search needs at least one thread.");
+  }
+}
+
+SearchResult Searcher::Search(const PositionState& state, const SearchLimits& limits,
+                              const SearchCallbacks& callbacks) {
+  if (limits.depth.has_value() && *limits.depth < 1) {
+    throw std::invalid_argument("Search depth must be at least 1.");
+  }
+  // Throws for an invalid side to move or a missing king before any thread starts.
+  std::ignore = IsInCheck(state.position, state.side_to_move);
+  std::ignore = IsInCheck(state.position, state.side_to_move == Color::kWhite ? Color::kBlack : Color::kWhite);
+  const Clock::time_point start = Clock::now();
+  SearchLimits clamped_limits = limits;
+  clamped_limits.depth = std::min(limits.depth.value_or(kMaxSearchDepth), kMaxSearchDepth);
+  // A stop from before the call is kept, so a search stopped right after being handed to another thread still stops.
+  nodes_.store(0);
+  Worker main_worker(*this, state, clamped_limits, start);
+
+  std::vector<std::unique_ptr<Worker>> helpers;
+  for (int i = 1; i < thread_count_; ++i) {
+    helpers.push_back(std::make_unique<Worker>(*this, state, clamped_limits, start));
+  }
+  std::vector<std::exception_ptr> helper_errors(helpers.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < helpers.size(); ++i) {
+    threads.emplace_back([this, &helpers, &helper_errors, i] {
+      try {
+        // Half the helpers start a depth ahead, so the threads spread over more depths.
+        helpers.at(i)->Run(1 + static_cast<int>(i % 2), nullptr);
+      } catch (...) {
+        helper_errors.at(i) = std::current_exception();
+        RequestStop(SearchStopReason::kStopped);
+      }
+      helpers.at(i)->FlushNodes();
+    });
+  }
+  std::exception_ptr main_error;
+  try {
+    main_worker.Run(1, &callbacks);
+  } catch (...) {
+    main_error = std::current_exception();
+  }
+  // The helpers only stop once the main thread does.
+  RequestStop(SearchStopReason::kDepth);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  main_worker.FlushNodes();
+  if (main_error) {
+    ClearStop();
+    std::rethrow_exception(main_error);
+  }
+  for (const std::exception_ptr& error : helper_errors) {
+    if (error) {
+      ClearStop();
+      std::rethrow_exception(error);
+    }
+  }
+
+  SearchResult result;
+  result.stop_reason = stop_reason_.load();
+  if (main_worker.completed.has_value()) {
+    result.info = std::move(*main_worker.completed);
+  } else {
+    // Stopped during the first iteration.
+    std::vector<Move> moves;
+    GenerateLegalMoves(state.position, state.side_to_move, state.en_passant,
+                       state.castling.at(ColorIndex(state.side_to_move)), moves);
+    if (!moves.empty()) {
+      result.info.principal_variation = {moves.front()};
+    }
+  }
+  result.info.nodes = nodes_.load();
+  result.info.time = ElapsedMilliseconds(start);
+  if (!result.info.principal_variation.empty()) {
+    result.best_move = result.info.principal_variation.front();
+  }
+  if (callbacks.stopped) {
+    callbacks.stopped(result.stop_reason, result.info);
+  }
+  // Only cleared after the stopped callback, so a caller that stops searches only until that callback has run never
+  // leaves a stop behind for the next search.
+  ClearStop();
+  return result;
+}
+
+void Searcher::Stop() noexcept { RequestStop(SearchStopReason::kStopped); }
+
+bool Searcher::RequestStop(const SearchStopReason reason) noexcept {
+  if (stop_.exchange(true)) {
+    return false;
+  }
+  stop_reason_.store(reason);
+  return true;
+}
+
+void Searcher::ClearStop() noexcept {
+  stop_reason_.store(SearchStopReason::kDepth);
+  stop_.store(false);
+}
+
+}  // namespace bomchess
@@ -0,0 +1,159 @@
+#include "see.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "bitboard.h"
+#include "color.h"
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+// Cheapest first, which is the order captures are played in.
+constexpr std::array<PieceType, 6> kCaptureOrder{PieceType::kPawn, PieceType::kKnight, PieceType::kBishop,
+                                                 PieceType::kRook, PieceType::kQueen,  PieceType::kKing};
+
+Color OtherColor(const Color color) { return color == Color::kWhite ? Color::kBlack : Color::kWhite; }
+
+bool IsEnPassant(const Position& position, const Move move) {
+  return position.at(move.from_square).type == PieceType::kPawn && position.at(move.to_square) == pieces::kNone &&
+         GetFile(move.from_square) != GetFile(move.to_square);
+}
+
+/**
+ * The pieces still able to capture on the target square. Each capture removes the capturing piece from the occupancy,
+ * which can uncover a slider standing behind it.
+ */
+class Exchange {
+ public:
+  Exchange(const Position& position, const Move move) : bitboards_(MakeBitboards(position)), target_(move.to_square) {
+    if (!IsValidSquare(move.from_square) || !IsValidSquare(move.to_square)) {
+      throw std::invalid_argument("Invalid move squares.");
+    }
+    const Piece mover = position.at(move.from_square);
+    if (mover == pieces::kNone) {
+      throw std::invalid_argument("No piece to move.");
+    }
+    occupied_ = bitboards_.Occupied() & ~SquareBitboard(move.from_square);
+    if (IsEnPassant(position, move)) {
+      // The captured pawn is beside the moving pawn, on the from square's rank and the to square's file.
+      occupied_ &= ~SquareBitboard(SquareFromFileRank(GetFile(move.to_square), GetRank(move.from_square)));
+    }
+    attackers_ = AttackersTo(bitboards_, target_, occupied_) & occupied_;
+    side_ = OtherColor(mover.color);
+  }
+
+  /**
+   * @return The side to move's least valuable attacker, or PieceType::kNone if it has none left.
+   */
+  [[nodiscard]] PieceType LeastValuableAttacker() const {
+    const Bitboard side_attackers = attackers_ & bitboards_.Pieces(side_);
+    const auto attacker = std::ranges::find_if(kCaptureOrder, [&](const PieceType piece_type) {
+      return (side_attackers & bitboards_.Pieces(piece_type)) != kEmptyBitboard;
+    });
+    return attacker == kCaptureOrder.end() ? PieceType::kNone : *attacker;
+  }
+
+  /**
+   * A king can only capture if this is false.
+   */
+  [[nodiscard]] bool OpponentAttacks() const {
+    return (attackers_ & bitboards_.Pieces(OtherColor(side_))) != kEmptyBitboard;
+  }
+
+  /**
+   * Captures with one of the side to move's attackers of the given type and passes the move to the other side.
+   */
+  void Capture(const PieceType piece_type) {
+    occupied_ &= ~SquareBitboard(LowestSquare(attackers_ & bitboards_.Pieces(Piece{side_, piece_type})));
+    const Bitboard queens = bitboards_.Pieces(PieceType::kQueen);
+    // Only pieces on a diagonal or file through the target can be hiding a slider.
+    if (piece_type == PieceType::kPawn || piece_type == PieceType::kBishop || piece_type == PieceType::kQueen) {
+      attackers_ |= BishopAttacks(target_, occupied_) & (bitboards_.Pieces(PieceType::kBishop) | queens);
+    }
+    if (piece_type == PieceType::kRook || piece_type == PieceType::kQueen) {
+      attackers_ |= RookAttacks(target_, occupied_) & (bitboards_.Pieces(PieceType::kRook) | queens);
+    }
+    attackers_ &= occupied_;
+    side_ = OtherColor(side_);
+  }
+
+ private:
+  PositionBitboards bitboards_;
+  Square target_;
+  Bitboard occupied_ = kEmptyBitboard;
+  Bitboard attackers_ = kEmptyBitboard;
+  Color side_ = Color::kNone;
+};
+
+int CapturedValue(const Position& position, const Move move) {
+  const PieceType victim = IsEnPassant(position, move) ? PieceType::kPawn : position.at(move.to_square).type;
+  int value = PieceValue(victim);
+  if (move.promotion != PieceType::kNone) {
+    value += PieceValue(move.promotion) - PieceValue(PieceType::kPawn);
+  }
+  return value;
+}
+}  // namespace
+
+int SEE(const Position& position, const Move move) {
+  Exchange exchange(position, move);
+  // gains.at(n) is what the side making capture n has won so far, if nothing is captured after it.
+  std::array<int, 33> gains{};
+  gains.front() = CapturedValue(position, move);
+  PieceType on_target = move.promotion != PieceType::kNone ? move.promotion : position.at(move.from_square).type;
+  size_t depth = 0;
+  for (PieceType attacker = exchange.LeastValuableAttacker(); attacker != PieceType::kNone;
+       attacker = exchange.LeastValuableAttacker()) {
+    if (attacker == PieceType::kKing && exchange.OpponentAttacks()) {
+      break;
+    }
+    depth += 1;
+    gains.at(depth) = PieceValue(on_target) - gains.at(depth - 1);
+    on_target = attacker;
+    exchange.Capture(attacker);
+  }
+  // Working back from the last capture, each side only captures if that beats stopping.
+  for (; depth > 0; --depth) {
+    gains.at(depth - 1) = std::min(gains.at(depth - 1), -gains.at(depth));
+  }
+  return gains.front();
+}
+
+bool SEEGreaterEqual(const Position& position, const Move move, const int threshold) {
+  if (move.promotion != PieceType::kNone ||
+      (IsValidSquare(move.from_square) && IsValidSquare(move.to_square) && IsEnPassant(position, move))) {
+    return SEE(position, move) >= threshold;
+  }
+  Exchange exchange(position, move);
+  // The balance after the last capture if the other side stops now, relative to the threshold.
+  int balance = PieceValue(position.at(move.to_square).type) - threshold;
+  if (balance < 0) {
+    return false;
+  }
+  balance = PieceValue(position.at(move.from_square).type) - balance;
+  if (balance <= 0) {
+    return true;
+  }
+  // result is true while the side that made the first move is winning the exchange.
+  bool result = true;
+  for (PieceType attacker = exchange.LeastValuableAttacker(); attacker != PieceType::kNone;
+       attacker = exchange.LeastValuableAttacker()) {
+    result = !result;
+    if (attacker == PieceType::kKing) {
+      return exchange.OpponentAttacks() ? !result : result;
+    }
+    balance = PieceValue(attacker) - balance;
+    if (balance < static_cast<int>(result)) {
+      break;
+    }
+    exchange.Capture(attacker);
+  }
+  return result;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,1064 @@
+#include "tablebase.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "mappedfile.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+// Syzygy orders pieces from strongest to weakest within each side of a table name.
+constexpr std::string_view kTablePieceLetters = "KQRBNP";
+constexpr std::array<std::byte, 4> kWdlMagic{std::byte{0x71}, std::byte{0xE8}, std::byte{0x23}, std::byte{0x5D}};
+constexpr std::array<std::byte, 4> kDtzMagic{std::byte{0xD7}, std::byte{0x66}, std::byte{0x0C}, std::byte{0xA5}};
+
+// The decoder follows the probing code of Stockfish (tbprobe.cpp), from which the names of the index tables come.
+// Tables number squares from a1 (0) to h8 (63), and pieces 1 to 6 from pawn to king, plus 8 for black.
+constexpr uint8_t kSplitFlag = 1;
+constexpr uint8_t kHasPawnsFlag = 2;
+constexpr uint8_t kSideToMoveFlag = 1;
+constexpr uint8_t kMappedFlag = 2;
+constexpr uint8_t kWinPliesFlag = 4;
+constexpr uint8_t kLossPliesFlag = 8;
+constexpr uint8_t kWideFlag = 16;
+constexpr uint8_t kSingleValueFlag = 128;
+// Positions of three unique pieces, one of them in the a1-d1-d4 triangle, and of two kings.
+constexpr uint64_t kUniquePiecesSize = 31332;
+constexpr uint64_t kKingsSize = 462;
+// A symbol with this right hand symbol is a value rather than a pair of symbols.
+constexpr int kValueSymbol = 0xFFF;
+
+constexpr int FileOf(const int square) { return square & 7; }
+constexpr int RankOf(const int square) { return square >> 3; }
+// Positive above the a1-h8 diagonal, negative below it.
+constexpr int OffDiagonal(const int square) { return RankOf(square) - FileOf(square); }
+
+struct IndexTables {
+  std::array<int, 64> map_b1h1h7{};
+  std::array<int, 64> map_a1d1d4{};
+  std::array<std::array<int, 64>, 10> map_kk{};
+  std::array<std::array<uint64_t, 64>, 6> binomial{};
+  std::array<int, 64> map_pawns{};
+  std::array<std::array<uint64_t, 64>, 6> lead_pawn_index{};
+  std::array<std::array<uint64_t, 4>, 6> lead_pawns_size{};
+};
+
+constexpr IndexTables MakeIndexTables() {
+  IndexTables tables;
+  int code = 0;
+  for (int square = 0; square < 64; ++square) {
+    if (OffDiagonal(square) < 0) {
+      tables.map_b1h1h7.at(square) = code++;
+    }
+  }
+
+  // The a1-d1-d4 triangle, with the diagonal squares last.
+  code = 0;
+  for (int square = 0; square < 64; ++square) {
+    if (OffDiagonal(square) < 0 && FileOf(square) <= 3 && RankOf(square) <= 3) {
+      tables.map_a1d1d4.at(square) = code++;
+    }
+  }
+  for (int square = 0; square < 64; ++square) {
+    if (OffDiagonal(square) == 0 && FileOf(square) <= 3) {
+      tables.map_a1d1d4.at(square) = code++;
+    }
+  }
+
+  // Two kings, the first in the triangle. If the first is on the diagonal the second may not be above it, and
+  // positions with both on the diagonal come last.
+  std::array<std::pair<int, int>, 64> both_on_diagonal{};
+  size_t both_on_diagonal_count = 0;
+  code = 0;
+  for (int index = 0; index < 10; ++index) {
+    for (int first = 0; first < 64; ++first) {
+      // Squares outside the triangle are 0 too, b1 is the one really mapped to 0.
+      if (tables.map_a1d1d4.at(first) != index || (index == 0 && first != 1) || RankOf(first) > 3 ||
+          FileOf(first) > 3 || OffDiagonal(first) > 0) {
+        continue;
+      }
+      for (int second = 0; second < 64; ++second) {
+        const int file_distance = FileOf(first) - FileOf(second);
+        const int rank_distance = RankOf(first) - RankOf(second);
+        if (file_distance >= -1 && file_distance <= 1 && rank_distance >= -1 && rank_distance <= 1) {
+          continue;
+        }
+        if (OffDiagonal(first) == 0 && OffDiagonal(second) > 0) {
+          continue;
+        }
+        if (OffDiagonal(first) == 0 && OffDiagonal(second) == 0) {
+          both_on_diagonal.at(both_on_diagonal_count++) = {index, second};
+        } else {
+          tables.map_kk.at(index).at(second) = code++;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < both_on_diagonal_count; ++i) {
+    tables.map_kk.at(both_on_diagonal.at(i).first).at(both_on_diagonal.at(i).second) = code++;
+  }
+
+  // binomial[k][n] ways to choose k of n squares.
+  tables.binomial.at(0).at(0) = 1;
+  for (int n = 1; n < 64; ++n) {
+    for (int k = 0; k < 6 && k <= n; ++k) {
+      tables.binomial.at(k).at(n) =
+          (k > 0 ? tables.binomial.at(k - 1).at(n - 1) : 0) + (k < n ? tables.binomial.at(k).at(n - 1) : 0);
+    }
+  }
+
+  // map_pawns numbers a2-h7 so the leading pawn, nearest the edge and then on the lowest rank, has the highest
+  // number. Leading pawns are indexed per file of the first one, up to 5 of them.
+  int available_squares = 47;
+  for (int lead_pawn_count = 1; lead_pawn_count <= 5; ++lead_pawn_count) {
+    for (int file = 0; file < 4; ++file) {
+      uint64_t index = 0;
+      for (int rank = 1; rank <= 6; ++rank) {
+        const int square = rank * 8 + file;
+        if (lead_pawn_count == 1) {
+          tables.map_pawns.at(square) = available_squares--;
+          tables.map_pawns.at(square ^ 7) = available_squares--;
+        }
+        tables.lead_pawn_index.at(lead_pawn_count).at(square) = index;
+        index += tables.binomial.at(lead_pawn_count - 1).at(tables.map_pawns.at(square));
+      }
+      tables.lead_pawns_size.at(lead_pawn_count).at(file) = index;
+    }
+  }
+  return tables;
+}
+
+constexpr IndexTables kIndexTables = MakeIndexTables();
+
+int TableOrderIndex(const PieceType piece_type) {
+  switch (piece_type) {
+    case PieceType::kKing:
+      return 0;
+    case PieceType::kQueen:
+      return 1;
+    case PieceType::kRook:
+      return 2;
+    case PieceType::kBishop:
+      return 3;
+    case PieceType::kKnight:
+      return 4;
+    case PieceType::kPawn:
+      return 5;
+    default:
+      throw std::invalid_argument("Invalid piece type in position.");
+  }
+}
+
+// 0 for an empty square.
+int TablePiece(const Piece piece) {
+  switch (piece.type) {
+    case PieceType::kPawn:
+      return piece.color == Color::kBlack ? 9 : 1;
+    case PieceType::kKnight:
+      return piece.color == Color::kBlack ? 10 : 2;
+    case PieceType::kBishop:
+      return piece.color == Color::kBlack ? 11 : 3;
+    case PieceType::kRook:
+      return piece.color == Color::kBlack ? 12 : 4;
+    case PieceType::kQueen:
+      return piece.color == Color::kBlack ? 13 : 5;
+    case PieceType::kKing:
+      return piece.color == Color::kBlack ? 14 : 6;
+    default:
+      return 0;
+  }
+}
+
+std::string SideName(const std::array<int, 6>& piece_counts) {
+  std::string name;
+  for (size_t i = 0; i < piece_counts.size(); ++i) {
+    name.append(piece_counts.at(i), kTablePieceLetters.at(i));
+  }
+  return name;
+}
+
+// White's side of the name, then black's.
+std::array<std::string, 2> SideNames(const Position& position) {
+  std::array<std::array<int, 6>, 2> piece_counts{};
+  int total_pieces = 0;
+  for (const Piece piece : position) {
+    if (piece == pieces::kNone) {
+      continue;
+    }
+    if (piece.color != Color::kWhite && piece.color != Color::kBlack) {
+      throw std::invalid_argument("Invalid piece color in position.");
+    }
+    piece_counts.at(std::to_underlying(piece.color)).at(TableOrderIndex(piece.type)) += 1;
+    total_pieces += 1;
+  }
+  if (piece_counts.at(0).at(0) != 1 || piece_counts.at(1).at(0) != 1) {
+    throw std::invalid_argument("Tablebase positions must have exactly one king of each color.");
+  }
+  if (total_pieces > kMaxTablebasePieces) {
+    throw std::invalid_argument("Too many pieces for a tablebase position.");
+  }
+  return {SideName(piece_counts.at(0)), SideName(piece_counts.at(1))};
+}
+
+// A side is stronger if it has more pieces, or the same number of pieces and the strongest piece where the two sides
+// differ.
+bool IsStrongerSide(const std::string_view side_1, const std::string_view side_2) {
+  if (side_1.size() != side_2.size()) {
+    return side_1.size() > side_2.size();
+  }
+  for (size_t i = 0; i < side_1.size(); ++i) {
+    const size_t strength_1 = kTablePieceLetters.find(side_1.at(i));
+    const size_t strength_2 = kTablePieceLetters.find(side_2.at(i));
+    if (strength_1 != strength_2) {
+      return strength_1 < strength_2;
+    }
+  }
+  return false;
+}
+
+bool IsTableName(const std::string_view name) {
+  const size_t separator = name.find('v');
+  if (separator == std::string_view::npos || name.size() - 1 > kMaxTablebasePieces) {
+    return false;
+  }
+  const std::string_view strong_side = name.substr(0, separator);
+  const std::string_view weak_side = name.substr(separator + 1);
+  for (const std::string_view side : {strong_side, weak_side}) {
+    if (side.empty() || side.front() != 'K' || side.find_first_not_of(kTablePieceLetters) != std::string_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+WdlScore Negate(const WdlScore wdl) { return static_cast<WdlScore>(-std::to_underlying(wdl)); }
+
+// The DTZ of a position whose best move is a capture or pawn move with the given result.
+int DtzBeforeZeroing(const WdlScore wdl) {
+  switch (wdl) {
+    case WdlScore::kWin:
+      return 1;
+    case WdlScore::kCursedWin:
+      return 101;
+    case WdlScore::kBlessedLoss:
+      return -101;
+    case WdlScore::kLoss:
+      return -1;
+    default:
+      return 0;
+  }
+}
+
+[[noreturn]] void ThrowCorrupt() { throw std::runtime_error("Syzygy table is corrupt."); }
+
+// Little endian, as table headers are stored.
+uint64_t ReadLittleEndian(const std::span<const std::byte> bytes, const size_t offset, const size_t size) {
+  if (offset > bytes.size() || bytes.size() - offset < size) {
+    ThrowCorrupt();
+  }
+  uint64_t value = 0;
+  for (size_t i = size; i > 0; --i) {
+    value = value << 8 | static_cast<uint8_t>(bytes[offset + i - 1]);
+  }
+  return value;
+}
+
+// Big endian, as the compressed data is stored.
+uint32_t ReadBigEndian32(const std::span<const std::byte> bytes, const size_t offset) {
+  if (offset > bytes.size() || bytes.size() - offset < 4) {
+    ThrowCorrupt();
+  }
+  uint32_t value = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    value = value << 8 | static_cast<uint8_t>(bytes[offset + i]);
+  }
+  return value;
+}
+
+/**
+ * Reads a table file front to back, throwing instead of reading past the end.
+ */
+class TableReader {
+ public:
+  TableReader(const std::span<const std::byte> data, const size_t offset) : data_(data), offset_(offset) {}
+
+  uint8_t Byte() { return static_cast<uint8_t>(Take(1).front()); }
+
+  uint64_t LittleEndian(const size_t size) { return ReadLittleEndian(Take(size), 0, size); }
+
+  std::span<const std::byte> Take(const size_t size) {
+    if (offset_ > data_.size() || data_.size() - offset_ < size) {
+      ThrowCorrupt();
+    }
+    offset_ += size;
+    return data_.subspan(offset_ - size, size);
+  }
+
+  // Sections are aligned relative to the start of the file. A section of nothing may be aligned past the end.
+  void Align(const size_t alignment) {
+    offset_ = std::min((offset_ + alignment - 1) / alignment * alignment, data_.size());
+  }
+
+  [[nodiscard]] size_t Offset() const noexcept { return offset_; }
+
+ private:
+  std::span<const std::byte> data_;
+  size_t offset_;
+};
+
+/**
+ * One compressed table of values: a side to move, and for tables with pawns the file of the leading pawn. Values are
+ * Huffman coded symbols in blocks, and each symbol stands for a value or a pair of symbols.
+ */
+struct PairsData {
+  uint8_t flags = 0;
+  // The value of every position with kSingleValueFlag.
+  int min_symbol_length = 0;
+  size_t block_size = 0;
+  size_t span = 0;
+  size_t block_count = 0;
+  size_t block_length_count = 0;
+  size_t sparse_index_size = 0;
+  std::span<const std::byte> lowest_symbols;
+  // 3 bytes a symbol: the 12 bit left and right hand symbols.
+  std::span<const std::byte> symbol_pairs;
+  // Every span'th value's block and offset in it, 6 bytes each.
+  std::span<const std::byte> sparse_index;
+  // The value count of each block, minus one.
+  std::span<const std::byte> block_lengths;
+  std::span<const std::byte> data;
+  // base64[l] is the lowest code of length min_symbol_length + l, padded to 64 bits.
+  std::vector<uint64_t> base64;
+  // How many values each symbol stands for, minus one.
+  std::vector<int> symbol_lengths;
+  std::array<int, kMaxTablebasePieces> pieces{};
+  // Pieces are indexed in groups of the same piece, the leading group first. group_length ends with a 0, and the
+  // entry of group_index there is the table size.
+  std::array<uint64_t, kMaxTablebasePieces + 1> group_index{};
+  std::array<int, kMaxTablebasePieces + 1> group_length{};
+  // Where the value lists of DTZ tables start for a win, loss, cursed win and blessed loss, plus one.
+  std::array<size_t, 4> dtz_map_index{};
+
+  [[nodiscard]] int Symbol(const int symbol, const bool right) const {
+    const uint64_t pair = ReadLittleEndian(symbol_pairs, static_cast<size_t>(symbol) * 3, 3);
+    return static_cast<int>(right ? pair >> 12 : pair & 0xFFF);
+  }
+
+  [[nodiscard]] size_t BlockLength(const size_t block) const {
+    if (block >= block_length_count) {
+      ThrowCorrupt();
+    }
+    return ReadLittleEndian(block_lengths, block * 2, 2);
+  }
+
+  /**
+   * @return The value of the index'th position.
+   */
+  [[nodiscard]] int Decompress(const uint64_t index) const {
+    if ((flags & kSingleValueFlag) != 0) {
+      return min_symbol_length;
+    }
+    const uint64_t entry = index / span;
+    if (entry >= sparse_index_size) {
+      ThrowCorrupt();
+    }
+    size_t block = ReadLittleEndian(sparse_index, entry * 6, 4);
+    // The entry points at the middle of its span.
+    int64_t offset = static_cast<int64_t>(ReadLittleEndian(sparse_index, entry * 6 + 4, 2)) +
+                     static_cast<int64_t>(index % span) - static_cast<int64_t>(span / 2);
+    while (offset < 0) {
+      if (block == 0) {
+        ThrowCorrupt();
+      }
+      block -= 1;
+      offset += static_cast<int64_t>(BlockLength(block)) + 1;
+    }
+    while (offset > static_cast<int64_t>(BlockLength(block))) {
+      offset -= static_cast<int64_t>(BlockLength(block)) + 1;
+      block += 1;
+    }
+    if (block >= block_count) {
+      ThrowCorrupt();
+    }
+
+    const std::span<const std::byte> block_data = data.subspan(block * block_size, block_size);
+    size_t read = 8;
+    uint64_t buffer = uint64_t{ReadBigEndian32(block_data, 0)} << 32 | ReadBigEndian32(block_data, 4);
+    int buffer_bits = 64;
+    int symbol = 0;
+    while (true) {
+      size_t length = 0;
+      while (buffer < base64.at(length)) {
+        length += 1;
+      }
+      symbol = static_cast<int>((buffer - base64.at(length)) >> (64 - length - min_symbol_length)) +
+               static_cast<int>(ReadLittleEndian(lowest_symbols, length * 2, 2));
+      if (symbol >= static_cast<int>(symbol_lengths.size())) {
+        ThrowCorrupt();
+      }
+      if (offset < symbol_lengths[symbol] + 1) {
+        break;
+      }
+      offset -= symbol_lengths[symbol] + 1;
+      length += min_symbol_length;
+      buffer <<= length;
+      buffer_bits -= static_cast<int>(length);
+      if (buffer_bits <= 32) {
+        buffer_bits += 32;
+        buffer |= uint64_t{ReadBigEndian32(block_data, read)} << (64 - buffer_bits);
+        read += 4;
+      }
+    }
+    // Expand pairs until the symbol is a single value.
+    while (symbol_lengths[symbol] != 0) {
+      const int left = Symbol(symbol, false);
+      if (left >= static_cast<int>(symbol_lengths.size())) {
+        ThrowCorrupt();
+      }
+      if (offset < symbol_lengths[left] + 1) {
+        symbol = left;
+      } else {
+        offset -= symbol_lengths[left] + 1;
+        symbol = Symbol(symbol, true);
+      }
+    }
+    return Symbol(symbol, false);
+  }
+};
+
+int SymbolLength(PairsData& pairs, const int symbol, std::vector<bool>& visited) {
+  // Set before the children are visited, so a cyclic table can't recurse forever.
+  visited.at(symbol) = true;
+  const int right = pairs.Symbol(symbol, true);
+  if (right == kValueSymbol) {
+    return 0;
+  }
+  const int left = pairs.Symbol(symbol, false);
+  for (const int child : {left, right}) {
+    if (child >= static_cast<int>(pairs.symbol_lengths.size())) {
+      ThrowCorrupt();
+    }
+    if (!visited.at(child)) {
+      pairs.symbol_lengths.at(child) = SymbolLength(pairs, child, visited);
+    }
+  }
+  return pairs.symbol_lengths.at(left) + pairs.symbol_lengths.at(right) + 1;
+}
+
+void ReadSizes(PairsData& pairs, TableReader& reader) {
+  pairs.flags = reader.Byte();
+  if ((pairs.flags & kSingleValueFlag) != 0) {
+    pairs.min_symbol_length = reader.Byte();
+    return;
+  }
+  const size_t groups = static_cast<size_t>(std::ranges::find(pairs.group_length, 0) - pairs.group_length.begin());
+  const uint64_t table_size = pairs.group_index.at(groups);
+
+  const int block_size_bits = reader.Byte();
+  const int span_bits = reader.Byte();
+  if (block_size_bits >= 32 || span_bits >= 32 || span_bits == 0) {
+    ThrowCorrupt();
+  }
+  pairs.block_size = size_t{1} << block_size_bits;
+  pairs.span = size_t{1} << span_bits;
+  pairs.sparse_index_size = (table_size + pairs.span - 1) / pairs.span;
+  const size_t padding = reader.Byte();
+  pairs.block_count = reader.LittleEndian(4);
+  // Padded so the sparse index never points past the end.
+  pairs.block_length_count = pairs.block_count + padding;
+  const int max_symbol_length = reader.Byte();
+  pairs.min_symbol_length = reader.Byte();
+  if (pairs.min_symbol_length == 0 || max_symbol_length < pairs.min_symbol_length || max_symbol_length > 32) {
+    ThrowCorrupt();
+  }
+  const size_t lengths = static_cast<size_t>(max_symbol_length - pairs.min_symbol_length + 1);
+  pairs.lowest_symbols = reader.Take(lengths * 2);
+
+  // Canonical Huffman codes: the lowest code of each length, from the longest, then left aligned in 64 bits.
+  pairs.base64.assign(lengths, 0);
+  for (size_t i = lengths - 1; i > 0; --i) {
+    pairs.base64.at(i - 1) = (pairs.base64.at(i) + ReadLittleEndian(pairs.lowest_symbols, (i - 1) * 2, 2) -
+                              ReadLittleEndian(pairs.lowest_symbols, i * 2, 2)) /
+                             2;
+  }
+  for (size_t i = 0; i < lengths; ++i) {
+    pairs.base64.at(i) <<= 64 - i - static_cast<size_t>(pairs.min_symbol_length);
+  }
+
+  const size_t symbol_count = reader.LittleEndian(2);
+  pairs.symbol_pairs = reader.Take(symbol_count * 3);
+  reader.Take(symbol_count & 1);
+  pairs.symbol_lengths.assign(symbol_count, 0);
+  std::vector<bool> visited(symbol_count);
+  for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+    if (!visited.at(symbol)) {
+      pairs.symbol_lengths.at(symbol) = SymbolLength(pairs, static_cast<int>(symbol), visited);
+    }
+  }
+}
+}  // namespace
+
+/**
+ * A table file parsed into its PairsData. Everything points into the mapped file.
+ */
+struct Tablebase::TableLayout {
+  TableLayout(std::string_view name, TablebaseType type, std::span<const std::byte> file);
+
+  /**
+   * @return The stored value of the position: the WDL score plus 2, or for DTZ tables the distance in plies.
+   * std::nullopt if the DTZ table stores the other side to move.
+   */
+  [[nodiscard]] std::optional<int> Probe(const Position& position, Color side_to_move, WdlScore wdl) const;
+
+  [[nodiscard]] const PairsData& Get(const int side_to_move, const int file) const {
+    return pairs.at(side_to_move % sides).at(has_pawns ? file : 0);
+  }
+
+  TablebaseType type;
+  int piece_count = 0;
+  bool has_pawns = false;
+  bool both_sides_have_pawns = false;
+  bool has_unique_pieces = false;
+  bool symmetric = false;
+  int sides = 1;
+  // [side to move][file of the leading pawn], only file 0 without pawns.
+  std::array<std::array<PairsData, 4>, 2> pairs;
+  std::span<const std::byte> dtz_map;
+
+ private:
+  void SetGroups(PairsData& table, const std::array<int, 2>& order, int file) const;
+  [[nodiscard]] int DtzValue(int file, int value, WdlScore wdl) const;
+};
+
+Tablebase::TableLayout::TableLayout(const std::string_view name, const TablebaseType type,
+                                    const std::span<const std::byte> file)
+    : type(type), piece_count(static_cast<int>(name.size() - 1)) {
+  const std::string_view strong_side = name.substr(0, name.find('v'));
+  const std::string_view weak_side = name.substr(name.find('v') + 1);
+  has_pawns = name.contains('P');
+  both_sides_have_pawns = strong_side.contains('P') && weak_side.contains('P');
+  symmetric = strong_side == weak_side;
+  for (const std::string_view side : {strong_side, weak_side}) {
+    for (const char letter : kTablePieceLetters.substr(1)) {
+      has_unique_pieces = has_unique_pieces || std::ranges::count(side, letter) == 1;
+    }
+  }
+  // A WDL table stores both sides to move unless the material is the same for both.
+  sides = type == TablebaseType::kWdl && !symmetric ? 2 : 1;
+  const int files = has_pawns ? 4 : 1;
+
+  TableReader reader(file, kWdlMagic.size());
+  const uint8_t header = reader.Byte();
+  if (((header & kHasPawnsFlag) != 0) != has_pawns || ((header & kSplitFlag) != 0) == symmetric) {
+    throw std::runtime_error("Syzygy table doesn't match its file name.");
+  }
+  for (int table_file = 0; table_file < files; ++table_file) {
+    const uint8_t first_order = reader.Byte();
+    const uint8_t second_order = both_sides_have_pawns ? reader.Byte() : 0xFF;
+    for (int k = 0; k < piece_count; ++k) {
+      const uint8_t piece = reader.Byte();
+      for (int side = 0; side < sides; ++side) {
+        pairs.at(side).at(table_file).pieces.at(k) = side == 0 ? piece & 0xF : piece >> 4;
+      }
+    }
+    for (int side = 0; side < sides; ++side) {
+      const std::array<int, 2> order{side == 0 ? first_order & 0xF : first_order >> 4,
+                                     side == 0 ? second_order & 0xF : second_order >> 4};
+      SetGroups(pairs.at(side).at(table_file), order, table_file);
+    }
+  }
+  reader.Align(2);
+  for (int table_file = 0; table_file < files; ++table_file) {
+    for (int side = 0; side < sides; ++side) {
+      ReadSizes(pairs.at(side).at(table_file), reader);
+    }
+  }
+
+  if (type == TablebaseType::kDtz) {
+    const size_t map_start = reader.Offset();
+    for (int table_file = 0; table_file < files; ++table_file) {
+      PairsData& table = pairs.at(0).at(table_file);
+      if ((table.flags & kMappedFlag) == 0) {
+        continue;
+      }
+      // Four lists of values, each starting with its length.
+      for (size_t& index : table.dtz_map_index) {
+        if ((table.flags & kWideFlag) != 0) {
+          reader.Align(2);
+          index = (reader.Offset() - map_start) / 2 + 1;
+          reader.Take(reader.LittleEndian(2) * 2);
+        } else {
+          index = reader.Offset() - map_start + 1;
+          reader.Take(reader.Byte());
+        }
+      }
+    }
+    dtz_map = file.subspan(map_start);
+    reader.Align(2);
+  }
+
+  for (int table_file = 0; table_file < files; ++table_file) {
+    for (int side = 0; side < sides; ++side) {
+      PairsData& table = pairs.at(side).at(table_file);
+      table.sparse_index = reader.Take(table.sparse_index_size * 6);
+    }
+  }
+  for (int table_file = 0; table_file < files; ++table_file) {
+    for (int side = 0; side < sides; ++side) {
+      PairsData& table = pairs.at(side).at(table_file);
+      table.block_lengths = reader.Take(table.block_length_count * 2);
+    }
+  }
+  for (int table_file = 0; table_file < files; ++table_file) {
+    for (int side = 0; side < sides; ++side) {
+      PairsData& table = pairs.at(side).at(table_file);
+      reader.Align(64);
+      table.data = reader.Take(table.block_count * table.block_size);
+    }
+  }
+}
+
+// Splits the pieces into groups and works out each group's multiplier. The leading group holds the leading pawns, or
+// the kings plus a unique piece (or just the kings) without pawns. order gives the position of the leading group and
+// of the other side's pawns in the index, the remaining groups fill the other places in turn.
+void Tablebase::TableLayout::SetGroups(PairsData& table, const std::array<int, 2>& order, const int file) const {
+  int groups = 0;
+  int first_length = has_pawns ? 0 : has_unique_pieces ? 3 : 2;
+  table.group_length.at(0) = 1;
+  for (int i = 1; i < piece_count; ++i) {
+    if (--first_length > 0 || table.pieces.at(i) == table.pieces.at(i - 1)) {
+      table.group_length.at(groups) += 1;
+    } else {
+      table.group_length.at(++groups) = 1;
+    }
+  }
+  table.group_length.at(++groups) = 0;
+
+  int next = both_sides_have_pawns ? 2 : 1;
+  int free_squares = 64 - table.group_length.at(0) - (both_sides_have_pawns ? table.group_length.at(1) : 0);
+  uint64_t index = 1;
+  for (int k = 0; next < groups || k == order.at(0) || k == order.at(1); ++k) {
+    if (k == order.at(0)) {
+      table.group_index.at(0) = index;
+      index *= has_pawns           ? kIndexTables.lead_pawns_size.at(table.group_length.at(0)).at(file)
+               : has_unique_pieces ? kUniquePiecesSize
+                                   : kKingsSize;
+    } else if (k == order.at(1)) {
+      table.group_index.at(1) = index;
+      index *= kIndexTables.binomial.at(table.group_length.at(1)).at(48 - table.group_length.at(0));
+    } else {
+      table.group_index.at(next) = index;
+      index *= kIndexTables.binomial.at(table.group_length.at(next)).at(free_squares);
+      free_squares -= table.group_length.at(next++);
+    }
+  }
+  table.group_index.at(groups) = index;
+}
+
+std::optional<int> Tablebase::TableLayout::Probe(const Position& position, const Color side_to_move,
+                                                 const WdlScore wdl) const {
+  // Tables are stored with the stronger side as white, and with white to move when both sides have the same
+  // material. Other positions are looked up with the colors swapped and the board flipped.
+  const std::array<std::string, 2> side_names = SideNames(position);
+  const bool flip = (symmetric && side_to_move == Color::kBlack) || IsStrongerSide(side_names.at(1), side_names.at(0));
+  const int flip_color = flip ? 8 : 0;
+  const int flip_squares = flip ? 56 : 0;
+  const int stored_side = static_cast<int>(flip) ^ static_cast<int>(ColorIndex(side_to_move));
+
+  std::array<int, kMaxTablebasePieces> squares{};
+  std::array<int, kMaxTablebasePieces> pieces{};
+  int size = 0;
+  int lead_pawn_count = 0;
+  int file = 0;
+  const auto by_map_pawns = [](const int square_1, const int square_2) {
+    return kIndexTables.map_pawns.at(square_1) < kIndexTables.map_pawns.at(square_2);
+  };
+  // Tables with pawns are split by the file of the leading pawn, the one furthest towards the edge.
+  const int lead_pawn = has_pawns ? Get(0, 0).pieces.at(0) ^ flip_color : 0;
+  if (has_pawns) {
+    if ((lead_pawn & 7) != 1) {
+      ThrowCorrupt();
+    }
+    for (int square = 0; square < 64; ++square) {
+      if (TablePiece(position.at(static_cast<Square>(square ^ 56))) == lead_pawn) {
+        squares.at(size++) = square ^ flip_squares;
+      }
+    }
+    lead_pawn_count = size;
+    std::swap(squares.at(0), *std::max_element(squares.begin(), squares.begin() + size, by_map_pawns));
+    file = std::min(FileOf(squares.at(0)), 7 - FileOf(squares.at(0)));
+  }
+  const PairsData& table = Get(stored_side, file);
+  if (type == TablebaseType::kDtz && (table.flags & kSideToMoveFlag) != stored_side && (!symmetric || has_pawns)) {
+    return std::nullopt;
+  }
+
+  for (int square = 0; square < 64; ++square) {
+    const int piece = TablePiece(position.at(static_cast<Square>(square ^ 56)));
+    if (piece != 0 && !(has_pawns && piece == lead_pawn)) {
+      squares.at(size) = square ^ flip_squares;
+      pieces.at(size++) = piece ^ flip_color;
+    }
+  }
+  // Put the pieces in the table's order.
+  for (int i = lead_pawn_count; i < size; ++i) {
+    const auto match = std::find(pieces.begin() + i, pieces.begin() + size, table.pieces.at(i));
+    if (match == pieces.begin() + size) {
+      throw std::runtime_error("Syzygy table doesn't match its file name.");
+    }
+    std::swap(squares.at(i), squares.at(match - pieces.begin()));
+    std::swap(pieces.at(i), *match);
+  }
+
+  // Mirror the leading piece onto files a-d.
+  if (FileOf(squares.at(0)) > 3) {
+    for (int i = 0; i < size; ++i) {
+      squares.at(i) ^= 7;
+    }
+  }
+  uint64_t index = 0;
+  if (has_pawns) {
+    index = kIndexTables.lead_pawn_index.at(lead_pawn_count).at(squares.at(0));
+    std::stable_sort(squares.begin() + 1, squares.begin() + lead_pawn_count, by_map_pawns);
+    for (int i = 1; i < lead_pawn_count; ++i) {
+      index += kIndexTables.binomial.at(i).at(kIndexTables.map_pawns.at(squares.at(i)));
+    }
+  } else {
+    // Then onto ranks 1-4, and below the a1-h8 diagonal, mirroring along the diagonal at the first leading piece off
+    // it.
+    if (RankOf(squares.at(0)) > 3) {
+      for (int i = 0; i < size; ++i) {
+        squares.at(i) ^= 56;
+      }
+    }
+    for (int i = 0; i < table.group_length.at(0); ++i) {
+      if (OffDiagonal(squares.at(i)) == 0) {
+        continue;
+      }
+      if (OffDiagonal(squares.at(i)) > 0) {
+        for (int j = i; j < size; ++j) {
+          squares.at(j) = ((squares.at(j) >> 3) | (squares.at(j) << 3)) & 63;
+        }
+      }
+      break;
+    }
+
+    if (has_unique_pieces) {
+      // Three pieces: the first in the a1-d1-d4 triangle, the others on the squares left. Positions with leading
+      // pieces on the diagonal come after the others.
+      const int adjust_1 = squares.at(1) > squares.at(0) ? 1 : 0;
+      const int adjust_2 = (squares.at(2) > squares.at(0) ? 1 : 0) + (squares.at(2) > squares.at(1) ? 1 : 0);
+      if (OffDiagonal(squares.at(0)) != 0) {
+        index = (kIndexTables.map_a1d1d4.at(squares.at(0)) * 63 + (squares.at(1) - adjust_1)) * 62 + squares.at(2) -
+                adjust_2;
+      } else if (OffDiagonal(squares.at(1)) != 0) {
+        index = (6 * 63 + RankOf(squares.at(0)) * 28 + kIndexTables.map_b1h1h7.at(squares.at(1))) * 62 +
+                squares.at(2) - adjust_2;
+      } else if (OffDiagonal(squares.at(2)) != 0) {
+        index = 6 * 63 * 62 + 4 * 28 * 62 + RankOf(squares.at(0)) * 7 * 28 + (RankOf(squares.at(1)) - adjust_1) * 28 +
+                kIndexTables.map_b1h1h7.at(squares.at(2));
+      } else {
+        index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + RankOf(squares.at(0)) * 7 * 6 +
+                (RankOf(squares.at(1)) - adjust_1) * 6 + (RankOf(squares.at(2)) - adjust_2);
+      }
+    } else {
+      index = kIndexTables.map_kk.at(kIndexTables.map_a1d1d4.at(squares.at(0))).at(squares.at(1));
+    }
+  }
+  index *= table.group_index.at(0);
+
+  // The other groups, each as a combination of the squares the groups before them left free.
+  int group_start = table.group_length.at(0);
+  bool remaining_pawns = both_sides_have_pawns;
+  for (int group = 1; table.group_length.at(group) != 0; ++group) {
+    const auto first = squares.begin() + group_start;
+    const auto last = first + table.group_length.at(group);
+    if (last > squares.begin() + size) {
+      ThrowCorrupt();
+    }
+    std::stable_sort(first, last);
+    uint64_t combination = 0;
+    for (auto square = first; square != last; ++square) {
+      // Squares taken by earlier groups aren't free for this one.
+      const int64_t taken =
+          std::count_if(squares.begin(), first, [&square](const int other) { return *square > other; });
+      combination += kIndexTables.binomial.at(square - first + 1).at(*square - taken - (remaining_pawns ? 8 : 0));
+    }
+    remaining_pawns = false;
+    index += combination * table.group_index.at(group);
+    group_start += table.group_length.at(group);
+  }
+
+  const int value = table.Decompress(index);
+  return type == TablebaseType::kWdl ? value : DtzValue(file, value, wdl);
+}
+
+// DTZ tables store each result's distances as indices into a list of them, ordered by how common they are, and in
+// full moves where that loses nothing.
+int Tablebase::TableLayout::DtzValue(const int file, int value, const WdlScore wdl) const {
+  const PairsData& table = Get(0, file);
+  if ((table.flags & kMappedFlag) != 0) {
+    // Lists in the order win, loss, cursed win, blessed loss.
+    constexpr std::array<size_t, 5> kMapLists{1, 3, 0, 2, 0};
+    const size_t index =
+        table.dtz_map_index.at(kMapLists.at(std::to_underlying(wdl) + 2)) + static_cast<size_t>(value);
+    value = static_cast<int>((table.flags & kWideFlag) != 0 ? ReadLittleEndian(dtz_map, index * 2, 2)
+                                                            : ReadLittleEndian(dtz_map, index, 1));
+  }
+  if ((wdl == WdlScore::kWin && (table.flags & kWinPliesFlag) == 0) ||
+      (wdl == WdlScore::kLoss && (table.flags & kLossPliesFlag) == 0) || wdl == WdlScore::kCursedWin ||
+      wdl == WdlScore::kBlessedLoss) {
+    value *= 2;
+  }
+  return value + 1;
+}
+
+struct Tablebase::TableFile {
+  std::filesystem::path path;
+  std::array<std::byte, 4> magic;
+  std::once_flag mapped;
+  std::unique_ptr<MappedFile> file;
+  std::once_flag parsed;
+  std::unique_ptr<TableLayout> layout;
+};
+
+namespace {
+// The position after the move. Tablebase positions have no castling rights.
+PositionState PlayMove(const Position& position, const Color side_to_move, const Square en_passant, const Move move) {
+  PositionState state{position, side_to_move, {}, en_passant};
+  AdvanceState(state, move);
+  return state;
+}
+
+bool IsZeroing(const Position& position, const Move move) {
+  return IsCapture(position, move) || position.at(move.from_square).type == PieceType::kPawn;
+}
+
+// The DTZ of the position before the move, with the move played.
+int MoveDtz(const Tablebase& tablebase, const Position& position, const Color side_to_move, const Square en_passant,
+            const Move move) {
+  const PositionState after = PlayMove(position, side_to_move, en_passant, move);
+  if (IsZeroing(position, move)) {
+    return DtzBeforeZeroing(Negate(tablebase.ProbeWdl(after.position, after.side_to_move, after.en_passant)));
+  }
+  const int dtz = -tablebase.ProbeDtz(after.position, after.side_to_move, after.en_passant);
+  if (dtz == 1 && IsInCheck(after.position, after.side_to_move)) {
+    std::vector<Move> replies;
+    GenerateLegalMoves(after.position, after.side_to_move, after.en_passant, {}, replies);
+    if (replies.empty()) {
+      return 1;
+    }
+  }
+  return dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : 0;
+}
+}  // namespace
+
+std::string SyzygyTableName(const Position& position) {
+  std::array<std::string, 2> side_names = SideNames(position);
+  if (IsStrongerSide(side_names.at(1), side_names.at(0))) {
+    std::swap(side_names.at(0), side_names.at(1));
+  }
+  return side_names.at(0) + 'v' + side_names.at(1);
+}
+
+Tablebase::Tablebase(const std::filesystem::path& directory) {
+  if (!std::filesystem::is_directory(directory)) {
+    throw std::invalid_argument("Tablebase directory does not exist.");
+  }
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    const std::string name = entry.path().stem().string();
+    const std::filesystem::path extension = entry.path().extension();
+    if (!IsTableName(name) || (extension != ".rtbw" && extension != ".rtbz")) {
+      continue;
+    }
+    auto table = std::make_unique<TableFile>();
+    table->path = entry.path();
+    if (extension == ".rtbw") {
+      table->magic = kWdlMagic;
+      wdl_tables_.emplace(name, std::move(table));
+    } else {
+      table->magic = kDtzMagic;
+      dtz_tables_.emplace(name, std::move(table));
+    }
+    max_pieces_ = std::max(max_pieces_, static_cast<int>(name.size() - 1));
+  }
+}
+
+Tablebase::Tablebase(Tablebase&&) noexcept = default;
+Tablebase& Tablebase::operator=(Tablebase&&) noexcept = default;
+Tablebase::~Tablebase() = default;
+
+int Tablebase::MaxPieces() const noexcept { return max_pieces_; }
+
+bool Tablebase::HasTable(const Position& position, const TablebaseType type) const {
+  const auto& tables = type == TablebaseType::kWdl ? wdl_tables_ : dtz_tables_;
+  return tables.contains(SyzygyTableName(position));
+}
+
+std::span<const std::byte> Tablebase::TableData(const Position& position, const TablebaseType type) const {
+  const auto& tables = type == TablebaseType::kWdl ? wdl_tables_ : dtz_tables_;
+  const auto table = tables.find(SyzygyTableName(position));
+  if (table == tables.end()) {
+    throw std::invalid_argument("No table covers this position.");
+  }
+  TableFile& table_file = *table->second;
+  // If mapping throws the flag stays unset, so the next lookup tries again.
+  std::call_once(table_file.mapped, [&table_file] {
+    // Probes jump around the whole table, so read ahead only wastes page cache.
+    auto file = std::make_unique<MappedFile>(table_file.path, true);
+    const std::span<const std::byte> data = file->Data();
+    if (data.size() < table_file.magic.size() ||
+        !std::ranges::equal(data.first(table_file.magic.size()), table_file.magic)) {
+      throw std::runtime_error("File is not a Syzygy table of the expected type.");
+    }
+    table_file.file = std::move(file);
+  });
+  return table_file.file->Data();
+}
+
+WdlScore Tablebase::ProbeWdl(const Position& position, const Color side_to_move, const Square en_passant) const {
+  std::ignore = SyzygyTableName(position);
+  bool zeroing_best = false;
+  return Search(position, side_to_move, en_passant, WdlScore::kLoss, WdlScore::kWin, false, zeroing_best);
+}
+
+int Tablebase::ProbeDtz(const Position& position, const Color side_to_move, const Square en_passant) const {
+  std::ignore = SyzygyTableName(position);
+  bool zeroing_best = false;
+  const WdlScore wdl = Search(position, side_to_move, en_passant, WdlScore::kLoss, WdlScore::kWin, true, zeroing_best);
+  if (wdl == WdlScore::kDraw) {
+    return 0;
+  }
+  // The DTZ table stores an arbitrary value then, or a wrong one if the best move is a losing en passant capture.
+  if (zeroing_best) {
+    return DtzBeforeZeroing(wdl);
+  }
+  const int sign = wdl > WdlScore::kDraw ? 1 : -1;
+  if (const std::optional<int> dtz = Layout(position, TablebaseType::kDtz).Probe(position, side_to_move, wdl)) {
+    const bool fifty_move_rule = wdl == WdlScore::kCursedWin || wdl == WdlScore::kBlessedLoss;
+    return (*dtz + (fifty_move_rule ? 100 : 0)) * sign;
+  }
+
+  // The table stores the other side to move, so take the best of the moves here. Winning takes the quickest win, and
+  // losing the slowest loss, which is the lowest DTZ either way.
+  std::vector<Move> moves;
+  GenerateLegalMoves(position, side_to_move, en_passant, {}, moves);
+  std::optional<int> best;
+  for (const Move move : moves) {
+    const int dtz = MoveDtz(*this, position, side_to_move, en_passant, move);
+    if ((dtz > 0 ? 1 : dtz < 0 ? -1 : 0) == sign && (!best.has_value() || dtz < *best)) {
+      best = dtz;
+    }
+  }
+  // Without legal moves the side to move is mated.
+  return best.value_or(-1);
+}
+
+std::optional<Move> Tablebase::BestMove(const Position& position, const Color side_to_move,
+                                        const Square en_passant) const {
+  std::ignore = SyzygyTableName(position);
+  std::vector<Move> moves;
+  GenerateLegalMoves(position, side_to_move, en_passant, {}, moves);
+  std::optional<Move> best;
+  int best_rank = 0;
+  for (const Move move : moves) {
+    // Quicker wins rank higher, then draws, then slower losses.
+    constexpr int kMaxRank = 1000;
+    const int dtz = MoveDtz(*this, position, side_to_move, en_passant, move);
+    const int rank = dtz > 0 ? kMaxRank - dtz : dtz < 0 ? -kMaxRank - dtz : 0;
+    if (!best.has_value() || rank > best_rank) {
+      best = move;
+      best_rank = rank;
+    }
+  }
+  return best;
+}
+
+WdlScore Tablebase::ProbeWdlTable(const Position& position, const Color side_to_move) const {
+  std::ignore = ColorIndex(side_to_move);
+  if (SyzygyTableName(position) == "KvK") {
+    return WdlScore::kDraw;
+  }
+  const int value = *Layout(position, TablebaseType::kWdl).Probe(position, side_to_move, WdlScore::kDraw);
+  if (value < 0 || value > 4) {
+    ThrowCorrupt();
+  }
+  return static_cast<WdlScore>(value - 2);
+}
+
+// Tables leave out positions where a capture is best, and may store a loss for one where a capture draws. So the true
+// result is the better of the stored value and the best capture, unless every legal move is a capture and the stored
+// value is of no use at all.
+WdlScore Tablebase::Search(const Position& position, const Color side_to_move, const Square en_passant, WdlScore alpha,
+                           const WdlScore beta, const bool pawn_moves, bool& zeroing_best) const {
+  std::vector<Move> moves;
+  GenerateLegalMoves(position, side_to_move, en_passant, {}, moves);
+  WdlScore best = WdlScore::kLoss;
+  size_t searched = 0;
+  for (const Move move : moves) {
+    if (!IsCapture(position, move) && !(pawn_moves && IsZeroing(position, move))) {
+      continue;
+    }
+    searched += 1;
+    const PositionState after = PlayMove(position, side_to_move, en_passant, move);
+    bool ignored = false;
+    const WdlScore value = Negate(Search(after.position, after.side_to_move, after.en_passant, Negate(beta),
+                                         Negate(alpha), false, ignored));
+    if (value > best) {
+      best = value;
+      if (value >= beta) {
+        zeroing_best = true;
+        return value;
+      }
+      alpha = std::max(alpha, value);
+    }
+  }
+
+  const bool only_searched_moves = searched != 0 && searched == moves.size();
+  const WdlScore stored = only_searched_moves ? best : ProbeWdlTable(position, side_to_move);
+  if (best >= stored) {
+    zeroing_best = best > WdlScore::kDraw || only_searched_moves;
+    return best;
+  }
+  zeroing_best = false;
+  return stored;
+}
+
+const Tablebase::TableLayout& Tablebase::Layout(const Position& position, const TablebaseType type) const {
+  const std::span<const std::byte> data = TableData(position, type);
+  const std::string name = SyzygyTableName(position);
+  TableFile& table_file = *(type == TablebaseType::kWdl ? wdl_tables_ : dtz_tables_).at(name);
+  std::call_once(table_file.parsed, [&] {
+    try {
+      table_file.layout = std::make_unique<TableLayout>(name, type, data);
+    } catch (const std::out_of_range&) {
+      // A count in the table sent an index past one of the fixed size tables.
+      ThrowCorrupt();
+    }
+  });
+  return *table_file.layout;
+}
+
+}  // namespace bomchess
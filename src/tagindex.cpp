@@ -0,0 +1,363 @@
+#include "tagindex.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "game.h"
+#include "mappedfile.h"
+#include "pgnscanner.h"
+
+namespace bomchess {
+namespace {
+constexpr std::array<char, 4> kMagic{'B', 'T', 'A', 'G'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kStringColumnCount = 4;
+constexpr std::array<std::string_view, kStringColumnCount> kStringColumnTags{tags::kWhite, tags::kBlack, tags::kEvent,
+                                                                            tags::kECO};
+// Rows are filtered in chunks small enough for their mask to stay in L1 cache.
+constexpr size_t kFilterChunkSize = 4096;
+
+// Section order in the file, string column sections come once per column. Every section starts 8 byte aligned.
+constexpr size_t kOffsetsSection = 0;
+constexpr size_t kWhiteEloSection = 1;
+constexpr size_t kBlackEloSection = 2;
+constexpr size_t kDatesSection = 3;
+constexpr size_t kIdsSection = 4;
+constexpr size_t kDictionaryOffsetsSection = kIdsSection + kStringColumnCount;
+constexpr size_t kDictionaryStringsSection = kDictionaryOffsetsSection + kStringColumnCount;
+constexpr size_t kSectionCount = kDictionaryStringsSection + kStringColumnCount;
+// Never a valid id, dictionaries are far smaller.
+constexpr uint32_t kNoId = std::numeric_limits<uint32_t>::max();
+
+// Native byte order, the columns are used in place.
+struct Header {
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t game_count;
+  std::array<uint64_t, kStringColumnCount> dictionary_sizes;
+  std::array<uint64_t, kSectionCount> section_offsets;
+  std::array<uint64_t, kSectionCount> section_sizes;
+};
+
+uint16_t ParseElo(const std::string_view elo) noexcept {
+  int value = 0;
+  const auto [end, error] = std::from_chars(elo.data(), elo.data() + elo.size(), value);
+  if (error != std::errc{} || end != elo.data() + elo.size() || value < 0 ||
+      value > std::numeric_limits<uint16_t>::max()) {
+    return 0;
+  }
+  return static_cast<uint16_t>(value);
+}
+
+// Assigns ids in order of appearance, then renumbers them in string order once every value is known.
+class DictionaryBuilder {
+ public:
+  uint32_t Add(const std::string_view value) {
+    const auto [entry, inserted] = ids_.try_emplace(std::string(value), static_cast<uint32_t>(values_.size()));
+    if (inserted) {
+      values_.push_back(&entry->first);
+    }
+    return entry->second;
+  }
+
+  // Sorts the dictionary and renumbers the column to match.
+  void Finish(std::vector<uint32_t>& column) {
+    std::vector<uint32_t> order(values_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [this](const uint32_t a, const uint32_t b) { return *values_.at(a) < *values_.at(b); });
+    std::vector<uint32_t> new_ids(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      new_ids.at(order.at(i)) = static_cast<uint32_t>(i);
+    }
+    for (uint32_t& id : column) {
+      id = new_ids[id];
+    }
+    offsets_.assign(1, 0);
+    for (const uint32_t id : order) {
+      strings_ += *values_.at(id);
+      offsets_.push_back(strings_.size());
+    }
+  }
+
+  [[nodiscard]] const std::vector<uint64_t>& Offsets() const noexcept { return offsets_; }
+  [[nodiscard]] const std::string& Strings() const noexcept { return strings_; }
+
+ private:
+  std::unordered_map<std::string, uint32_t> ids_;
+  // Node based map, so pointers to its keys stay valid.
+  std::vector<const std::string*> values_;
+  std::vector<uint64_t> offsets_;
+  std::string strings_;
+};
+
+template <typename T>
+std::span<const T> SectionSpan(const std::span<const std::byte> data, const Header& header, const size_t section) {
+  const uint64_t offset = header.section_offsets.at(section);
+  const uint64_t size = header.section_sizes.at(section);
+  if (offset % alignof(uint64_t) != 0 || offset > data.size() || size > data.size() - offset || size % sizeof(T) != 0) {
+    throw std::runtime_error("Tag index file is corrupt.");
+  }
+  return {reinterpret_cast<const T*>(data.data() + offset), size / sizeof(T)};
+}
+
+// The kernels AND each condition into the chunk's mask without branching, so they vectorize.
+template <typename T>
+void ApplyRange(const std::span<const T> column, const int64_t min, const int64_t max, const std::span<uint8_t> mask) {
+  const int64_t low = std::max<int64_t>(min, std::numeric_limits<T>::min());
+  const int64_t high = std::min<int64_t>(max, std::numeric_limits<T>::max());
+  if (low > high) {
+    std::ranges::fill(mask, 0);
+    return;
+  }
+  const auto typed_low = static_cast<T>(low);
+  const auto typed_high = static_cast<T>(high);
+  for (size_t i = 0; i < mask.size(); ++i) {
+    mask[i] &= static_cast<uint8_t>((column[i] >= typed_low) & (column[i] <= typed_high));
+  }
+}
+
+void ApplyEitherEqual(const std::span<const uint32_t> column_1, const uint32_t id_1,
+                      const std::span<const uint32_t> column_2, const uint32_t id_2, const std::span<uint8_t> mask) {
+  for (size_t i = 0; i < mask.size(); ++i) {
+    mask[i] &= static_cast<uint8_t>((column_1[i] == id_1) | (column_2[i] == id_2));
+  }
+}
+
+template <typename T>
+void WriteSection(std::ofstream& file, Header& header, const size_t section, const std::span<const T> values) {
+  const auto position = static_cast<uint64_t>(file.tellp());
+  const uint64_t padding = (alignof(uint64_t) - position % alignof(uint64_t)) % alignof(uint64_t);
+  file.write(std::string(padding, '\0').data(), static_cast<std::streamsize>(padding));
+  header.section_offsets.at(section) = position + padding;
+  header.section_sizes.at(section) = values.size_bytes();
+  file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+}
+}  // namespace
+
+int32_t ParsePgnDate(const std::string_view date) noexcept {
+  if (date.size() != 10 || date[4] != '.' || date[7] != '.') {
+    return 0;
+  }
+  const auto part = [date](const size_t start, const size_t length) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(date.data() + start, date.data() + start + length, value);
+    return error == std::errc{} && end == date.data() + start + length ? value : 0;
+  };
+  const int year = part(0, 4);
+  if (year == 0) {
+    return 0;
+  }
+  return year * 10000 + part(5, 2) * 100 + part(8, 2);
+}
+
+void BuildTagIndex(const std::string_view pgn, const std::filesystem::path& index_path) {
+  std::vector<uint64_t> offsets;
+  std::vector<uint16_t> white_elo;
+  std::vector<uint16_t> black_elo;
+  std::vector<int32_t> dates;
+  std::array<std::vector<uint32_t>, kStringColumnCount> ids;
+  std::array<DictionaryBuilder, kStringColumnCount> dictionaries;
+
+  PgnScanner scanner(pgn);
+  for (std::optional<LazyPgnGame> game = scanner.Next(); game.has_value(); game = scanner.Next()) {
+    offsets.push_back(game->Offset());
+    white_elo.push_back(ParseElo(game->GetTag(tags::kWhiteElo)));
+    black_elo.push_back(ParseElo(game->GetTag(tags::kBlackElo)));
+    dates.push_back(ParsePgnDate(game->GetTag(tags::kDate)));
+    for (size_t column = 0; column < kStringColumnCount; ++column) {
+      ids.at(column).push_back(dictionaries.at(column).Add(game->GetTag(kStringColumnTags.at(column))));
+    }
+  }
+
+  std::ofstream file(index_path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Could not create tag index file.");
+  }
+  Header header{kMagic, kVersion, offsets.size(), {}, {}, {}};
+  // The header is written again once the sections are placed.
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  WriteSection<uint64_t>(file, header, kOffsetsSection, offsets);
+  WriteSection<uint16_t>(file, header, kWhiteEloSection, white_elo);
+  WriteSection<uint16_t>(file, header, kBlackEloSection, black_elo);
+  WriteSection<int32_t>(file, header, kDatesSection, dates);
+  for (size_t column = 0; column < kStringColumnCount; ++column) {
+    DictionaryBuilder& dictionary = dictionaries.at(column);
+    dictionary.Finish(ids.at(column));
+    header.dictionary_sizes.at(column) = dictionary.Offsets().size() - 1;
+    WriteSection<uint32_t>(file, header, kIdsSection + column, ids.at(column));
+    WriteSection<uint64_t>(file, header, kDictionaryOffsetsSection + column, dictionary.Offsets());
+    WriteSection<char>(file, header, kDictionaryStringsSection + column, dictionary.Strings());
+  }
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.close();
+  if (file.fail()) {
+    throw std::runtime_error("Could not write tag index file.");
+  }
+}
+
+TagIndex::TagIndex(const std::filesystem::path& path) : file_(std::make_unique<MappedFile>(path)) {
+  const std::span<const std::byte> data = file_->Data();
+  Header header{};
+  if (data.size() < sizeof(header)) {
+    throw std::runtime_error("Not a tag index file.");
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion) {
+    throw std::runtime_error("Not a tag index file.");
+  }
+  size_ = header.game_count;
+  offsets_ = SectionSpan<uint64_t>(data, header, kOffsetsSection);
+  white_elo_ = SectionSpan<uint16_t>(data, header, kWhiteEloSection);
+  black_elo_ = SectionSpan<uint16_t>(data, header, kBlackEloSection);
+  dates_ = SectionSpan<int32_t>(data, header, kDatesSection);
+  bool consistent = offsets_.size() == size_ && white_elo_.size() == size_ && black_elo_.size() == size_ &&
+                    dates_.size() == size_;
+  for (size_t column = 0; column < kStringColumnCount; ++column) {
+    ids_.at(column) = SectionSpan<uint32_t>(data, header, kIdsSection + column);
+    Dictionary& dictionary = dictionaries_.at(column);
+    dictionary.offsets = SectionSpan<uint64_t>(data, header, kDictionaryOffsetsSection + column);
+    const std::span<const char> strings = SectionSpan<char>(data, header, kDictionaryStringsSection + column);
+    dictionary.strings = std::string_view(strings.data(), strings.size());
+    const uint64_t dictionary_size = header.dictionary_sizes.at(column);
+    consistent = consistent && ids_.at(column).size() == size_ &&
+                 dictionary.offsets.size() == dictionary_size + 1 && dictionary.offsets.back() == strings.size() &&
+                 std::ranges::is_sorted(dictionary.offsets) &&
+                 std::ranges::all_of(ids_.at(column), [dictionary_size](const uint32_t id) {
+                   return id < dictionary_size;
+                 });
+  }
+  if (!consistent) {
+    throw std::runtime_error("Tag index file is corrupt.");
+  }
+}
+
+size_t TagIndex::Size() const noexcept { return size_; }
+
+std::span<const uint64_t> TagIndex::Offsets() const noexcept { return offsets_; }
+
+std::span<const uint16_t> TagIndex::WhiteElo() const noexcept { return white_elo_; }
+
+std::span<const uint16_t> TagIndex::BlackElo() const noexcept { return black_elo_; }
+
+std::span<const int32_t> TagIndex::Dates() const noexcept { return dates_; }
+
+std::span<const uint32_t> TagIndex::Ids(const TagColumn column) const noexcept {
+  return ids_[std::to_underlying(column)];
+}
+
+std::string_view TagIndex::Value(const TagColumn column, const uint32_t id) const {
+  const Dictionary& dictionary = dictionaries_.at(std::to_underlying(column));
+  if (id + size_t{1} >= dictionary.offsets.size()) {
+    throw std::out_of_range("Id is not in the dictionary.");
+  }
+  const uint64_t start = dictionary.offsets[id];
+  return dictionary.strings.substr(start, dictionary.offsets[id + 1] - start);
+}
+
+std::optional<uint32_t> TagIndex::FindId(const TagColumn column, const std::string_view value) const {
+  const uint32_t id = LowerBound(column, value, false);
+  if (id < DictionarySize(column) && Value(column, id) == value) {
+    return id;
+  }
+  return std::nullopt;
+}
+
+uint32_t TagIndex::DictionarySize(const TagColumn column) const noexcept {
+  return static_cast<uint32_t>(dictionaries_[std::to_underlying(column)].offsets.size() - 1);
+}
+
+// Dictionaries are sorted, so a binary search over the ids finds the value.
+uint32_t TagIndex::LowerBound(const TagColumn column, const std::string_view value, const bool after_equal) const {
+  const auto ids = std::views::iota(uint32_t{0}, DictionarySize(column));
+  return static_cast<uint32_t>(std::ranges::partition_point(ids, [&](const uint32_t id) {
+                                 return after_equal ? Value(column, id) <= value : Value(column, id) < value;
+                               }) -
+                               ids.begin());
+}
+
+std::vector<uint32_t> TagIndex::Filter(const TagFilter& filter) const {
+  // Every string condition becomes a range of ids. A value no game has can't match anything.
+  struct IdCondition {
+    TagColumn column;
+    int64_t min;
+    int64_t max;
+  };
+  std::vector<IdCondition> id_conditions;
+  for (const auto& [column, value] : {std::pair{TagColumn::kWhite, &filter.white},
+                                      std::pair{TagColumn::kBlack, &filter.black},
+                                      std::pair{TagColumn::kEvent, &filter.event}}) {
+    if (value->has_value()) {
+      const std::optional<uint32_t> id = FindId(column, **value);
+      if (!id.has_value()) {
+        return {};
+      }
+      id_conditions.push_back({column, *id, *id});
+    }
+  }
+  if (filter.eco.has_value()) {
+    const int64_t first = LowerBound(TagColumn::kECO, filter.eco->front(), false);
+    const int64_t last = static_cast<int64_t>(LowerBound(TagColumn::kECO, filter.eco->back(), true)) - 1;
+    id_conditions.push_back({TagColumn::kECO, first, last});
+  }
+  // Ids differ between the white and black dictionaries, so the name is looked up in each.
+  uint32_t white_player = kNoId;
+  uint32_t black_player = kNoId;
+  if (filter.player.has_value()) {
+    white_player = FindId(TagColumn::kWhite, *filter.player).value_or(kNoId);
+    black_player = FindId(TagColumn::kBlack, *filter.player).value_or(kNoId);
+    if (white_player == kNoId && black_player == kNoId) {
+      return {};
+    }
+  }
+
+  std::vector<uint32_t> matches;
+  std::array<uint8_t, kFilterChunkSize> mask_storage{};
+  for (size_t start = 0; start < size_; start += kFilterChunkSize) {
+    const size_t count = std::min(kFilterChunkSize, size_ - start);
+    const std::span<uint8_t> mask(mask_storage.data(), count);
+    std::ranges::fill(mask, 1);
+    const auto rows = [start, count](const auto column) { return column.subspan(start, count); };
+    if (filter.white_elo.has_value()) {
+      ApplyRange(rows(white_elo_), filter.white_elo->min, filter.white_elo->max, mask);
+    }
+    if (filter.black_elo.has_value()) {
+      ApplyRange(rows(black_elo_), filter.black_elo->min, filter.black_elo->max, mask);
+    }
+    if (filter.date.has_value()) {
+      ApplyRange(rows(dates_), filter.date->min, filter.date->max, mask);
+    }
+    for (const IdCondition& condition : id_conditions) {
+      ApplyRange(rows(Ids(condition.column)), condition.min, condition.max, mask);
+    }
+    if (filter.player.has_value()) {
+      ApplyEitherEqual(rows(Ids(TagColumn::kWhite)), white_player, rows(Ids(TagColumn::kBlack)), black_player, mask);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (mask[i] != 0) {
+        matches.push_back(static_cast<uint32_t>(start + i));
+      }
+    }
+  }
+  return matches;
+}
+
+}  // namespace bomchess
@@ -0,0 +1,85 @@
+#include "transpositiontable.h"
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "move.h"
+#include "piece.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+constexpr uint64_t kOccupiedBit = uint64_t{1} << 63;
+
+// Layout: from square (7 bits), to square (7), promotion (3), score (16), depth (8), bound (2), occupied (bit 63).
+uint64_t Pack(const TranspositionEntry& entry) {
+  const auto from = static_cast<uint64_t>(std::to_underlying(entry.move.from_square));
+  const auto to = static_cast<uint64_t>(std::to_underlying(entry.move.to_square));
+  const auto promotion = static_cast<uint64_t>(std::to_underlying(entry.move.promotion));
+  if (from > std::to_underlying(Square::kNone) || to > std::to_underlying(Square::kNone) ||
+      promotion > std::to_underlying(PieceType::kNone)) {
+    throw std::invalid_argument("Transposition entry has an invalid move.");
+  }
+  return from | to << 7 | promotion << 14 | uint64_t{std::bit_cast<uint16_t>(entry.score)} << 17 |
+         uint64_t{std::bit_cast<uint8_t>(entry.depth)} << 33 | static_cast<uint64_t>(entry.bound) << 41 |
+         kOccupiedBit;
+}
+
+TranspositionEntry Unpack(const uint64_t data) noexcept {
+  TranspositionEntry entry{};
+  entry.move.from_square = static_cast<Square>(data & 0x7F);
+  entry.move.to_square = static_cast<Square>(data >> 7 & 0x7F);
+  entry.move.promotion = static_cast<PieceType>(data >> 14 & 0x7);
+  entry.score = std::bit_cast<int16_t>(static_cast<uint16_t>(data >> 17 & 0xFFFF));
+  entry.depth = std::bit_cast<int8_t>(static_cast<uint8_t>(data >> 33 & 0xFF));
+  entry.bound = static_cast<Bound>(data >> 41 & 0x3);
+  return entry;
+}
+}  // namespace
+
+TranspositionTable::TranspositionTable(const size_t size_in_megabytes) {
+  const size_t max_entries = size_in_megabytes * 1024 * 1024 / sizeof(Slot);
+  if (max_entries == 0) {
+    throw std::invalid_argument("Transposition table size is too small.");
+  }
+  // A power of two lets the key be masked down to a slot index.
+  entry_count_ = std::bit_floor(max_entries);
+  slots_ = std::make_unique<Slot[]>(entry_count_);
+  Clear();
+}
+
+void TranspositionTable::Store(const uint64_t key, const TranspositionEntry& entry) {
+  const uint64_t data = Pack(entry);
+  Slot& slot = slots_[key & (entry_count_ - 1)];
+  const uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+  const uint64_t old_key = slot.checked_key.load(std::memory_order_relaxed) ^ old_data;
+  if ((old_data & kOccupiedBit) != 0 && old_key == key && Unpack(old_data).depth > entry.depth) {
+    return;
+  }
+  slot.checked_key.store(key ^ data, std::memory_order_relaxed);
+  slot.data.store(data, std::memory_order_relaxed);
+}
+
+std::optional<TranspositionEntry> TranspositionTable::Probe(const uint64_t key) const noexcept {
+  const Slot& slot = slots_[key & (entry_count_ - 1)];
+  const uint64_t data = slot.data.load(std::memory_order_relaxed);
+  if ((data & kOccupiedBit) == 0 || (slot.checked_key.load(std::memory_order_relaxed) ^ data) != key) {
+    return std::nullopt;
+  }
+  return Unpack(data);
+}
+
+void TranspositionTable::Clear() noexcept {
+  for (size_t i = 0; i < entry_count_; ++i) {
+    slots_[i].checked_key.store(0, std::memory_order_relaxed);
+    slots_[i].data.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t TranspositionTable::EntryCount() const noexcept { return entry_count_; }
+
+}  // namespace bomchess
@@ -0,0 +1,379 @@
+#include "uci.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace bomchess {
+namespace {
+constexpr std::string_view kWhitespace = " \t\r\n";
+constexpr std::array<std::string_view, 12> kGoKeywords{
+    "searchmoves", "ponder", "wtime", "btime", "winc", "binc", "movestogo", "depth", "nodes", "mate", "movetime",
+    "infinite"};
+
+// Removes and returns the first token of text. Returns "" once text has no tokens left.
+std::string_view NextToken(std::string_view& text) noexcept {
+  const size_t start = text.find_first_not_of(kWhitespace);
+  if (start == std::string_view::npos) {
+    text = {};
+    return {};
+  }
+  text.remove_prefix(start);
+  const size_t end = std::min(text.find_first_of(kWhitespace), text.size());
+  const std::string_view token = text.substr(0, end);
+  text.remove_prefix(end);
+  return token;
+}
+
+std::vector<std::string_view> Tokenize(std::string_view text) {
+  std::vector<std::string_view> tokens;
+  for (std::string_view token = NextToken(text); !token.empty(); token = NextToken(text)) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+std::string JoinTokens(const std::span<const std::string_view> tokens) {
+  std::string joined;
+  for (const std::string_view token : tokens) {
+    if (!joined.empty()) {
+      joined += ' ';
+    }
+    joined += token;
+  }
+  return joined;
+}
+
+constexpr std::string_view kUciNullMove = "0000";
+
+Move ParseMove(const std::string_view token) { return token == kUciNullMove ? kNullMove : FromUCI(token); }
+
+std::string MoveString(const Move move) { return move == kNullMove ? std::string(kUciNullMove) : ToUCI(move); }
+
+std::vector<Move> ParseMoves(const std::span<const std::string_view> tokens) {
+  std::vector<Move> moves;
+  moves.reserve(tokens.size());
+  for (const std::string_view token : tokens) {
+    moves.push_back(ParseMove(token));
+  }
+  return moves;
+}
+
+std::optional<int64_t> ParseInteger(const std::string_view token) noexcept {
+  int64_t value = 0;
+  const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+  if (error != std::errc() || end != token.data() + token.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+bool IsGoKeyword(const std::string_view token) noexcept {
+  return std::ranges::find(kGoKeywords, token) != kGoKeywords.end();
+}
+
+Position ParsePiecePlacement(const std::string_view placement) {
+  Position position;
+  // FEN lists the ranks from the 8th down, which is the order of the squares.
+  size_t square = 0;
+  size_t rank_end = 8;
+  for (const char symbol : placement) {
+    if (symbol == '/') {
+      if (square != rank_end) {
+        throw std::invalid_argument("FEN rank does not have 8 squares.");
+      }
+      rank_end += 8;
+    } else if (symbol >= '1' && symbol <= '8') {
+      square += static_cast<size_t>(symbol - '0');
+    } else if (square < rank_end) {
+      position.at(static_cast<Square>(square)) = PieceFromString(std::string_view(&symbol, 1));
+      square += 1;
+    } else {
+      throw std::invalid_argument("FEN rank does not have 8 squares.");
+    }
+    if (square > rank_end) {
+      throw std::invalid_argument("FEN rank does not have 8 squares.");
+    }
+  }
+  if (square != 64 || rank_end != 64) {
+    throw std::invalid_argument("FEN does not have 8 ranks.");
+  }
+  return position;
+}
+
+std::array<CastlingRights, 2> ParseCastling(const std::string_view castling) {
+  std::array<CastlingRights, 2> rights{};
+  if (castling == "-") {
+    return rights;
+  }
+  for (const char symbol : castling) {
+    switch (symbol) {
+      case 'K':
+        rights.at(ColorIndex(Color::kWhite)).king_side = true;
+        break;
+      case 'Q':
+        rights.at(ColorIndex(Color::kWhite)).queen_side = true;
+        break;
+      case 'k':
+        rights.at(ColorIndex(Color::kBlack)).king_side = true;
+        break;
+      case 'q':
+        rights.at(ColorIndex(Color::kBlack)).queen_side = true;
+        break;
+      default:
+        throw std::invalid_argument("Invalid FEN castling rights.");
+    }
+  }
+  return rights;
+}
+}  // namespace
+
+PositionState ParseFen(const std::string_view fen) {
+  const std::vector<std::string_view> fields = Tokenize(fen);
+  if (fields.size() != 4 && fields.size() != 6) {
+    throw std::invalid_argument("FEN must have 4 or 6 fields.");
+  }
+  PositionState state;
+  state.position = ParsePiecePlacement(fields.at(0));
+  if (fields.at(1) == "w") {
+    state.side_to_move = Color::kWhite;
+  } else if (fields.at(1) == "b") {
+    state.side_to_move = Color::kBlack;
+  } else {
+    throw std::invalid_argument("Invalid FEN side to move.");
+  }
+  state.castling = ParseCastling(fields.at(2));
+  if (fields.at(3) != "-") {
+    if (fields.at(3).size() != 2) {
+      throw std::invalid_argument("Invalid FEN en passant square.");
+    }
+    state.en_passant = SquareFromFileRank(fields.at(3).at(0), fields.at(3).at(1));
+  }
+  if (fields.size() == 6) {
+    const std::optional<int64_t> move_number = ParseInteger(fields.at(5));
+    if (!ParseInteger(fields.at(4)).has_value() || !move_number.has_value() || *move_number < 1 ||
+        *move_number > std::numeric_limits<uint16_t>::max() / 2) {
+      throw std::invalid_argument("Invalid FEN move counters.");
+    }
+    state.ply = static_cast<uint16_t>((*move_number - 1) * 2 + (state.side_to_move == Color::kBlack ? 1 : 0));
+  }
+  return state;
+}
+
+UciSession::UciSession(std::istream& input, std::ostream& output, UciCallbacks callbacks, std::string engine_name,
+                       std::string engine_author)
+    : input_(input),
+      output_(output),
+      callbacks_(std::move(callbacks)),
+      engine_name_(std::move(engine_name)),
+      engine_author_(std::move(engine_author)) {}
+
+UciSession::~UciSession() { Join(); }
+
+void UciSession::Start() {
+  if (input_thread_.joinable()) {
+    throw std::logic_error("UCI session was already started.");
+  }
+  input_thread_ = std::thread([this] {
+    std::string line;
+    while (std::getline(input_, line)) {
+      try {
+        if (!HandleCommand(line)) {
+          return;
+        }
+      } catch (const std::invalid_argument& error) {
+        SendInfo(std::string("string ") + error.what());
+      }
+    }
+  });
+}
+
+void UciSession::Join() {
+  if (input_thread_.joinable()) {
+    input_thread_.join();
+  }
+}
+
+bool UciSession::HandleCommand(std::string_view line) {
+  // Unknown tokens are skipped until a known command is found, as the protocol requires.
+  for (std::string_view command = NextToken(line); !command.empty(); command = NextToken(line)) {
+    if (command == "uci") {
+      Send("id name " + engine_name_);
+      Send("id author " + engine_author_);
+      Send("uciok");
+    } else if (command == "isready") {
+      Send("readyok");
+    } else if (command == "ucinewgame") {
+      position_arguments_.clear();
+      if (callbacks_.new_game) {
+        callbacks_.new_game();
+      }
+    } else if (command == "position") {
+      HandlePosition(line);
+    } else if (command == "go") {
+      HandleGo(line);
+    } else if (command == "stop") {
+      if (callbacks_.stop) {
+        callbacks_.stop();
+      }
+    } else if (command == "ponderhit") {
+      if (callbacks_.ponder_hit) {
+        callbacks_.ponder_hit();
+      }
+    } else if (command == "setoption") {
+      HandleSetOption(line);
+    } else if (command == "quit") {
+      if (callbacks_.stop) {
+        callbacks_.stop();
+      }
+      return false;
+    } else if (command != "debug" && command != "register") {
+      continue;
+    }
+    return true;
+  }
+  return true;
+}
+
+void UciSession::SendBestMove(const Move best_move, const std::optional<Move> ponder_move) {
+  std::string line = "bestmove " + MoveString(best_move);
+  if (ponder_move.has_value()) {
+    line += " ponder " + MoveString(*ponder_move);
+  }
+  Send(line);
+}
+
+void UciSession::SendInfo(const std::string_view info) { Send("info " + std::string(info)); }
+
+void UciSession::Send(const std::string_view line) {
+  const std::scoped_lock lock(output_mutex_);
+  output_ << line << '\n' << std::flush;
+}
+
+void UciSession::HandlePosition(const std::string_view arguments) {
+  const std::vector<std::string_view> tokens = Tokenize(arguments);
+  std::string normalized_arguments = JoinTokens(tokens);
+
+  // GUIs resend the whole game every ply. If only moves were appended, only those moves are parsed and played.
+  if (!position_arguments_.empty() && normalized_arguments.starts_with(position_arguments_) &&
+      (normalized_arguments.size() == position_arguments_.size() ||
+       normalized_arguments.at(position_arguments_.size()) == ' ')) {
+    std::vector<std::string_view> appended_tokens =
+        Tokenize(std::string_view(normalized_arguments).substr(position_arguments_.size()));
+    if (!appended_tokens.empty() && appended_tokens.front() == "moves") {
+      appended_tokens.erase(appended_tokens.begin());
+    }
+    std::vector<Move> appended_moves;
+    try {
+      appended_moves = ParseMoves(appended_tokens);
+    } catch (const std::invalid_argument&) {
+      position_arguments_.clear();
+      throw;
+    }
+    position_arguments_ = std::move(normalized_arguments);
+    if (callbacks_.position) {
+      callbacks_.position(fen_, appended_moves, false);
+    }
+    return;
+  }
+
+  position_arguments_.clear();
+  const auto moves_token = std::ranges::find(tokens, "moves");
+  if (!tokens.empty() && tokens.front() == "startpos") {
+    fen_ = kUciStartPosition;
+  } else if (!tokens.empty() && tokens.front() == "fen") {
+    fen_ = JoinTokens(std::span(tokens.begin() + 1, moves_token));
+  } else {
+    throw std::invalid_argument("Position command must start with startpos or fen.");
+  }
+  std::vector<Move> moves;
+  if (moves_token != tokens.end()) {
+    moves = ParseMoves(std::span(moves_token + 1, tokens.end()));
+  }
+  position_arguments_ = std::move(normalized_arguments);
+  if (callbacks_.position) {
+    callbacks_.position(fen_, moves, true);
+  }
+}
+
+void UciSession::HandleGo(std::string_view arguments) {
+  GoParameters parameters;
+  std::string_view keyword = NextToken(arguments);
+  while (!keyword.empty()) {
+    if (keyword == "searchmoves") {
+      std::string_view token = NextToken(arguments);
+      for (; !token.empty() && !IsGoKeyword(token); token = NextToken(arguments)) {
+        parameters.search_moves.push_back(FromUCI(token));
+      }
+      keyword = token;
+      continue;
+    }
+    if (keyword == "ponder") {
+      parameters.ponder = true;
+    } else if (keyword == "infinite") {
+      parameters.infinite = true;
+    } else {
+      const std::optional<int64_t> value = ParseInteger(NextToken(arguments));
+      if (keyword == "wtime") {
+        parameters.white_time = value;
+      } else if (keyword == "btime") {
+        parameters.black_time = value;
+      } else if (keyword == "winc") {
+        parameters.white_increment = value;
+      } else if (keyword == "binc") {
+        parameters.black_increment = value;
+      } else if (keyword == "movestogo") {
+        parameters.moves_to_go = value;
+      } else if (keyword == "depth") {
+        parameters.depth = value;
+      } else if (keyword == "nodes") {
+        parameters.nodes = value;
+      } else if (keyword == "mate") {
+        parameters.mate = value;
+      } else if (keyword == "movetime") {
+        parameters.move_time = value;
+      }
+    }
+    keyword = NextToken(arguments);
+  }
+  if (callbacks_.go) {
+    callbacks_.go(parameters);
+  }
+}
+
+void UciSession::HandleSetOption(const std::string_view arguments) {
+  const std::vector<std::string_view> tokens = Tokenize(arguments);
+  if (tokens.empty() || tokens.front() != "name") {
+    return;
+  }
+  const auto value_token = std::ranges::find(tokens, "value");
+  const std::string name = JoinTokens(std::span(tokens.begin() + 1, value_token));
+  std::string value;
+  if (value_token != tokens.end()) {
+    value = JoinTokens(std::span(value_token + 1, tokens.end()));
+  }
+  if (callbacks_.set_option) {
+    callbacks_.set_option(name, value);
+  }
+}
+
+}  // namespace bomchess
@@ -0,0 +1,95 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <bit>
+#include <stdexcept>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "bitboard.h"
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+namespace {
+bomchess::Bitboard MakeBitboard(const std::vector<bomchess::Square>& squares) {
+  bomchess::Bitboard bitboard = bomchess::kEmptyBitboard;
+  for (const bomchess::Square square : squares) {
+    bitboard |= bomchess::SquareBitboard(square);
+  }
+  return bitboard;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SquareBitboard) {
+  BOOST_CHECK_EQUAL(bomchess::SquareBitboard(bomchess::Square::kA8), 1);
+  BOOST_CHECK_EQUAL(bomchess::SquareBitboard(bomchess::Square::kH1), bomchess::Bitboard{1} << 63);
+  BOOST_CHECK(bomchess::LowestSquare(bomchess::SquareBitboard(bomchess::Square::kE4)) == bomchess::Square::kE4);
+  BOOST_CHECK_THROW(std::ignore = bomchess::SquareBitboard(bomchess::Square::kNone), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::LowestSquare(bomchess::kEmptyBitboard), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(LeaperAttacks) {
+  using bomchess::Square;
+  BOOST_CHECK_EQUAL(bomchess::KnightAttacks(Square::kA1), MakeBitboard({Square::kB3, Square::kC2}));
+  BOOST_CHECK_EQUAL(std::popcount(bomchess::KnightAttacks(Square::kE4)), 8);
+  BOOST_CHECK_EQUAL(bomchess::KingAttacks(Square::kH8), MakeBitboard({Square::kG8, Square::kG7, Square::kH7}));
+  BOOST_CHECK_EQUAL(bomchess::PawnAttacks(bomchess::Color::kWhite, Square::kE4),
+                    MakeBitboard({Square::kD5, Square::kF5}));
+  BOOST_CHECK_EQUAL(bomchess::PawnAttacks(bomchess::Color::kBlack, Square::kA5), MakeBitboard({Square::kB4}));
+  BOOST_CHECK_EQUAL(bomchess::PawnAttacks(bomchess::Color::kWhite, Square::kC8), bomchess::kEmptyBitboard);
+  BOOST_CHECK_THROW(std::ignore = bomchess::PawnAttacks(bomchess::Color::kNone, Square::kE4), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(SliderAttacks) {
+  using bomchess::Square;
+  const bomchess::Bitboard occupied = MakeBitboard({Square::kD6, Square::kF4, Square::kD2, Square::kB4});
+  BOOST_CHECK_EQUAL(bomchess::RookAttacks(Square::kD4, occupied),
+                    MakeBitboard({Square::kD5, Square::kD6, Square::kE4, Square::kF4, Square::kD3, Square::kD2,
+                                  Square::kC4, Square::kB4}));
+  BOOST_CHECK_EQUAL(bomchess::BishopAttacks(Square::kA1, occupied),
+                    MakeBitboard({Square::kB2, Square::kC3, Square::kD4, Square::kE5, Square::kF6, Square::kG7,
+                                  Square::kH8}));
+  BOOST_CHECK_EQUAL(bomchess::QueenAttacks(Square::kD4, occupied),
+                    bomchess::RookAttacks(Square::kD4, occupied) | bomchess::BishopAttacks(Square::kD4, occupied));
+  BOOST_CHECK_EQUAL(std::popcount(bomchess::RookAttacks(Square::kH1, bomchess::kEmptyBitboard)), 14);
+}
+
+BOOST_AUTO_TEST_CASE(PositionBitboardsAttackersTo) {
+  using bomchess::Square;
+  bomchess::Position position;
+  position.at(Square::kE1) = bomchess::pieces::kWhiteRook;
+  position.at(Square::kE2) = bomchess::pieces::kWhiteQueen;
+  position.at(Square::kD4) = bomchess::pieces::kWhitePawn;
+  position.at(Square::kF6) = bomchess::pieces::kBlackKnight;
+  position.at(Square::kD6) = bomchess::pieces::kBlackPawn;
+  position.at(Square::kE5) = bomchess::pieces::kBlackPawn;
+  const bomchess::PositionBitboards bitboards = bomchess::MakeBitboards(position);
+  BOOST_CHECK_EQUAL(bitboards.Pieces(bomchess::pieces::kBlackPawn), MakeBitboard({Square::kD6, Square::kE5}));
+  BOOST_CHECK_EQUAL(bitboards.Pieces(bomchess::Color::kWhite), MakeBitboard({Square::kE1, Square::kE2, Square::kD4}));
+  BOOST_CHECK_EQUAL(std::popcount(bitboards.Occupied()), 6);
+
+  const bomchess::Bitboard attackers = bomchess::AttackersTo(bitboards, Square::kE5, bitboards.Occupied());
+  BOOST_CHECK_EQUAL(attackers, MakeBitboard({Square::kE2, Square::kD4, Square::kD6}));
+  // With the queen gone the rook behind it attacks the square.
+  const bomchess::Bitboard occupied = bitboards.Occupied() & ~bomchess::SquareBitboard(Square::kE2);
+  BOOST_CHECK_EQUAL(bomchess::AttackersTo(bitboards, Square::kE5, occupied) & occupied,
+                    MakeBitboard({Square::kE1, Square::kD4, Square::kD6}));
+  BOOST_CHECK_EQUAL(bomchess::AttackersTo(bitboards, Square::kG4, bitboards.Occupied()),
+                    MakeBitboard({Square::kF6, Square::kE2}));
+}
+
+BOOST_AUTO_TEST_CASE(BitboardSpreads) {
+  using bomchess::Square;
+  for (const Square square : bomchess::kAllSquares) {
+    const bomchess::Bitboard bit = bomchess::SquareBitboard(square);
+    BOOST_CHECK_EQUAL(bomchess::KnightSpread(bit), bomchess::KnightAttacks(square));
+    BOOST_CHECK_EQUAL(bomchess::KingSpread(bit), bomchess::KingAttacks(square));
+    BOOST_CHECK_EQUAL(bomchess::PawnAttackerSquares(bit, bomchess::Color::kWhite),
+                      bomchess::PawnAttacks(bomchess::Color::kBlack, square));
+  }
+  BOOST_CHECK_EQUAL(bomchess::East(bomchess::kFileH), bomchess::kEmptyBitboard);
+  BOOST_CHECK_EQUAL(bomchess::North(bomchess::kRank8), bomchess::kEmptyBitboard);
+  BOOST_CHECK_EQUAL(bomchess::West(bomchess::kFileB), bomchess::kFileA);
+}
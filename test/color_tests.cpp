@@ -1,6 +1,8 @@
 #define BOOST_TEST_MODULE "bomchess"
 
 #include <sstream>
+#include <stdexcept>
+#include <tuple>
 
 #include "boost/test/unit_test.hpp"
 
@@ -22,4 +24,9 @@ BOOST_AUTO_TEST_CASE(ColorOstream) {
   string_stream.str("");
   string_stream << static_cast<bomchess::Color>(99);
   BOOST_CHECK_EQUAL(string_stream.str(), "NONE");
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(ColorIndex) {
+  BOOST_CHECK_EQUAL(bomchess::ColorIndex(bomchess::Color::kWhite), 0);
+  BOOST_CHECK_EQUAL(bomchess::ColorIndex(bomchess::Color::kBlack), 1);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ColorIndex(bomchess::Color::kNone), std::invalid_argument);
+}
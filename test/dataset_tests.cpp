@@ -0,0 +1,174 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "dataset.h"
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "test_positions.h"
+
+namespace {
+bomchess::PositionState StartingState() {
+  bomchess::PositionState state;
+  state.position = bomchess::testing::StartingPosition();
+  state.castling = {bomchess::CastlingRights{true, true}, bomchess::CastlingRights{true, true}};
+  return state;
+}
+
+std::vector<bomchess::Move> ParseMoves(const std::vector<std::string>& uci_moves) {
+  std::vector<bomchess::Move> moves;
+  for (const std::string& uci_move : uci_moves) {
+    moves.push_back(bomchess::FromUCI(uci_move));
+  }
+  return moves;
+}
+
+struct TestGame {
+  bomchess::PositionState start;
+  std::vector<bomchess::Move> moves;
+  bomchess::GameResult result;
+};
+
+std::vector<TestGame> MakeGames() {
+  std::vector<TestGame> games;
+  // Castling on both sides, then a rook leaves its corner.
+  games.push_back({StartingState(),
+                   ParseMoves({"e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "d7d6", "e1g1", "c8g4", "d2d3", "d8d7", "b1c3",
+                               "e8c8", "a2a3", "h8g8"}),
+                   bomchess::GameResult::kWhiteWins});
+  // En passant.
+  games.push_back(
+      {StartingState(), ParseMoves({"e2e4", "a7a6", "e4e5", "d7d5", "e5d6", "c7d6"}), bomchess::GameResult::kDraw});
+  // A promotion from a later start, black to move.
+  bomchess::PositionState endgame;
+  endgame.position.at(bomchess::Square::kE1) = bomchess::pieces::kWhiteKing;
+  endgame.position.at(bomchess::Square::kB7) = bomchess::pieces::kWhitePawn;
+  endgame.position.at(bomchess::Square::kE8) = bomchess::pieces::kBlackKing;
+  endgame.position.at(bomchess::Square::kH2) = bomchess::pieces::kBlackPawn;
+  endgame.side_to_move = bomchess::Color::kBlack;
+  endgame.ply = 81;
+  games.push_back({endgame, ParseMoves({"h2h1q", "b7b8n", "h1e4"}), bomchess::GameResult::kBlackWins});
+  // Long enough to span a block boundary.
+  std::vector<std::string> shuffle;
+  for (int i = 0; i < 400; ++i) {
+    shuffle.insert(shuffle.end(), {"g1f3", "g8f6", "f3g1", "f6g8"});
+  }
+  games.push_back({StartingState(), ParseMoves(shuffle), bomchess::GameResult::kUnknown});
+  return games;
+}
+
+std::vector<bomchess::TrainingRecord> ExpectedRecords(const std::vector<TestGame>& games) {
+  std::vector<bomchess::TrainingRecord> records;
+  for (const TestGame& game : games) {
+    bomchess::PositionState state = game.start;
+    for (const bomchess::Move move : game.moves) {
+      records.push_back({state, move, game.result});
+      bomchess::AdvanceState(state, move);
+    }
+  }
+  return records;
+}
+
+std::filesystem::path WriteDataset(const std::vector<TestGame>& games) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bomchess_dataset_tests.bpds";
+  bomchess::DatasetWriter writer(path);
+  for (const TestGame& game : games) {
+    writer.AddGame(game.start, game.moves, game.result);
+  }
+  writer.Close();
+  return path;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(AdvanceStateTracksState) {
+  bomchess::PositionState state = StartingState();
+  for (const std::string move : {"e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "g8f6"}) {
+    bomchess::AdvanceState(state, bomchess::FromUCI(move));
+  }
+  BOOST_CHECK(state.en_passant == bomchess::Square::kNone);
+  bomchess::AdvanceState(state, bomchess::FromUCI("e1g1"));
+  BOOST_CHECK(state.position.at(bomchess::Square::kF1) == bomchess::pieces::kWhiteRook);
+  BOOST_CHECK(!state.castling.front().king_side && !state.castling.front().queen_side);
+  BOOST_CHECK(state.castling.back().king_side && state.castling.back().queen_side);
+  bomchess::AdvanceState(state, bomchess::FromUCI("d7d5"));
+  BOOST_CHECK(state.en_passant == bomchess::Square::kD6);
+  BOOST_CHECK(state.side_to_move == bomchess::Color::kWhite);
+  BOOST_CHECK_EQUAL(state.ply, 8);
+  bomchess::AdvanceState(state, bomchess::FromUCI("c4d5"));
+  bomchess::AdvanceState(state, bomchess::FromUCI("h8g8"));
+  BOOST_CHECK(!state.castling.back().king_side && state.castling.back().queen_side);
+
+  BOOST_CHECK_THROW(bomchess::AdvanceState(state, bomchess::FromUCI("e5e4")), std::invalid_argument);
+  BOOST_CHECK_THROW(bomchess::AdvanceState(state, bomchess::FromUCI("a3a4")), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(DatasetRoundTrip) {
+  const std::vector<TestGame> games = MakeGames();
+  const std::vector<bomchess::TrainingRecord> expected = ExpectedRecords(games);
+  bomchess::DatasetReader reader(WriteDataset(games));
+  BOOST_REQUIRE_EQUAL(reader.Size(), expected.size());
+  BOOST_CHECK_EQUAL(reader.BlockCount(), 2);
+  for (uint64_t i = 0; i < reader.Size(); ++i) {
+    BOOST_CHECK(reader.Read(i) == expected.at(i));
+  }
+  const std::span<const bomchess::TrainingRecord> last_block = reader.ReadBlock(1);
+  BOOST_CHECK_EQUAL(last_block.size(), expected.size() - bomchess::DatasetWriter::kRecordsPerBlock);
+  BOOST_CHECK(last_block.front() == expected.at(bomchess::DatasetWriter::kRecordsPerBlock));
+}
+
+BOOST_AUTO_TEST_CASE(DatasetRandomAccess) {
+  const std::vector<TestGame> games = MakeGames();
+  const std::vector<bomchess::TrainingRecord> expected = ExpectedRecords(games);
+  bomchess::DatasetReader reader(WriteDataset(games));
+  for (const uint64_t i : {1500UL, 3UL, 1023UL, 1024UL, 0UL, 1600UL, 20UL}) {
+    BOOST_CHECK(reader.Read(i) == expected.at(i));
+  }
+  BOOST_CHECK_THROW(std::ignore = reader.Read(reader.Size()), std::out_of_range);
+  BOOST_CHECK_THROW(std::ignore = reader.ReadBlock(2), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(DatasetBlocksAreAligned) {
+  const std::filesystem::path path = WriteDataset(MakeGames());
+  std::ifstream file(path, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  // Every block starts with a keyframe, whose move has the top bit set.
+  for (const size_t block_offset : {bomchess::kDatasetBlockAlignment, 2 * bomchess::kDatasetBlockAlignment}) {
+    BOOST_REQUIRE_GT(bytes.size(), block_offset + 1);
+    BOOST_CHECK((static_cast<uint8_t>(bytes.at(block_offset + 1)) & 0x80) != 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DatasetEmpty) {
+  bomchess::DatasetReader reader(WriteDataset({}));
+  BOOST_CHECK_EQUAL(reader.Size(), 0);
+  BOOST_CHECK_EQUAL(reader.BlockCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DatasetThrows) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bomchess_dataset_bad.bpds";
+  {
+    bomchess::DatasetWriter writer(path);
+    // The illegal game is rejected whole.
+    BOOST_CHECK_THROW(writer.AddGame(StartingState(), ParseMoves({"e2e4", "e2e4"}), bomchess::GameResult::kDraw),
+                      std::invalid_argument);
+    writer.AddGame(StartingState(), ParseMoves({"d2d4"}), bomchess::GameResult::kDraw);
+    writer.Close();
+    BOOST_CHECK_THROW(writer.AddGame(StartingState(), ParseMoves({"d2d4"}), bomchess::GameResult::kDraw),
+                      std::runtime_error);
+  }
+  BOOST_CHECK_EQUAL(bomchess::DatasetReader(path).Size(), 1);
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  BOOST_CHECK_THROW(bomchess::DatasetReader{path}, std::runtime_error);
+  BOOST_CHECK_THROW(bomchess::DatasetReader{"missing_dataset.bpds"}, std::runtime_error);
+}
@@ -0,0 +1,136 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "dedup.h"
+#include "game.h"
+#include "move.h"
+
+namespace {
+const std::vector<bomchess::Move> kMoves{bomchess::FromUCI("e2e4"), bomchess::FromUCI("e7e5"),
+                                         bomchess::FromUCI("g1f3"), bomchess::FromUCI("b8c6")};
+
+bomchess::TagPairs MakeTags(const std::string& white, const std::string& date, const std::string& result) {
+  bomchess::TagPairs tags;
+  tags.Set(bomchess::tags::kEvent, "Some Event");
+  tags.Set(bomchess::tags::kWhite, white);
+  tags.Set(bomchess::tags::kBlack, "Spassky, Boris V.");
+  tags.Set(bomchess::tags::kDate, date);
+  tags.Set(bomchess::tags::kResult, result);
+  return tags;
+}
+
+std::vector<bomchess::GameFingerprint> RandomFingerprints(const size_t count, const uint64_t seed) {
+  std::mt19937_64 random(seed);
+  std::vector<bomchess::GameFingerprint> fingerprints;
+  for (size_t i = 0; i < count; ++i) {
+    fingerprints.push_back({random(), random()});
+  }
+  return fingerprints;
+}
+
+std::filesystem::path MakeDirectory() {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "bomchess_dedup_tests";
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(FingerprintNearDuplicates) {
+  const bomchess::GameFingerprint original =
+      bomchess::Fingerprint(kMoves, MakeTags("Fischer, Robert J.", "1992.11.04", "1-0"));
+  // Whitespace, case and the result don't matter.
+  BOOST_CHECK(bomchess::Fingerprint(kMoves, MakeTags("  fischer,   Robert J. ", "1992.11.04", "*")) == original);
+  BOOST_CHECK(bomchess::Fingerprint(kMoves, MakeTags("Fischer,\tRobert J.", "1992.11.04", "")) == original);
+
+  const bomchess::GameFingerprint unknown_date = bomchess::Fingerprint(kMoves, MakeTags("Fischer", "????.??.??", "*"));
+  BOOST_CHECK(bomchess::Fingerprint(kMoves, MakeTags("Fischer", "", "*")) == unknown_date);
+
+  // The moves, their order and the players do.
+  BOOST_CHECK(bomchess::Fingerprint(std::span(kMoves).first(3), MakeTags("Fischer, Robert J.", "1992.11.04", "1-0")) !=
+              original);
+  const std::vector<bomchess::Move> transposed{kMoves.at(2), kMoves.at(1), kMoves.at(0), kMoves.at(3)};
+  BOOST_CHECK(bomchess::Fingerprint(transposed, MakeTags("Fischer, Robert J.", "1992.11.04", "1-0")) != original);
+  BOOST_CHECK(bomchess::Fingerprint(kMoves, MakeTags("Fischer, Robert", "1992.11.04", "1-0")) != original);
+  BOOST_CHECK(bomchess::Fingerprint(kMoves, MakeTags("Fischer, Robert J.", "1992.11.05", "1-0")) != original);
+
+  // Streaming the moves in gives the same fingerprint.
+  bomchess::GameFingerprinter fingerprinter;
+  for (const bomchess::Move move : kMoves) {
+    fingerprinter.AddMove(move);
+  }
+  BOOST_CHECK(fingerprinter.Finish(MakeTags("Fischer, Robert J.", "1992.11.04", "1-0")) == original);
+  BOOST_CHECK_THROW(fingerprinter.AddMove({bomchess::Square::kNone, bomchess::Square::kA1, bomchess::PieceType::kNone}),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateFilterInsert) {
+  const std::filesystem::path directory = MakeDirectory();
+  const std::vector<bomchess::GameFingerprint> first = RandomFingerprints(20000, 1);
+  const std::vector<bomchess::GameFingerprint> second = RandomFingerprints(5000, 2);
+  {
+    // A small Bloom filter and frequent flushes, so lookups go to the shard files.
+    bomchess::DuplicateFilter filter(directory, 1000, 3000);
+    for (const bomchess::GameFingerprint& fingerprint : first) {
+      BOOST_CHECK(filter.Insert(fingerprint));
+    }
+    for (const bomchess::GameFingerprint& fingerprint : first) {
+      BOOST_CHECK(!filter.Insert(fingerprint));
+    }
+    BOOST_CHECK_EQUAL(filter.Size(), first.size());
+  }
+  {
+    // A later run over another source sees everything the first run stored.
+    bomchess::DuplicateFilter filter(directory, 30000);
+    BOOST_CHECK_EQUAL(filter.Size(), first.size());
+    for (const bomchess::GameFingerprint& fingerprint : first) {
+      BOOST_CHECK(filter.Contains(fingerprint));
+    }
+    for (const bomchess::GameFingerprint& fingerprint : second) {
+      BOOST_CHECK(!filter.Contains(fingerprint));
+      BOOST_CHECK(filter.Insert(fingerprint));
+      BOOST_CHECK(!filter.Insert(fingerprint));
+    }
+    filter.Flush();
+    BOOST_CHECK_EQUAL(filter.Size(), first.size() + second.size());
+  }
+  std::filesystem::remove_all(directory);
+}
+
+// Shards grow past one index block over several flushes, and the index built while merging finds every fingerprint.
+BOOST_AUTO_TEST_CASE(DuplicateFilterFlushesIndex) {
+  const std::filesystem::path directory = MakeDirectory();
+  const std::vector<bomchess::GameFingerprint> stored = RandomFingerprints(80000, 3);
+  const std::vector<bomchess::GameFingerprint> absent = RandomFingerprints(1000, 4);
+  bomchess::DuplicateFilter filter(directory, 1000, 20000);
+  for (const bomchess::GameFingerprint& fingerprint : stored) {
+    BOOST_REQUIRE(filter.Insert(fingerprint));
+  }
+  filter.Flush();
+  BOOST_CHECK_EQUAL(filter.Size(), stored.size());
+  for (const bomchess::GameFingerprint& fingerprint : stored) {
+    BOOST_REQUIRE(filter.Contains(fingerprint));
+  }
+  for (const bomchess::GameFingerprint& fingerprint : absent) {
+    BOOST_CHECK(!filter.Contains(fingerprint));
+  }
+  std::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateFilterThrows) {
+  const std::filesystem::path directory = MakeDirectory();
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "shard_00.bin", std::ios::binary) << "truncated";
+  BOOST_CHECK_THROW(bomchess::DuplicateFilter(directory, 10), std::runtime_error);
+  std::filesystem::remove_all(directory);
+  std::ofstream(directory, std::ios::binary) << "a file";
+  BOOST_CHECK_THROW(bomchess::DuplicateFilter(directory, 10), std::runtime_error);
+  std::filesystem::remove(directory);
+}
@@ -0,0 +1,122 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "boost/test/unit_test.hpp"
+
+#include "game.h"
+
+BOOST_AUTO_TEST_CASE(TagPairsEmpty) {
+  const bomchess::TagPairs tag_pairs;
+  for (const std::string_view tag : bomchess::tags::kSevenTagRoster) {
+    BOOST_CHECK_EQUAL(tag_pairs.Get(tag), "");
+  }
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kWhiteElo), "");
+  BOOST_CHECK(tag_pairs.SupplementalTags().empty());
+}
+
+BOOST_AUTO_TEST_CASE(TagPairsSetRoster) {
+  bomchess::TagPairs tag_pairs;
+  tag_pairs.Set(bomchess::tags::kEvent, "F/S Return Match");
+  tag_pairs.Set(bomchess::tags::kResult, "1/2-1/2");
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kEvent), "F/S Return Match");
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kResult), "1/2-1/2");
+  BOOST_CHECK(tag_pairs.SupplementalTags().empty());
+
+  tag_pairs.Set(bomchess::tags::kResult, "1-0");
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kResult), "1-0");
+}
+
+BOOST_AUTO_TEST_CASE(TagPairsSetSupplemental) {
+  bomchess::TagPairs tag_pairs;
+  tag_pairs.Set(bomchess::tags::kWhiteElo, "2785");
+  tag_pairs.Set("CustomTag", "Custom Value");
+  tag_pairs.Set(bomchess::tags::kECO, "B90");
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kWhiteElo), "2785");
+  BOOST_CHECK_EQUAL(tag_pairs.Get("CustomTag"), "Custom Value");
+  BOOST_REQUIRE_EQUAL(tag_pairs.SupplementalTags().size(), 3);
+  BOOST_CHECK_EQUAL(tag_pairs.SupplementalTags()[2].name, "ECO");
+
+  tag_pairs.Set(bomchess::tags::kWhiteElo, "2800");
+  BOOST_CHECK_EQUAL(tag_pairs.Get(bomchess::tags::kWhiteElo), "2800");
+  BOOST_CHECK_EQUAL(tag_pairs.SupplementalTags()[0].value, "2800");
+
+  tag_pairs.Set("CustomTag", "");
+  BOOST_CHECK_EQUAL(tag_pairs.Get("CustomTag"), "");
+  BOOST_CHECK_EQUAL(tag_pairs.SupplementalTags().size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TagPairsUsesMemoryResource) {
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  // Any allocation outside the arena throws std::bad_alloc.
+  std::pmr::memory_resource* const previous_default = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+  bomchess::TagPairs tag_pairs(&arena);
+  BOOST_CHECK_EQUAL(tag_pairs.GetMemoryResource(), &arena);
+  const std::string long_value(100, 'x');
+  BOOST_CHECK_NO_THROW(tag_pairs.Set(bomchess::tags::kEvent, long_value));
+  BOOST_CHECK_NO_THROW(tag_pairs.Set("SomeVeryLongSupplementalTagName", long_value));
+  BOOST_CHECK_EQUAL(tag_pairs.Get("SomeVeryLongSupplementalTagName"), long_value);
+
+  std::pmr::set_default_resource(previous_default);
+}
+
+BOOST_AUTO_TEST_CASE(TagPairsCopyIntoMemoryResource) {
+  bomchess::TagPairs tag_pairs;
+  tag_pairs.Set(bomchess::tags::kWhite, "Carlsen, Magnus");
+  tag_pairs.Set("ECO", "B90");
+
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  bomchess::TagPairs copy(tag_pairs, &arena);
+  BOOST_CHECK_EQUAL(copy.GetMemoryResource(), &arena);
+  BOOST_CHECK_EQUAL(copy.Get(bomchess::tags::kWhite), "Carlsen, Magnus");
+  BOOST_CHECK_EQUAL(copy.Get("ECO"), "B90");
+  BOOST_CHECK_EQUAL(copy.SupplementalTags().size(), 1);
+
+  // Moving keeps the arena.
+  const bomchess::TagPairs moved(std::move(copy));
+  BOOST_CHECK_EQUAL(moved.GetMemoryResource(), &arena);
+  BOOST_CHECK_EQUAL(moved.Get("ECO"), "B90");
+}
+
+BOOST_AUTO_TEST_CASE(TagPairsMoveAssignBetweenMemoryResources) {
+  const std::string long_value(100, 'x');
+  std::array<std::byte, 4096> target_buffer{};
+  std::pmr::monotonic_buffer_resource target_arena(target_buffer.data(), target_buffer.size(),
+                                                   std::pmr::null_memory_resource());
+  // Without supplemental tags in the target, the source's can't be assigned over existing ones.
+  bomchess::TagPairs target(&target_arena);
+  target.Set(bomchess::tags::kSite, long_value);
+
+  std::array<std::byte, 4096> source_buffer{};
+  std::pmr::monotonic_buffer_resource source_arena(source_buffer.data(), source_buffer.size(),
+                                                   std::pmr::null_memory_resource());
+  {
+    bomchess::TagPairs source(&source_arena);
+    source.Set(bomchess::tags::kEvent, long_value);
+    source.Set("SomeVeryLongSupplementalTagName", long_value);
+    target = std::move(source);
+  }
+  // Anything still pointing into the released arena reads garbage.
+  source_arena.release();
+  source_buffer.fill(std::byte{0});
+
+  BOOST_CHECK_EQUAL(target.GetMemoryResource(), &target_arena);
+  BOOST_CHECK_EQUAL(target.Get(bomchess::tags::kEvent), long_value);
+  BOOST_CHECK_EQUAL(target.Get("SomeVeryLongSupplementalTagName"), long_value);
+  BOOST_CHECK_EQUAL(target.Get(bomchess::tags::kSite), "");
+  BOOST_REQUIRE_EQUAL(target.SupplementalTags().size(), 1);
+  BOOST_CHECK_EQUAL(target.SupplementalTags().front().name, "SomeVeryLongSupplementalTagName");
+
+  // With the same resource the strings are moved.
+  bomchess::TagPairs same_arena(&target_arena);
+  same_arena = std::move(target);
+  BOOST_CHECK_EQUAL(same_arena.Get(bomchess::tags::kEvent), long_value);
+  BOOST_CHECK_EQUAL(same_arena.SupplementalTags().size(), 1);
+}
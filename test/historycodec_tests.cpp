@@ -0,0 +1,174 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "historycodec.h"
+#include "move.h"
+#include "movegen.h"
+#include "test_positions.h"
+
+namespace {
+bomchess::PositionState StartingState() {
+  bomchess::PositionState state;
+  state.position = bomchess::testing::StartingPosition();
+  state.castling = {bomchess::CastlingRights{true, true}, bomchess::CastlingRights{true, true}};
+  return state;
+}
+
+std::vector<bomchess::Move> Moves(const std::initializer_list<std::string_view> move_strings) {
+  std::vector<bomchess::Move> moves;
+  for (const std::string_view move_string : move_strings) {
+    moves.push_back(bomchess::FromUCI(move_string));
+  }
+  return moves;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(MoveIndexRoundTrip) {
+  const std::vector<std::pair<int, int>> history{{12, 20}, {0, 20}, {29, 30}, {0, 1}, {217, 218}, {3, 4}, {1, 2}};
+  bomchess::MoveIndexEncoder encoder;
+  for (const auto& [move_index, legal_move_count] : history) {
+    encoder.Write(move_index, legal_move_count);
+  }
+  std::vector<uint8_t> bytes;
+  encoder.Finish(bytes);
+  // log2(20 * 20 * 30 * 218 * 4 * 2) is just under 24 bits.
+  BOOST_CHECK_LE(bytes.size(), 3);
+
+  bomchess::MoveIndexDecoder decoder(bytes);
+  for (const auto& [move_index, legal_move_count] : history) {
+    BOOST_CHECK_EQUAL(decoder.Read(legal_move_count), move_index);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexUsesFractionalBits) {
+  // A whole number of bits per index would need 5 bits a ply, 63 bytes in all.
+  bomchess::MoveIndexEncoder encoder;
+  for (int ply = 0; ply < 100; ++ply) {
+    encoder.Write((ply * 7) % 20, 20);
+  }
+  std::vector<uint8_t> bytes;
+  encoder.Finish(bytes);
+  BOOST_CHECK_LE(bytes.size(), 55);
+
+  bomchess::MoveIndexDecoder decoder(bytes);
+  for (int ply = 0; ply < 100; ++ply) {
+    BOOST_CHECK_EQUAL(decoder.Read(20), (ply * 7) % 20);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexForcedMovesAreFree) {
+  bomchess::MoveIndexEncoder encoder;
+  for (int i = 0; i < 100; ++i) {
+    encoder.Write(0, 1);
+  }
+  std::vector<uint8_t> bytes;
+  encoder.Finish(bytes);
+  BOOST_CHECK(bytes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexFinishAppendsAndResets) {
+  bomchess::MoveIndexEncoder encoder;
+  encoder.Write(12, 20);
+  std::vector<uint8_t> first;
+  encoder.Finish(first);
+
+  encoder.Write(12, 20);
+  std::vector<uint8_t> both{first};
+  encoder.Finish(both);
+  BOOST_REQUIRE_EQUAL(both.size(), 2 * first.size());
+  BOOST_CHECK(std::equal(first.begin(), first.end(), both.begin() + static_cast<std::ptrdiff_t>(first.size())));
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexFrequencies) {
+  // The first move is played 9 times in 10, so the history costs far less than the 4.3 bits of a uniform index.
+  std::vector<uint32_t> frequencies(20, 1);
+  frequencies.front() = 171;
+  std::vector<int> history(200, 0);
+  history.at(50) = 7;
+  history.at(120) = 19;
+
+  bomchess::MoveIndexEncoder encoder;
+  for (const int move_index : history) {
+    encoder.Write(move_index, frequencies);
+  }
+  std::vector<uint8_t> bytes;
+  encoder.Finish(bytes);
+  BOOST_CHECK_LE(bytes.size(), 10);
+
+  bomchess::MoveIndexDecoder decoder(bytes);
+  for (const int move_index : history) {
+    BOOST_CHECK_EQUAL(decoder.Read(frequencies), move_index);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexEncoderThrows) {
+  bomchess::MoveIndexEncoder encoder;
+  BOOST_CHECK_THROW(encoder.Write(0, 0), std::invalid_argument);
+  BOOST_CHECK_THROW(encoder.Write(0, 219), std::invalid_argument);
+  BOOST_CHECK_THROW(encoder.Write(20, 20), std::invalid_argument);
+  BOOST_CHECK_THROW(encoder.Write(-1, 20), std::invalid_argument);
+
+  const std::vector<uint32_t> zero_frequency{1, 0, 1};
+  BOOST_CHECK_THROW(encoder.Write(0, zero_frequency), std::invalid_argument);
+  const std::vector<uint32_t> too_frequent{bomchess::kMaxFrequencyTotal, 1};
+  BOOST_CHECK_THROW(encoder.Write(0, too_frequent), std::invalid_argument);
+  BOOST_CHECK_THROW(encoder.Write(0, std::vector<uint32_t>{}), std::invalid_argument);
+  BOOST_CHECK_THROW(encoder.Write(3, std::vector<uint32_t>{1, 2, 3}), std::invalid_argument);
+  std::vector<uint8_t> bytes;
+  encoder.Finish(bytes);
+  BOOST_CHECK(bytes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MoveIndexDecoderThrows) {
+  // With 20 moves the interval splits into steps of 214748364, and this code lies past the last full step.
+  const std::vector<uint8_t> bytes{0xFF, 0xFF, 0xFF, 0xF0};
+  bomchess::MoveIndexDecoder decoder(bytes);
+  BOOST_CHECK_THROW(std::ignore = decoder.Read(20), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = decoder.Read(0), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = decoder.Read(std::vector<uint32_t>{}), std::invalid_argument);
+  // The failed reads left the stream where it was.
+  BOOST_CHECK_EQUAL(decoder.Read(21), 20);
+}
+
+BOOST_AUTO_TEST_CASE(HistoryRoundTrip) {
+  // Morphy's Opera Game, castling queenside, and a game with en passant and a capturing promotion.
+  const std::vector<std::vector<bomchess::Move>> games{
+      Moves({"e2e4", "e7e5", "g1f3", "d7d6", "d2d4", "c8g4", "d4e5", "g4f3", "d1f3", "d6e5", "f1c4",
+             "g8f6", "f3b3", "d8e7", "b1c3", "c7c6", "c1g5", "b7b5", "c3b5", "c6b5", "c4b5", "b8d7",
+             "e1c1", "a8d8", "d1d7", "d8d7", "h1d1", "e7e6", "b5d7", "f6d7", "b3b8", "d7b8", "d1d8"}),
+      Moves({"e2e4", "a7a6", "e4e5", "d7d5", "e5d6", "a6a5", "d6c7", "a5a4", "c7b8q", "a8b8"}),
+      {}};
+  std::vector<uint8_t> bytes;
+  for (const std::vector<bomchess::Move>& game : games) {
+    bytes.clear();
+    bomchess::EncodeHistory(StartingState(), game, bytes);
+    // Around 5 bits a ply.
+    BOOST_CHECK_LE(bytes.size(), (game.size() * 3 + 3) / 4);
+    BOOST_CHECK(bomchess::DecodeHistory(StartingState(), bytes, game.size()) == game);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HistoryThrows) {
+  std::vector<uint8_t> bytes;
+  BOOST_CHECK_THROW(bomchess::EncodeHistory(StartingState(), Moves({"e2e4", "e2e4"}), bytes), std::invalid_argument);
+  BOOST_CHECK_THROW(bomchess::EncodeHistory(StartingState(), Moves({"e1g1"}), bytes), std::invalid_argument);
+
+  // Fool's mate leaves white no move to decode.
+  bytes.clear();
+  const std::vector<bomchess::Move> fools_mate = Moves({"f2f3", "e7e5", "g2g4", "d8h4"});
+  bomchess::EncodeHistory(StartingState(), fools_mate, bytes);
+  BOOST_CHECK_THROW(std::ignore = bomchess::DecodeHistory(StartingState(), bytes, fools_mate.size() + 1),
+                    std::invalid_argument);
+}
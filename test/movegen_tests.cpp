@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "test_positions.h"
+
+namespace {
+std::vector<std::string> ToSortedUCI(const std::vector<bomchess::Move>& moves) {
+  std::vector<std::string> strings;
+  for (const bomchess::Move move : moves) {
+    strings.push_back(bomchess::ToUCI(move));
+  }
+  std::ranges::sort(strings);
+  return strings;
+}
+
+// White: Ke1, Ra1, Rh1, Pa2, Pb7, Pe5, Pg2, Ph3. Black: Ke8, Nc8, Pd5, Pf7, Pg3, Ph4.
+// Counts the leaf nodes of the legal move tree. En passant and castling can't happen within four plies of the
+// starting position.
+uint64_t Perft(const bomchess::Position& position, const bomchess::Color side, const int depth) {
+  std::vector<bomchess::Move> moves;
+  bomchess::GenerateLegalMoves(position, side, bomchess::Square::kNone, {}, moves);
+  if (depth == 1) {
+    return moves.size();
+  }
+  uint64_t nodes = 0;
+  for (const bomchess::Move move : moves) {
+    bomchess::Position after = position;
+    std::ignore = bomchess::MakeMove(after, move);
+    nodes += Perft(after, side == bomchess::Color::kWhite ? bomchess::Color::kBlack : bomchess::Color::kWhite,
+                   depth - 1);
+  }
+  return nodes;
+}
+
+bomchess::Position MakePosition() {
+  return bomchess::testing::MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                           {bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                           {bomchess::Square::kH1, bomchess::pieces::kWhiteRook},
+                                           {bomchess::Square::kA2, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kB7, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kE5, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kG2, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kH3, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                           {bomchess::Square::kC8, bomchess::pieces::kBlackKnight},
+                                           {bomchess::Square::kD5, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kF7, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kG3, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kH4, bomchess::pieces::kBlackPawn}});
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(GeneratePawnMoves) {
+  const bomchess::Position position = MakePosition();
+  std::vector<bomchess::Move> moves;
+  bomchess::GeneratePawnMoves(position, bomchess::Color::kWhite, bomchess::Square::kD6, moves);
+  const std::vector<std::string> expected{"a2a3",  "a2a4",  "b7b8B", "b7b8N", "b7b8Q", "b7b8R",
+                                          "b7c8B", "b7c8N", "b7c8Q", "b7c8R", "e5d6",  "e5e6"};
+  BOOST_CHECK(ToSortedUCI(moves) == expected);
+
+  moves.clear();
+  bomchess::GeneratePawnMoves(position, bomchess::Color::kBlack, bomchess::Square::kNone, moves);
+  const std::vector<std::string> expected_black{"d5d4", "f7f5", "f7f6"};
+  BOOST_CHECK(ToSortedUCI(moves) == expected_black);
+  BOOST_CHECK_THROW(bomchess::GeneratePawnMoves(position, bomchess::Color::kNone, bomchess::Square::kNone, moves),
+                    std::invalid_argument);
+}
+
+// Both colors go through their own template instantiation, so a mirrored position has to give mirrored moves.
+BOOST_AUTO_TEST_CASE(GeneratePawnMovesMirrored) {
+  const bomchess::Position position = MakePosition();
+  for (const bomchess::Color color : {bomchess::Color::kWhite, bomchess::Color::kBlack}) {
+    std::vector<bomchess::Move> moves;
+    bomchess::GeneratePawnMoves(position, color, bomchess::Square::kD6, moves);
+    std::vector<bomchess::Move> mirrored_moves;
+    const bomchess::Color mirrored_color = color == bomchess::Color::kWhite ? bomchess::Color::kBlack
+                                                                            : bomchess::Color::kWhite;
+    bomchess::GeneratePawnMoves(bomchess::testing::Mirror(position), mirrored_color, bomchess::Square::kD3,
+                                mirrored_moves);
+    for (bomchess::Move& move : mirrored_moves) {
+      move.from_square = bomchess::testing::FlipRank(move.from_square);
+      move.to_square = bomchess::testing::FlipRank(move.to_square);
+    }
+    BOOST_CHECK(ToSortedUCI(moves) == ToSortedUCI(mirrored_moves));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GenerateCastlingMoves) {
+  bomchess::Position position = MakePosition();
+  std::vector<bomchess::Move> moves;
+  // The pawn on g3 attacks f2, not f1, so both sides are open.
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kWhite, {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e1c1", "e1g1"}));
+
+  moves.clear();
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kWhite, {.king_side = false, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e1c1"}));
+
+  // A knight on c3 attacks d1, which the king passes over.
+  moves.clear();
+  position.at(bomchess::Square::kC3) = bomchess::pieces::kBlackKnight;
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kWhite, {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e1g1"}));
+
+  // b1 only has to be empty, the king doesn't cross it.
+  moves.clear();
+  position.at(bomchess::Square::kC3) = bomchess::pieces::kNone;
+  position.at(bomchess::Square::kA3) = bomchess::pieces::kBlackKnight;
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kWhite, {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e1c1", "e1g1"}));
+  moves.clear();
+  position.at(bomchess::Square::kB1) = bomchess::pieces::kWhiteKnight;
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kWhite, {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e1g1"}));
+
+  // Black has no rooks.
+  moves.clear();
+  bomchess::GenerateCastlingMoves(position, bomchess::Color::kBlack, {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(moves.empty());
+}
+
+BOOST_AUTO_TEST_CASE(GeneratePieceMoves) {
+  const bomchess::Position position = MakePosition();
+  std::vector<bomchess::Move> moves;
+  bomchess::GeneratePieceMoves(position, bomchess::Color::kBlack, moves);
+  const std::vector<std::string> expected{"c8a7", "c8b6", "c8d6", "c8e7", "e8d7", "e8d8", "e8e7", "e8f8"};
+  BOOST_CHECK(ToSortedUCI(moves) == expected);
+  BOOST_CHECK_THROW(bomchess::GeneratePieceMoves(position, bomchess::Color::kNone, moves), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(GenerateLegalMoves) {
+  bomchess::Position position = MakePosition();
+  // Nothing can block or take the checking bishop, and the king may not step onto d7 along its diagonal.
+  position.at(bomchess::Square::kB5) = bomchess::pieces::kWhiteBishop;
+  BOOST_CHECK(bomchess::IsInCheck(position, bomchess::Color::kBlack));
+  BOOST_CHECK(!bomchess::IsInCheck(position, bomchess::Color::kWhite));
+  std::vector<bomchess::Move> moves;
+  bomchess::GenerateLegalMoves(position, bomchess::Color::kBlack, bomchess::Square::kNone,
+                               {.king_side = true, .queen_side = true}, moves);
+  BOOST_CHECK(ToSortedUCI(moves) == std::vector<std::string>({"e8d8", "e8e7", "e8f8"}));
+
+  BOOST_CHECK_EQUAL(Perft(bomchess::testing::StartingPosition(), bomchess::Color::kWhite, 4), 197281);
+  BOOST_CHECK_THROW(std::ignore = bomchess::IsInCheck(bomchess::Position(), bomchess::Color::kWhite),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(MakeUnmakeMove) {
+  const bomchess::Position original = MakePosition();
+  struct Expected {
+    std::string move;
+    std::vector<bomchess::Square> empty;
+    std::vector<std::pair<bomchess::Square, bomchess::Piece>> occupied;
+  };
+  const std::vector<Expected> cases{
+      {"a2a4", {bomchess::Square::kA2}, {{bomchess::Square::kA4, bomchess::pieces::kWhitePawn}}},
+      {"e5d6",
+       {bomchess::Square::kE5, bomchess::Square::kD5},
+       {{bomchess::Square::kD6, bomchess::pieces::kWhitePawn}}},
+      {"b7c8n", {bomchess::Square::kB7}, {{bomchess::Square::kC8, bomchess::pieces::kWhiteKnight}}},
+      {"e1g1",
+       {bomchess::Square::kE1, bomchess::Square::kH1},
+       {{bomchess::Square::kG1, bomchess::pieces::kWhiteKing}, {bomchess::Square::kF1, bomchess::pieces::kWhiteRook}}},
+      {"e1c1",
+       {bomchess::Square::kE1, bomchess::Square::kA1},
+       {{bomchess::Square::kC1, bomchess::pieces::kWhiteKing}, {bomchess::Square::kD1, bomchess::pieces::kWhiteRook}}},
+      {"f7f5", {bomchess::Square::kF7}, {{bomchess::Square::kF5, bomchess::pieces::kBlackPawn}}},
+      {"c8d6", {bomchess::Square::kC8}, {{bomchess::Square::kD6, bomchess::pieces::kBlackKnight}}},
+  };
+  for (const Expected& expected : cases) {
+    bomchess::Position position = original;
+    const bomchess::Move move = bomchess::FromUCI(expected.move);
+    const bomchess::UndoInfo undo = bomchess::MakeMove(position, move);
+    for (const bomchess::Square square : expected.empty) {
+      BOOST_CHECK_EQUAL(position.at(square), bomchess::pieces::kNone);
+    }
+    for (const auto& [square, piece] : expected.occupied) {
+      BOOST_CHECK_EQUAL(position.at(square), piece);
+    }
+    bomchess::UnmakeMove(position, move, undo);
+    BOOST_CHECK(position == original);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MakeMoveCapture) {
+  bomchess::Position position = MakePosition();
+  BOOST_CHECK(bomchess::IsCapture(position, bomchess::FromUCI("b7c8q")));
+  BOOST_CHECK(bomchess::IsCapture(position, bomchess::FromUCI("e5d6")));
+  BOOST_CHECK(!bomchess::IsCapture(position, bomchess::FromUCI("b7b8q")));
+  BOOST_CHECK(!bomchess::IsCapture(position, bomchess::FromUCI("e1d1")));
+  BOOST_CHECK(bomchess::MakeMove(position, bomchess::FromUCI("a2a3")) == bomchess::UndoInfo{});
+
+  // A black castle with the pawn capturing on the rook's square first.
+  position.at(bomchess::Square::kH8) = bomchess::pieces::kBlackRook;
+  const bomchess::UndoInfo capture = bomchess::MakeMove(position, bomchess::FromUCI("b7c8q"));
+  BOOST_CHECK(capture == (bomchess::UndoInfo{bomchess::pieces::kBlackKnight, bomchess::Square::kC8}));
+  const bomchess::Position after_capture = position;
+  const bomchess::UndoInfo castle = bomchess::MakeMove(position, bomchess::FromUCI("e8g8"));
+  BOOST_CHECK_EQUAL(position.at(bomchess::Square::kF8), bomchess::pieces::kBlackRook);
+  BOOST_CHECK_EQUAL(position.at(bomchess::Square::kG8), bomchess::pieces::kBlackKing);
+  bomchess::UnmakeMove(position, bomchess::FromUCI("e8g8"), castle);
+  BOOST_CHECK(position == after_capture);
+  bomchess::UnmakeMove(position, bomchess::FromUCI("b7c8q"), capture);
+  BOOST_CHECK_EQUAL(position.at(bomchess::Square::kC8), bomchess::pieces::kBlackKnight);
+  BOOST_CHECK_EQUAL(position.at(bomchess::Square::kB7), bomchess::pieces::kWhitePawn);
+
+  BOOST_CHECK_THROW(std::ignore = bomchess::MakeMove(position, bomchess::FromUCI("d4d5")), std::invalid_argument);
+  BOOST_CHECK_THROW(bomchess::UnmakeMove(position, bomchess::FromUCI("d5d4"), {}), std::invalid_argument);
+}
@@ -0,0 +1,163 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "move.h"
+#include "movepicker.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "test_positions.h"
+
+namespace {
+const bomchess::Move kNoMove(bomchess::Square::kNone, bomchess::Square::kNone, bomchess::PieceType::kNone);
+
+// White: Kg1, Qd1, Nc3, Pe4. Black: Kg8, Rd5, Pb4, Nf6.
+bomchess::Position MakePosition() {
+  return bomchess::testing::MakePosition({{bomchess::Square::kG1, bomchess::pieces::kWhiteKing},
+                                           {bomchess::Square::kD1, bomchess::pieces::kWhiteQueen},
+                                           {bomchess::Square::kC3, bomchess::pieces::kWhiteKnight},
+                                           {bomchess::Square::kE4, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kG8, bomchess::pieces::kBlackKing},
+                                           {bomchess::Square::kD5, bomchess::pieces::kBlackRook},
+                                           {bomchess::Square::kB4, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kF6, bomchess::pieces::kBlackKnight}});
+}
+
+struct CountingGenerators {
+  std::vector<bomchess::Move> captures{bomchess::FromUCI("d1d5"), bomchess::FromUCI("c3b4"), bomchess::FromUCI("c3d5"),
+                                       bomchess::FromUCI("e4d5")};
+  std::vector<bomchess::Move> quiets{bomchess::FromUCI("g1h1"), bomchess::FromUCI("d1d2"), bomchess::FromUCI("c3e2"),
+                                     bomchess::FromUCI("e4e5"), bomchess::FromUCI("g1f1")};
+  int capture_calls = 0;
+  int quiet_calls = 0;
+  bomchess::MovePickerGenerators generators{
+      .captures =
+          [this](std::vector<bomchess::Move>& moves) {
+            capture_calls += 1;
+            moves.insert(moves.end(), captures.begin(), captures.end());
+          },
+      .quiets =
+          [this](std::vector<bomchess::Move>& moves) {
+            quiet_calls += 1;
+            moves.insert(moves.end(), quiets.begin(), quiets.end());
+          },
+      .is_pseudo_legal =
+          [this](const bomchess::Move move) {
+            return std::ranges::find(captures, move) != captures.end() ||
+                   std::ranges::find(quiets, move) != quiets.end();
+          },
+  };
+};
+
+std::vector<bomchess::Move> PickAll(bomchess::MovePicker& picker) {
+  std::vector<bomchess::Move> moves;
+  for (std::optional<bomchess::Move> move = picker.Next(); move.has_value(); move = picker.Next()) {
+    moves.push_back(*move);
+  }
+  return moves;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(MovePickerOrder) {
+  const bomchess::Position position = MakePosition();
+  CountingGenerators counting_generators;
+  bomchess::HistoryTable history;
+  history.Update(bomchess::Color::kWhite, bomchess::FromUCI("g1f1"), 500);
+  history.Update(bomchess::Color::kWhite, bomchess::FromUCI("d1d2"), 200);
+  history.Update(bomchess::Color::kWhite, bomchess::FromUCI("g1h1"), -300);
+  bomchess::MovePicker picker(position, bomchess::FromUCI("c3e2"), {bomchess::FromUCI("e4e5"), kNoMove}, history,
+                              counting_generators.generators);
+
+  const std::vector<bomchess::Move> expected{
+      bomchess::FromUCI("c3e2"),                                                        // hash move
+      bomchess::FromUCI("e4d5"), bomchess::FromUCI("c3d5"),                             // takes the rook, pawn first
+      bomchess::FromUCI("c3b4"),                                                        // takes a pawn
+      bomchess::FromUCI("e4e5"),                                                        // killer
+      bomchess::FromUCI("g1f1"), bomchess::FromUCI("d1d2"), bomchess::FromUCI("g1h1"),  // by history
+      bomchess::FromUCI("d1d5"),  // QxR NxQ loses material, so it goes last
+  };
+  BOOST_CHECK(PickAll(picker) == expected);
+  BOOST_CHECK(!picker.Next().has_value());
+  BOOST_CHECK_EQUAL(counting_generators.capture_calls, 1);
+  BOOST_CHECK_EQUAL(counting_generators.quiet_calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(MovePickerIsLazy) {
+  const bomchess::Position position = MakePosition();
+  CountingGenerators counting_generators;
+  const bomchess::HistoryTable history;
+  bomchess::MovePicker picker(position, bomchess::FromUCI("d1d5"), {kNoMove, kNoMove}, history,
+                              counting_generators.generators);
+  BOOST_CHECK(picker.Next() == bomchess::FromUCI("d1d5"));
+  BOOST_CHECK_EQUAL(counting_generators.capture_calls, 0);
+  BOOST_CHECK(picker.Next() == bomchess::FromUCI("e4d5"));
+  BOOST_CHECK_EQUAL(counting_generators.capture_calls, 1);
+  BOOST_CHECK_EQUAL(counting_generators.quiet_calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(MovePickerSkipsUnplayableMoves) {
+  const bomchess::Position position = MakePosition();
+  CountingGenerators counting_generators;
+  const bomchess::HistoryTable history;
+  // The hash move and first killer came from other positions and aren't legal here. The second killer is a capture.
+  const std::array<bomchess::Move, 2> killers{bomchess::FromUCI("h2h4"), bomchess::FromUCI("c3b4")};
+  bomchess::MovePicker picker(position, bomchess::FromUCI("a1a8"), killers, history, counting_generators.generators);
+  const std::vector<bomchess::Move> moves = PickAll(picker);
+  BOOST_CHECK_EQUAL(moves.size(), counting_generators.captures.size() + counting_generators.quiets.size());
+  BOOST_CHECK(moves.front() == bomchess::FromUCI("e4d5"));
+}
+
+BOOST_AUTO_TEST_CASE(MovePickerScoresPromotionsAndEnPassant) {
+  // White: Ke1, Pb7, Pe5. Black: Kh8, Qe2, Pd5, with d6 the en passant square.
+  const bomchess::Position position =
+      bomchess::testing::MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                       {bomchess::Square::kB7, bomchess::pieces::kWhitePawn},
+                                       {bomchess::Square::kE5, bomchess::pieces::kWhitePawn},
+                                       {bomchess::Square::kH8, bomchess::pieces::kBlackKing},
+                                       {bomchess::Square::kE2, bomchess::pieces::kBlackQueen},
+                                       {bomchess::Square::kD5, bomchess::pieces::kBlackPawn}});
+  const std::vector<bomchess::Move> captures{bomchess::FromUCI("e5d6"), bomchess::FromUCI("b7b8q"),
+                                             bomchess::FromUCI("e1e2")};
+  const bomchess::MovePickerGenerators generators{
+      .captures = [&](std::vector<bomchess::Move>& moves) {
+        moves.insert(moves.end(), captures.begin(), captures.end());
+      },
+      .quiets = [](std::vector<bomchess::Move>&) {},
+      .is_pseudo_legal = [](bomchess::Move) { return false; },
+  };
+  const bomchess::HistoryTable history;
+  bomchess::MovePicker picker(position, kNoMove, {kNoMove, kNoMove}, history, generators);
+
+  // The quiet promotion takes nothing, so it follows the queen capture. En passant still scores as taking a pawn.
+  const std::vector<bomchess::Move> expected{bomchess::FromUCI("e1e2"), bomchess::FromUCI("b7b8q"),
+                                             bomchess::FromUCI("e5d6")};
+  BOOST_CHECK(PickAll(picker) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(HistoryTableUpdate) {
+  bomchess::HistoryTable history;
+  const bomchess::Move move = bomchess::FromUCI("e2e4");
+  BOOST_CHECK_EQUAL(history.Get(bomchess::Color::kWhite, move), 0);
+  history.Update(bomchess::Color::kWhite, move, 1000);
+  BOOST_CHECK_EQUAL(history.Get(bomchess::Color::kWhite, move), 1000);
+  BOOST_CHECK_EQUAL(history.Get(bomchess::Color::kBlack, move), 0);
+  for (int i = 0; i < 1000; ++i) {
+    history.Update(bomchess::Color::kWhite, move, 100000);
+  }
+  BOOST_CHECK_LE(history.Get(bomchess::Color::kWhite, move), bomchess::HistoryTable::kMaxHistory);
+  history.Clear();
+  BOOST_CHECK_EQUAL(history.Get(bomchess::Color::kWhite, move), 0);
+}
+
+BOOST_AUTO_TEST_CASE(HistoryTableThrows) {
+  bomchess::HistoryTable history;
+  BOOST_CHECK_THROW(history.Update(bomchess::Color::kNone, bomchess::FromUCI("e2e4"), 1), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = history.Get(bomchess::Color::kWhite, kNoMove), std::invalid_argument);
+}
@@ -0,0 +1,220 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "nnue.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "test_networks.h"
+#include "test_positions.h"
+
+namespace {
+using bomchess::testing::WriteValue;
+
+constexpr int kHiddenSize = 32;
+
+// Small pseudo random weights, so every feature moves the accumulator differently.
+std::string MakeNetwork(const int16_t feature_bias, const int32_t output_bias) {
+  std::ostringstream network;
+  network << "BNUE";
+  WriteValue(network, static_cast<uint32_t>(kHiddenSize));
+  for (int i = 0; i < 768 * kHiddenSize; ++i) {
+    WriteValue(network, static_cast<int16_t>((i * 7919) % 61 - 30));
+  }
+  for (int i = 0; i < kHiddenSize; ++i) {
+    WriteValue(network, feature_bias);
+  }
+  for (int i = 0; i < 2 * kHiddenSize; ++i) {
+    WriteValue(network, static_cast<int16_t>((i * 104729) % 41 - 20));
+  }
+  WriteValue(network, output_bias);
+  return network.str();
+}
+
+bomchess::NnueNetwork LoadNetwork(const int16_t feature_bias = 40, const int32_t output_bias = 0) {
+  std::istringstream network(MakeNetwork(feature_bias, output_bias));
+  return bomchess::NnueNetwork(network);
+}
+
+using bomchess::testing::StartingPosition;
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(NnueLoad) {
+  const bomchess::NnueNetwork network = LoadNetwork();
+  BOOST_CHECK_EQUAL(network.HiddenSize(), kHiddenSize);
+  BOOST_CHECK(network.GetSimdLevel() == bomchess::NnueNetwork::SupportedSimdLevel());
+}
+
+BOOST_AUTO_TEST_CASE(NnueLoadThrows) {
+  std::string network_file = MakeNetwork(0, 0);
+  std::istringstream truncated(network_file.substr(0, network_file.size() - 1));
+  BOOST_CHECK_THROW(bomchess::NnueNetwork{truncated}, std::runtime_error);
+
+  network_file.at(0) = 'X';
+  std::istringstream bad_magic(network_file);
+  BOOST_CHECK_THROW(bomchess::NnueNetwork{bad_magic}, std::runtime_error);
+
+  std::istringstream bad_size(std::string("BNUE") + std::string("\x0F\x00\x00\x00", 4));
+  BOOST_CHECK_THROW(bomchess::NnueNetwork{bad_size}, std::runtime_error);
+
+  BOOST_CHECK_THROW(bomchess::NnueNetwork{std::filesystem::path("missing_network.bnue")}, std::runtime_error);
+}
+
+// With only biases the hidden layer is 10 everywhere, so the output is the sum of the output weights times 10.
+BOOST_AUTO_TEST_CASE(NnueEvaluateKnownValue) {
+  std::ostringstream network_file;
+  network_file << "BNUE";
+  WriteValue(network_file, static_cast<uint32_t>(16));
+  for (int i = 0; i < 768 * 16; ++i) {
+    WriteValue(network_file, static_cast<int16_t>(0));
+  }
+  for (int i = 0; i < 16; ++i) {
+    WriteValue(network_file, static_cast<int16_t>(10));
+  }
+  for (int i = 0; i < 32; ++i) {
+    WriteValue(network_file, static_cast<int16_t>(51));
+  }
+  WriteValue(network_file, static_cast<int32_t>(255 * 64));
+  std::istringstream network_stream(network_file.str());
+  const bomchess::NnueNetwork network(network_stream);
+  // (32 * 10 * 51 + 255 * 64) * 400 / (255 * 64) = 800
+  BOOST_CHECK_EQUAL(network.Evaluate(network.MakeAccumulator(StartingPosition()), bomchess::Color::kWhite), 800);
+}
+
+BOOST_AUTO_TEST_CASE(NnueIncrementalMatchesRefresh) {
+  const bomchess::NnueNetwork network = LoadNetwork();
+  bomchess::Position position = StartingPosition();
+  bomchess::NnueAccumulator accumulator = network.MakeAccumulator(position);
+
+  // 1. e4 d5 2. exd5
+  network.RemovePiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kE2);
+  network.AddPiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kE4);
+  network.RemovePiece(accumulator, bomchess::pieces::kBlackPawn, bomchess::Square::kD7);
+  network.AddPiece(accumulator, bomchess::pieces::kBlackPawn, bomchess::Square::kD5);
+  network.RemovePiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kE4);
+  network.RemovePiece(accumulator, bomchess::pieces::kBlackPawn, bomchess::Square::kD5);
+  network.AddPiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kD5);
+  position.at(bomchess::Square::kE2) = bomchess::pieces::kNone;
+  position.at(bomchess::Square::kD7) = bomchess::pieces::kNone;
+  position.at(bomchess::Square::kD5) = bomchess::pieces::kWhitePawn;
+
+  BOOST_CHECK(accumulator == network.MakeAccumulator(position));
+
+  // Unmaking the capture gets back to the earlier accumulator.
+  const bomchess::NnueAccumulator after_capture = accumulator;
+  network.RemovePiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kD5);
+  network.AddPiece(accumulator, bomchess::pieces::kBlackPawn, bomchess::Square::kD5);
+  network.AddPiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kE4);
+  network.RemovePiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kE4);
+  network.AddPiece(accumulator, bomchess::pieces::kWhitePawn, bomchess::Square::kD5);
+  network.RemovePiece(accumulator, bomchess::pieces::kBlackPawn, bomchess::Square::kD5);
+  BOOST_CHECK(accumulator == after_capture);
+}
+
+BOOST_AUTO_TEST_CASE(NnueAccumulatorThrows) {
+  const bomchess::NnueNetwork network = LoadNetwork();
+  bomchess::NnueAccumulator accumulator = network.MakeAccumulator(bomchess::Position());
+  BOOST_CHECK_THROW(network.AddPiece(accumulator, bomchess::pieces::kNone, bomchess::Square::kA1),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(network.AddPiece(accumulator, bomchess::pieces::kWhiteKing, bomchess::Square::kNone),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = network.Evaluate(accumulator, bomchess::Color::kNone), std::invalid_argument);
+}
+
+// A position and its color flipped mirror image are the same position for the side to move.
+BOOST_AUTO_TEST_CASE(NnueEvaluateIsSymmetric) {
+  const bomchess::NnueNetwork network = LoadNetwork();
+  bomchess::Position position;
+  position.at(bomchess::Square::kG1) = bomchess::pieces::kWhiteKing;
+  position.at(bomchess::Square::kD4) = bomchess::pieces::kWhiteQueen;
+  position.at(bomchess::Square::kB8) = bomchess::pieces::kBlackKing;
+  bomchess::Position mirrored;
+  mirrored.at(bomchess::Square::kG8) = bomchess::pieces::kBlackKing;
+  mirrored.at(bomchess::Square::kD5) = bomchess::pieces::kBlackQueen;
+  mirrored.at(bomchess::Square::kB1) = bomchess::pieces::kWhiteKing;
+  BOOST_CHECK_EQUAL(network.Evaluate(network.MakeAccumulator(position), bomchess::Color::kWhite),
+                    network.Evaluate(network.MakeAccumulator(mirrored), bomchess::Color::kBlack));
+}
+
+BOOST_AUTO_TEST_CASE(NnueSimdLevelsAgree) {
+  bomchess::NnueNetwork network = LoadNetwork(200, 1234);
+  const bomchess::NnueAccumulator accumulator = network.MakeAccumulator(StartingPosition());
+  network.SetSimdLevel(bomchess::SimdLevel::kScalar);
+  const int scalar_evaluation = network.Evaluate(accumulator, bomchess::Color::kBlack);
+  for (const bomchess::SimdLevel simd_level : {bomchess::SimdLevel::kSse2, bomchess::SimdLevel::kAvx2}) {
+    if (simd_level > bomchess::NnueNetwork::SupportedSimdLevel()) {
+      BOOST_CHECK_THROW(network.SetSimdLevel(simd_level), std::invalid_argument);
+      continue;
+    }
+    network.SetSimdLevel(simd_level);
+    BOOST_CHECK_EQUAL(network.Evaluate(accumulator, bomchess::Color::kBlack), scalar_evaluation);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NnueLargestSumsDontOverflow) {
+  // The largest network with every activation and output weight at its maximum, so each dot product is
+  // 1024 * 255 * 32767, well past the int32 range.
+  constexpr int kLargestHiddenSize = 1024;
+  std::ostringstream network_file;
+  network_file << "BNUE";
+  WriteValue(network_file, static_cast<uint32_t>(kLargestHiddenSize));
+  for (int i = 0; i < 768 * kLargestHiddenSize; ++i) {
+    WriteValue(network_file, int16_t{0});
+  }
+  for (int i = 0; i < kLargestHiddenSize; ++i) {
+    WriteValue(network_file, int16_t{255});
+  }
+  for (int i = 0; i < 2 * kLargestHiddenSize; ++i) {
+    WriteValue(network_file, int16_t{32767});
+  }
+  WriteValue(network_file, int32_t{0});
+  std::istringstream network_stream(network_file.str());
+  bomchess::NnueNetwork network(network_stream);
+
+  const bomchess::NnueAccumulator accumulator = network.MakeAccumulator(bomchess::Position());
+  // 2 * 1024 * 255 * 32767 * 400 / (255 * 64)
+  constexpr int kExpected = 2 * 1024 * 32767 / 64 * 400;
+  for (const bomchess::SimdLevel simd_level :
+       {bomchess::SimdLevel::kScalar, bomchess::SimdLevel::kSse2, bomchess::SimdLevel::kAvx2}) {
+    if (simd_level <= bomchess::NnueNetwork::SupportedSimdLevel()) {
+      network.SetSimdLevel(simd_level);
+      BOOST_CHECK_EQUAL(network.Evaluate(accumulator, bomchess::Color::kWhite), kExpected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NnueEvaluateBatch) {
+  const bomchess::NnueNetwork network = LoadNetwork();
+  std::vector<bomchess::Position> positions{StartingPosition()};
+  positions.push_back(positions.back());
+  positions.back().at(bomchess::Square::kG1) = bomchess::pieces::kNone;
+  positions.back().at(bomchess::Square::kF3) = bomchess::pieces::kWhiteKnight;
+  positions.push_back(positions.back());
+  positions.back().at(bomchess::Square::kD7) = bomchess::pieces::kNone;
+  positions.back().at(bomchess::Square::kD5) = bomchess::pieces::kBlackPawn;
+  positions.emplace_back();
+  positions.back().at(bomchess::Square::kA1) = bomchess::pieces::kWhiteKing;
+  positions.back().at(bomchess::Square::kH8) = bomchess::pieces::kBlackKing;
+  const std::vector<bomchess::Color> sides_to_move{bomchess::Color::kWhite, bomchess::Color::kBlack,
+                                                   bomchess::Color::kWhite, bomchess::Color::kBlack};
+
+  const std::vector<int> evaluations = network.EvaluateBatch(positions, sides_to_move);
+  BOOST_REQUIRE_EQUAL(evaluations.size(), positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    const bomchess::NnueAccumulator accumulator = network.MakeAccumulator(positions.at(i));
+    BOOST_CHECK_EQUAL(evaluations.at(i), network.Evaluate(accumulator, sides_to_move.at(i)));
+  }
+  BOOST_CHECK(network.EvaluateBatch({}, {}).empty());
+  BOOST_CHECK_THROW(std::ignore = network.EvaluateBatch(positions, std::span(sides_to_move).first(2)),
+                    std::invalid_argument);
+}
@@ -0,0 +1,55 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <optional>
+#include <string>
+
+#include "boost/test/unit_test.hpp"
+
+#include "pgnannotations.h"
+
+BOOST_AUTO_TEST_CASE(ParseClockFormats) {
+  BOOST_CHECK(bomchess::ParseClock("0:03:00") == 180000);
+  BOOST_CHECK(bomchess::ParseClock("1:30:05") == 5405000);
+  BOOST_CHECK(bomchess::ParseClock("0:00:59.9") == 59900);
+  BOOST_CHECK(bomchess::ParseClock("0:00:01.25") == 1250);
+  BOOST_CHECK(bomchess::ParseClock("0:00:01.2567") == 1256);
+  BOOST_CHECK(bomchess::ParseClock("2:07") == 127000);
+  BOOST_CHECK(bomchess::ParseClock("42") == 42000);
+  for (const std::string clock :
+       {"", ".5", "0:03:", "a:03:00", "0:-3:00", "1:2:3:4", "0:00:01.", "0:00:01.x", "999999:00:00"}) {
+    BOOST_CHECK_MESSAGE(!bomchess::ParseClock(clock).has_value(), clock);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParseEvaluationFormats) {
+  BOOST_CHECK(bomchess::ParseEvaluation("0.17") == 17);
+  BOOST_CHECK(bomchess::ParseEvaluation("-1.35") == -135);
+  BOOST_CHECK(bomchess::ParseEvaluation("+2") == 200);
+  BOOST_CHECK(bomchess::ParseEvaluation("0.17,23") == 17);
+  BOOST_CHECK(bomchess::ParseEvaluation("#4") == bomchess::MateEvaluation(4));
+  BOOST_CHECK(bomchess::ParseEvaluation("#-2") == bomchess::MateEvaluation(-2));
+  BOOST_CHECK(bomchess::IsMateEvaluation(*bomchess::ParseEvaluation("#-2")));
+  BOOST_CHECK(!bomchess::IsMateEvaluation(*bomchess::ParseEvaluation("-99.5")));
+  BOOST_CHECK_GT(bomchess::MateEvaluation(1), bomchess::MateEvaluation(5));
+  BOOST_CHECK_LT(bomchess::MateEvaluation(-1), bomchess::MateEvaluation(-5));
+  for (const std::string evaluation : {"", "#", "#x", "pawn", "1.5x", "1e9", "nan"}) {
+    BOOST_CHECK_MESSAGE(!bomchess::ParseEvaluation(evaluation).has_value(), evaluation);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AppendAnnotationsRoundTrip) {
+  const bomchess::MoveAnnotations annotations{
+      .clock_ms = {3723400, bomchess::kNoAnnotation},
+      .elapsed_ms = {},
+      .evaluation = {-7, bomchess::MateEvaluation(3)},
+  };
+  std::string first;
+  bomchess::AppendAnnotations(annotations, 0, first);
+  BOOST_CHECK_EQUAL(first, "[%eval -0.07] [%clk 1:02:03.4]");
+  std::string second = "Text";
+  bomchess::AppendAnnotations(annotations, 1, second);
+  BOOST_CHECK_EQUAL(second, "Text [%eval #3]");
+  std::string past_the_end;
+  bomchess::AppendAnnotations(annotations, 2, past_the_end);
+  BOOST_CHECK(past_the_end.empty());
+}
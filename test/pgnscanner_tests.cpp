@@ -0,0 +1,207 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "game.h"
+#include "pgnscanner.h"
+#include "pgnwriter.h"
+
+namespace {
+constexpr std::string_view kPgn = R"([Event "F/S Return Match"]
+[Site "Belgrade, Serbia JUG"]
+[Date "1992.11.04"]
+[Round "29"]
+[White "Fischer, Robert J."]
+[Black "Spassky, Boris V."]
+[Result "1/2-1/2"]
+[WhiteElo "2785"]
+[Annotator "Someone \"Quoted\" \\ here"]
+
+{Opening comment} 1. e4 e5 2. Nf3 Nc6 3. Bb5 {This opening is called the Ruy Lopez.}
+3... a6 4. Ba4 $1 (4. Bxc6 dxc6 {exchange} (4... bxc6) 5. O-O) 4... Nf6!? ; rest of line
+5. O-O Be7 1/2-1/2
+
+% escaped line [Event "not a game"]
+[Event "Second"]
+[Result "*"]
+[FEN "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3"]
+[SetUp "1"]
+
+3.Bc4 {A} {B} Bc5 0-0 *
+[Event "Third"]
+
+12... Qxd5 13. Nc3
+[Event "Fourth"]
+)";
+
+std::vector<bomchess::LazyPgnGame> ScanAll(const std::string_view pgn) {
+  bomchess::PgnScanner scanner(pgn);
+  std::vector<bomchess::LazyPgnGame> games;
+  for (std::optional<bomchess::LazyPgnGame> game = scanner.Next(); game.has_value(); game = scanner.Next()) {
+    games.push_back(std::move(*game));
+  }
+  return games;
+}
+
+std::vector<std::string> ToVector(const std::span<const std::string> strings) {
+  return {strings.begin(), strings.end()};
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(PgnScannerTags) {
+  std::vector<bomchess::LazyPgnGame> games = ScanAll(kPgn);
+  BOOST_REQUIRE_EQUAL(games.size(), 4);
+  BOOST_CHECK_EQUAL(games.at(0).GetTag(bomchess::tags::kWhite), "Fischer, Robert J.");
+  BOOST_CHECK_EQUAL(games.at(0).GetTag(bomchess::tags::kWhiteElo), "2785");
+  BOOST_CHECK_EQUAL(games.at(0).GetTag(bomchess::tags::kAnnotator), "Someone \"Quoted\" \\ here");
+  BOOST_CHECK_EQUAL(games.at(0).Offset(), 0);
+  BOOST_CHECK_EQUAL(games.at(1).GetTag(bomchess::tags::kEvent), "Second");
+  BOOST_CHECK_EQUAL(kPgn.substr(games.at(1).Offset(), 16), "[Event \"Second\"]");
+  BOOST_CHECK_EQUAL(games.at(2).GetTag(bomchess::tags::kEvent), "Third");
+  BOOST_CHECK_EQUAL(games.at(3).GetTag(bomchess::tags::kEvent), "Fourth");
+  BOOST_CHECK(games.at(3).Movetext().empty());
+  for (const bomchess::LazyPgnGame& game : games) {
+    BOOST_CHECK(!game.IsMovetextParsed());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PgnScannerMovetext) {
+  std::vector<bomchess::LazyPgnGame> games = ScanAll(kPgn);
+  BOOST_REQUIRE_EQUAL(games.size(), 4);
+
+  bomchess::LazyPgnGame& first = games.at(0);
+  BOOST_CHECK(first.Movetext().starts_with("{Opening comment} 1. e4"));
+  BOOST_CHECK(first.Movetext().ends_with("Be7 1/2-1/2"));
+  const std::vector<std::string> moves{"e4", "e5", "Nf3", "Nc6", "Bb5", "a6", "Ba4", "Nf6", "O-O", "Be7"};
+  BOOST_CHECK(ToVector(first.SanMoves()) == moves);
+  BOOST_CHECK(first.IsMovetextParsed());
+  const std::vector<std::string> comments{
+      "", "", "", "", "This opening is called the Ruy Lopez.", "", "", "rest of line", "", ""};
+  BOOST_CHECK(ToVector(first.Comments()) == comments);
+  BOOST_CHECK_EQUAL(first.InitialComment(), "Opening comment");
+  BOOST_CHECK_EQUAL(first.Termination(), "1/2-1/2");
+
+  bomchess::LazyPgnGame& second = games.at(1);
+  BOOST_CHECK(ToVector(second.SanMoves()) == std::vector<std::string>({"Bc4", "Bc5", "0-0"}));
+  BOOST_CHECK_EQUAL(second.Comments().front(), "A B");
+  BOOST_CHECK_EQUAL(second.Termination(), "*");
+  BOOST_CHECK_EQUAL(second.View().first_move_number, 3);
+
+  // No termination marker, ended by the next tag section.
+  bomchess::LazyPgnGame& third = games.at(2);
+  BOOST_CHECK(ToVector(third.SanMoves()) == std::vector<std::string>({"Qxd5", "Nc3"}));
+  BOOST_CHECK_EQUAL(third.Termination(), "");
+  const bomchess::PgnGameView view = third.View();
+  BOOST_CHECK_EQUAL(view.first_move_number, 12);
+  BOOST_CHECK(view.first_to_move == bomchess::Color::kBlack);
+}
+
+// Markers inside comments and variations don't end the game.
+BOOST_AUTO_TEST_CASE(PgnScannerNestedMarkers) {
+  const std::vector<bomchess::LazyPgnGame> games =
+      ScanAll("1. e4 { 1-0 } (1. d4 *) ; 0-1\n1... e5 2. Qh5 Nc6 3. Bc4 Nf6 4. Qxf7# 1-0\n\n1. d4 *");
+  BOOST_REQUIRE_EQUAL(games.size(), 2);
+  BOOST_CHECK(games.front().Movetext().ends_with("Qxf7# 1-0"));
+  BOOST_CHECK_EQUAL(games.back().Movetext(), "1. d4 *");
+}
+
+// A move number that doesn't fit in an int is skipped like any other move number, without setting the numbering.
+BOOST_AUTO_TEST_CASE(PgnScannerOversizedMoveNumber) {
+  std::vector<bomchess::LazyPgnGame> games = ScanAll("99999999999... e5 99999999999. Nf3 *");
+  BOOST_REQUIRE_EQUAL(games.size(), 1);
+  BOOST_CHECK(ToVector(games.front().SanMoves()) == std::vector<std::string>({"e5", "Nf3"}));
+  const bomchess::PgnGameView view = games.front().View();
+  BOOST_CHECK_EQUAL(view.first_move_number, 1);
+  BOOST_CHECK(view.first_to_move == bomchess::Color::kWhite);
+}
+
+BOOST_AUTO_TEST_CASE(PgnScannerRoundTrip) {
+  std::vector<bomchess::LazyPgnGame> games = ScanAll(kPgn);
+  std::string exported;
+  for (bomchess::LazyPgnGame& game : games) {
+    bomchess::AppendPGN(game.View(), exported);
+  }
+  std::vector<bomchess::LazyPgnGame> rescanned = ScanAll(exported);
+  BOOST_REQUIRE_EQUAL(rescanned.size(), games.size());
+  for (size_t i = 0; i < games.size(); ++i) {
+    BOOST_CHECK(ToVector(rescanned.at(i).SanMoves()) == ToVector(games.at(i).SanMoves()));
+    BOOST_CHECK(ToVector(rescanned.at(i).Comments()) == ToVector(games.at(i).Comments()));
+    BOOST_CHECK_EQUAL(rescanned.at(i).GetTag(bomchess::tags::kAnnotator),
+                      games.at(i).GetTag(bomchess::tags::kAnnotator));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PgnScannerThrows) {
+  for (const std::string_view pgn :
+       {"[Event \"Unterminated]\n1. e4 *", "[Event Unquoted]\n*", "[\"No name\"]\n*", "[Event \"x\"\n1. e4 *",
+        "[Event \"x\"]\n1. e4 {never closed *"}) {
+    bomchess::PgnScanner scanner(pgn);
+    BOOST_CHECK_THROW(std::ignore = scanner.Next(), std::invalid_argument);
+  }
+  bomchess::PgnScanner empty(" \n% only an escaped line");
+  BOOST_CHECK(!empty.Next().has_value());
+}
+
+BOOST_AUTO_TEST_CASE(PgnScannerAnnotations) {
+  constexpr std::string_view kAnnotated =
+      "[Event \"Rated Blitz\"]\n\n"
+      "1. e4 { [%eval 0.17] [%clk 0:03:00] } 1... e5 { [%eval 0.2] [%clk 0:02:58.5] Solid [%cal Gg1f3] } "
+      "2. Qh5 { [%eval -0.5] [%clk 0:02:55] [%emt 0:00:05] } 2... Nc6 3. Bc4 { [%eval bad] } 3... Nf6 "
+      "{ [%eval #1] } 4. Qxf7# { [%eval #0] } 1-0\n";
+  std::vector<bomchess::LazyPgnGame> games = ScanAll(kAnnotated);
+  BOOST_REQUIRE_EQUAL(games.size(), 1);
+  bomchess::LazyPgnGame& game = games.front();
+
+  // The decoded commands leave the comments, others and malformed ones stay.
+  const std::vector<std::string> comments{"", "Solid [%cal Gg1f3]", "", "", "[%eval bad]", "", ""};
+  BOOST_CHECK(ToVector(game.Comments()) == comments);
+
+  const bomchess::MoveAnnotations& annotations = game.Annotations();
+  constexpr int32_t kNone = bomchess::kNoAnnotation;
+  BOOST_CHECK(annotations.clock_ms == std::vector<int32_t>({180000, 178500, 175000, kNone, kNone, kNone, kNone}));
+  BOOST_CHECK(annotations.elapsed_ms == std::vector<int32_t>({kNone, kNone, 5000, kNone, kNone, kNone, kNone}));
+  BOOST_CHECK(annotations.evaluation == std::vector<int32_t>({17, 20, -50, kNone, kNone, bomchess::MateEvaluation(1),
+                                                              bomchess::MateEvaluation(0)}));
+
+  // Exporting writes the commands back as they were written.
+  const bomchess::PgnGameView view = game.View();
+  BOOST_CHECK(view.annotations == nullptr);
+  BOOST_REQUIRE_EQUAL(view.commands.size(), 9);
+  BOOST_CHECK_EQUAL(view.commands.front().text, "[%eval 0.17]");
+  BOOST_CHECK_EQUAL(view.commands.back().move, 6);
+  std::string exported;
+  bomchess::AppendPGN(view, exported);
+  std::vector<bomchess::LazyPgnGame> rescanned = ScanAll(exported);
+  BOOST_REQUIRE_EQUAL(rescanned.size(), 1);
+  BOOST_CHECK(ToVector(rescanned.front().Comments()) == comments);
+  BOOST_CHECK(rescanned.front().Annotations().clock_ms == annotations.clock_ms);
+  BOOST_CHECK(rescanned.front().Annotations().evaluation == annotations.evaluation);
+
+  // Games without commands have no annotations.
+  std::vector<bomchess::LazyPgnGame> plain = ScanAll("1. e4 {Just text} e5 *");
+  BOOST_CHECK(plain.front().View().commands.empty());
+  BOOST_CHECK(plain.front().Annotations().clock_ms.empty());
+}
+
+// A malformed command stays in the comment, and an evaluation keeps its depth when the game is exported.
+BOOST_AUTO_TEST_CASE(PgnScannerAnnotationsKeptOnExport) {
+  std::vector<bomchess::LazyPgnGame> games = ScanAll("1. e4 {[%clk 1:2:3:4] note} e5 {[%eval 0.17,20]} *");
+  BOOST_REQUIRE_EQUAL(games.size(), 1);
+  bomchess::LazyPgnGame& game = games.front();
+  BOOST_CHECK(ToVector(game.Comments()) == std::vector<std::string>({"[%clk 1:2:3:4] note", ""}));
+  BOOST_CHECK(game.Annotations().clock_ms.empty());
+  BOOST_CHECK(game.Annotations().evaluation == std::vector<int32_t>({bomchess::kNoAnnotation, 17}));
+
+  std::string exported;
+  bomchess::AppendPGN(game.View(), exported);
+  BOOST_CHECK(exported.contains("1. e4 {[%clk 1:2:3:4] note} 1... e5 {[%eval 0.17,20]} *"));
+}
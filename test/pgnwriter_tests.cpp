@@ -0,0 +1,180 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "game.h"
+#include "pgnwriter.h"
+
+namespace {
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+bomchess::TagPairs MakeTags(const std::string& round) {
+  bomchess::TagPairs tags;
+  tags.Set(bomchess::tags::kEvent, "Test \"Open\"");
+  tags.Set(bomchess::tags::kRound, round);
+  tags.Set(bomchess::tags::kResult, "1-0");
+  tags.Set(bomchess::tags::kWhiteElo, "2700");
+  return tags;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(AppendPGNExportFormat) {
+  const bomchess::TagPairs tags = MakeTags("1");
+  const std::vector<std::string> moves{"e4", "e5", "Nf3", "Nc6", "Bb5"};
+  const std::vector<std::string> comments{"", "", "", "The main line", ""};
+  std::string buffer;
+  bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .comments = comments}, buffer);
+  BOOST_CHECK_EQUAL(buffer,
+                    "[Event \"Test \\\"Open\\\"\"]\n"
+                    "[Site \"?\"]\n"
+                    "[Date \"????.??.??\"]\n"
+                    "[Round \"1\"]\n"
+                    "[White \"?\"]\n"
+                    "[Black \"?\"]\n"
+                    "[Result \"1-0\"]\n"
+                    "[WhiteElo \"2700\"]\n"
+                    "\n"
+                    "1. e4 e5 2. Nf3 Nc6 {The main line} 3. Bb5 1-0\n"
+                    "\n");
+
+  // Starting from a set up position with black to move, and a comment after a white move.
+  buffer.clear();
+  const bomchess::TagPairs no_tags;
+  const std::vector<std::string> black_first{"Kg7", "Rd8", "Kf6"};
+  const std::vector<std::string> white_comment{"", "Only move", ""};
+  bomchess::AppendPGN({.tags = &no_tags,
+                       .san_moves = black_first,
+                       .comments = white_comment,
+                       .first_move_number = 40,
+                       .first_to_move = bomchess::Color::kBlack},
+                      buffer);
+  BOOST_CHECK(buffer.ends_with("\n\n40... Kg7 41. Rd8 {Only move} 41... Kf6 *\n\n"));
+}
+
+BOOST_AUTO_TEST_CASE(AppendPGNAnnotations) {
+  const bomchess::TagPairs tags;
+  const std::vector<std::string> moves{"e4", "e5", "Qh5"};
+  const std::vector<std::string> comments{"", "", "Early queen"};
+  const bomchess::MoveAnnotations annotations{
+      .clock_ms = {180000, 179500, bomchess::kNoAnnotation},
+      .evaluation = {17, -5, bomchess::MateEvaluation(-2)},
+  };
+  std::string buffer;
+  bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .comments = comments, .annotations = &annotations}, buffer);
+  BOOST_CHECK(buffer.ends_with(
+      "\n\n1. e4 {[%eval 0.17] [%clk 0:03:00]} 1... e5 {[%eval -0.05] [%clk 0:02:59.5]} 2.\n"
+      "Qh5 {[%eval #-2] Early queen} *\n\n"));
+
+  const bomchess::MoveAnnotations too_few{.elapsed_ms = {1000}};
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .annotations = &too_few}, buffer),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(AppendPGNCommands) {
+  const bomchess::TagPairs tags;
+  const std::vector<std::string> moves{"e4", "e5"};
+  const std::vector<std::string> comments{"Best by test", ""};
+  const bomchess::MoveAnnotations annotations{.clock_ms = {180000, bomchess::kNoAnnotation}};
+  const std::vector<bomchess::PgnCommand> commands{{0, "[%eval 0.17,20]"}, {1, "[%emt 0:00:02]"}};
+  std::string buffer;
+  bomchess::AppendPGN(
+      {.tags = &tags, .san_moves = moves, .comments = comments, .annotations = &annotations, .commands = commands},
+      buffer);
+  BOOST_CHECK(
+      buffer.ends_with("\n\n1. e4 {[%clk 0:03:00] [%eval 0.17,20] Best by test} 1... e5 {[%emt 0:00:02]} *\n\n"));
+
+  const std::vector<bomchess::PgnCommand> unsorted{{1, "[%clk 0:01:00]"}, {0, "[%clk 0:01:00]"}};
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .commands = unsorted}, buffer),
+                    std::invalid_argument);
+  const std::vector<bomchess::PgnCommand> past_end{{2, "[%clk 0:01:00]"}};
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .commands = past_end}, buffer),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(AppendPGNWrapsLines) {
+  const bomchess::TagPairs tags;
+  std::vector<std::string> moves;
+  std::vector<std::string> comments;
+  for (int i = 0; i < 100; ++i) {
+    moves.emplace_back(i % 2 == 0 ? "Nf3" : "Nf6");
+    comments.emplace_back(i % 7 == 0 ? "a fairly long comment that has to be split over more than one line" : "");
+  }
+  std::string buffer;
+  bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .comments = comments}, buffer);
+  std::istringstream lines(buffer);
+  std::string unwrapped;
+  for (std::string line; std::getline(lines, line);) {
+    BOOST_CHECK_LE(line.size(), bomchess::kPgnLineLength);
+    if (!line.starts_with('[') && !line.empty()) {
+      unwrapped += unwrapped.empty() ? line : ' ' + line;
+    }
+  }
+  BOOST_CHECK(unwrapped.starts_with("1. Nf3 {a fairly long comment that has to be split over more than one line}"));
+  BOOST_CHECK(unwrapped.ends_with("more than one line} 50... Nf6 *"));
+}
+
+BOOST_AUTO_TEST_CASE(AppendPGNThrows) {
+  const bomchess::TagPairs tags;
+  const std::vector<std::string> moves{"e4", "e5"};
+  const std::vector<std::string> one_comment{"Too few"};
+  const std::vector<std::string> bad_comment{"", "Ends} early"};
+  std::string buffer;
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.san_moves = moves}, buffer), std::invalid_argument);
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .comments = one_comment}, buffer),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .comments = bad_comment}, buffer),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(
+      bomchess::AppendPGN({.tags = &tags, .san_moves = moves, .first_to_move = bomchess::Color::kNone}, buffer),
+      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(PgnWriterKeepsGameOrder) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bomchess_pgnwriter_tests.pgn";
+  std::vector<bomchess::TagPairs> tags;
+  std::vector<std::vector<std::string>> moves;
+  for (int i = 0; i < 2000; ++i) {
+    tags.push_back(MakeTags(std::to_string(i)));
+    moves.emplace_back(static_cast<size_t>(i % 37), i % 3 == 0 ? "O-O" : "Qxe7+");
+  }
+  std::vector<bomchess::PgnGameView> games;
+  std::string expected;
+  for (size_t i = 0; i < tags.size(); ++i) {
+    games.push_back({.tags = &tags.at(i), .san_moves = moves.at(i)});
+    bomchess::AppendPGN(games.back(), expected);
+  }
+
+  {
+    bomchess::PgnWriter writer(path, 4);
+    writer.Write(games);
+    writer.Write(std::span(games).first(1));
+    writer.Write({});
+  }
+  bomchess::AppendPGN(games.front(), expected);
+  BOOST_CHECK(ReadFile(path) == expected);
+
+  // A bad game stops the export, but everything in earlier chunks is already written.
+  games.at(1500).tags = nullptr;
+  {
+    bomchess::PgnWriter writer(path, 3);
+    BOOST_CHECK_THROW(writer.Write(games), std::invalid_argument);
+  }
+  BOOST_CHECK(expected.starts_with(ReadFile(path)));
+  BOOST_CHECK_GT(ReadFile(path).size(), expected.size() / 2);
+  std::filesystem::remove(path);
+
+  BOOST_CHECK_THROW(bomchess::PgnWriter(std::filesystem::temp_directory_path() / "bomchess_missing_dir" / "a.pgn", 1),
+                    std::runtime_error);
+}
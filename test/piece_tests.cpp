@@ -58,4 +58,12 @@ BOOST_AUTO_TEST_CASE(PieceHash) {
   std::unordered_set<bomchess::Piece> test_set;
   BOOST_CHECK_NO_THROW(test_set.insert(bomchess::pieces::kBlackBishop));
   BOOST_CHECK_NO_THROW(test_set.insert(bomchess::pieces::kWhiteKing));
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(PieceValue) {
+  BOOST_CHECK_EQUAL(bomchess::PieceValue(bomchess::PieceType::kPawn), 100);
+  BOOST_CHECK_EQUAL(bomchess::PieceValue(bomchess::PieceType::kQueen), 900);
+  BOOST_CHECK_EQUAL(bomchess::PieceValue(bomchess::PieceType::kKing), 0);
+  BOOST_CHECK_EQUAL(bomchess::PieceValue(bomchess::PieceType::kNone), 0);
+  BOOST_CHECK_LT(bomchess::PieceValue(bomchess::PieceType::kKnight), bomchess::PieceValue(bomchess::PieceType::kRook));
+}
@@ -0,0 +1,177 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "bitboard.h"
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "positionbatch.h"
+#include "square.h"
+
+namespace {
+// One king per side plus a handful of random pieces. Pawns can land on any rank, which is fine for these queries.
+std::vector<bomchess::Position> RandomPositions(const size_t count, const uint64_t seed) {
+  std::mt19937_64 random(seed);
+  std::uniform_int_distribution<int> square_distribution(0, 63);
+  std::uniform_int_distribution<int> type_distribution(0, 4);
+  std::uniform_int_distribution<int> piece_count_distribution(0, 12);
+  std::vector<bomchess::Position> positions;
+  for (size_t i = 0; i < count; ++i) {
+    bomchess::Position position;
+    position.at(static_cast<bomchess::Square>(square_distribution(random))) = bomchess::pieces::kWhiteKing;
+    bomchess::Square black_king = static_cast<bomchess::Square>(square_distribution(random));
+    while (position.at(black_king) != bomchess::pieces::kNone) {
+      black_king = static_cast<bomchess::Square>(square_distribution(random));
+    }
+    position.at(black_king) = bomchess::pieces::kBlackKing;
+    for (int piece_count = piece_count_distribution(random); piece_count > 0; --piece_count) {
+      const auto square = static_cast<bomchess::Square>(square_distribution(random));
+      if (position.at(square) == bomchess::pieces::kNone) {
+        position.at(square) = {static_cast<bomchess::Color>(random() % 2),
+                               static_cast<bomchess::PieceType>(type_distribution(random))};
+      }
+    }
+    positions.push_back(position);
+  }
+  return positions;
+}
+
+bool ReferenceInCheck(const bomchess::Position& position, const bomchess::Color color) {
+  const bomchess::PositionBitboards bitboards = bomchess::MakeBitboards(position);
+  const bomchess::Color enemy = color == bomchess::Color::kWhite ? bomchess::Color::kBlack : bomchess::Color::kWhite;
+  for (const bomchess::Square square : bomchess::kAllSquares) {
+    if (position.at(square) == bomchess::Piece{color, bomchess::PieceType::kKing} &&
+        (bomchess::AttackersTo(bitboards, square, bitboards.Occupied()) & bitboards.Pieces(enemy)) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(PositionBatchRoundTrip) {
+  const std::vector<bomchess::Position> positions = RandomPositions(200, 1);
+  bomchess::PositionBatch batch(positions);
+  BOOST_REQUIRE_EQUAL(batch.Size(), positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    BOOST_CHECK(batch.Get(i) == positions.at(i));
+  }
+  const bomchess::PositionBitboards bitboards = bomchess::MakeBitboards(positions.at(7));
+  BOOST_CHECK_EQUAL(batch.Column(bomchess::pieces::kBlackKnight)[7],
+                    bitboards.Pieces(bomchess::pieces::kBlackKnight));
+  batch.Clear();
+  BOOST_CHECK_EQUAL(batch.Size(), 0);
+  BOOST_CHECK(batch == bomchess::PositionBatch());
+}
+
+BOOST_AUTO_TEST_CASE(PositionBatchMaterial) {
+  const std::vector<bomchess::Position> positions = RandomPositions(300, 2);
+  const bomchess::PositionBatch batch(positions);
+  const std::vector<uint8_t> white_rooks = batch.PieceCounts(bomchess::pieces::kWhiteRook);
+  const std::vector<int> balance = batch.MaterialBalance();
+  for (size_t i = 0; i < positions.size(); ++i) {
+    int rooks = 0;
+    int expected_balance = 0;
+    for (const bomchess::Piece piece : positions.at(i)) {
+      rooks += piece == bomchess::pieces::kWhiteRook ? 1 : 0;
+      if (piece != bomchess::pieces::kNone) {
+        expected_balance += bomchess::PieceValue(piece.type) * (piece.color == bomchess::Color::kWhite ? 1 : -1);
+      }
+    }
+    BOOST_CHECK_EQUAL(white_rooks.at(i), rooks);
+    BOOST_CHECK_EQUAL(balance.at(i), expected_balance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PositionBatchPieceSquareFeatures) {
+  const std::vector<bomchess::Position> positions = RandomPositions(50, 3);
+  std::vector<uint16_t> features;
+  std::vector<uint32_t> offsets;
+  bomchess::PositionBatch(positions).PieceSquareFeatures(features, offsets);
+  BOOST_REQUIRE_EQUAL(offsets.size(), positions.size() + 1);
+  BOOST_CHECK_EQUAL(offsets.back(), features.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    std::vector<uint16_t> expected;
+    for (const bomchess::Square square : bomchess::kAllSquares) {
+      const bomchess::Piece piece = positions.at(i).at(square);
+      if (piece != bomchess::pieces::kNone) {
+        expected.push_back(static_cast<uint16_t>(std::to_underlying(piece.color) * 384 +
+                                                 std::to_underlying(piece.type) * 64 + std::to_underlying(square)));
+      }
+    }
+    std::vector<uint16_t> actual(features.begin() + offsets.at(i), features.begin() + offsets.at(i + 1));
+    std::ranges::sort(expected);
+    std::ranges::sort(actual);
+    BOOST_CHECK(actual == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PositionBatchKingInCheck) {
+  std::vector<bomchess::Position> positions = RandomPositions(500, 4);
+  // A bishop check blocked by a pawn, then unblocked.
+  bomchess::Position blocked;
+  blocked.at(bomchess::Square::kE1) = bomchess::pieces::kWhiteKing;
+  blocked.at(bomchess::Square::kE8) = bomchess::pieces::kBlackKing;
+  blocked.at(bomchess::Square::kB4) = bomchess::pieces::kBlackBishop;
+  blocked.at(bomchess::Square::kD2) = bomchess::pieces::kWhitePawn;
+  positions.push_back(blocked);
+  blocked.at(bomchess::Square::kD2) = bomchess::pieces::kNone;
+  positions.push_back(blocked);
+
+  const bomchess::PositionBatch batch(positions);
+  for (const bomchess::Color color : {bomchess::Color::kWhite, bomchess::Color::kBlack}) {
+    const std::vector<uint8_t> in_check = batch.KingInCheck(color);
+    int checks = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+      BOOST_CHECK_EQUAL(in_check.at(i) != 0, ReferenceInCheck(positions.at(i), color));
+      checks += in_check.at(i);
+    }
+    BOOST_CHECK_GT(checks, 0);
+  }
+  const std::vector<uint8_t> white_in_check = batch.KingInCheck(bomchess::Color::kWhite);
+  BOOST_CHECK_EQUAL(white_in_check.at(positions.size() - 2), 0);
+  BOOST_CHECK_EQUAL(white_in_check.at(positions.size() - 1), 1);
+  BOOST_CHECK_THROW(std::ignore = batch.KingInCheck(bomchess::Color::kNone), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(PositionBatchEqualityAndHashes) {
+  const std::vector<bomchess::Position> positions = RandomPositions(100, 5);
+  std::vector<bomchess::Position> others = positions;
+  // A piece changing color or type, and a piece moving.
+  others.at(3).at(bomchess::Square::kD4) = bomchess::pieces::kWhiteQueen;
+  others.at(4).at(bomchess::Square::kD4) = bomchess::pieces::kBlackQueen;
+  others.at(5) = others.at(4);
+  others.at(5).at(bomchess::Square::kD4) = bomchess::pieces::kNone;
+  others.at(5).at(bomchess::Square::kD5) = bomchess::pieces::kBlackQueen;
+  const bomchess::PositionBatch batch(positions);
+  const bomchess::PositionBatch other_batch(others);
+
+  const std::vector<uint8_t> equal = batch.Equal(other_batch);
+  const std::vector<uint64_t> hashes = batch.Hashes();
+  const std::vector<uint64_t> other_hashes = other_batch.Hashes();
+  for (size_t i = 0; i < positions.size(); ++i) {
+    BOOST_CHECK_EQUAL(equal.at(i) != 0, positions.at(i) == others.at(i));
+    BOOST_CHECK_EQUAL(hashes.at(i) == other_hashes.at(i), positions.at(i) == others.at(i));
+  }
+  BOOST_CHECK_NE(other_hashes.at(4), other_hashes.at(5));
+  BOOST_CHECK_THROW(std::ignore = batch.Equal(bomchess::PositionBatch()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(PositionBatchThrows) {
+  bomchess::PositionBatch batch;
+  bomchess::Position invalid;
+  invalid.at(bomchess::Square::kA1) = {bomchess::Color::kWhite, bomchess::PieceType::kNone};
+  BOOST_CHECK_THROW(batch.Add(invalid), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = batch.Get(0), std::out_of_range);
+  BOOST_CHECK_THROW(std::ignore = batch.Column(bomchess::pieces::kNone), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = batch.PieceCounts({bomchess::Color::kNone, bomchess::PieceType::kPawn}),
+                    std::invalid_argument);
+}
@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "route.h"
+#include "square.h"
+#include "test_positions.h"
+
+namespace {
+constexpr std::array<bomchess::Piece, 7> kPieces{
+    bomchess::pieces::kWhitePawn,   bomchess::pieces::kBlackPawn,  bomchess::pieces::kWhiteRook,
+    bomchess::pieces::kWhiteKnight, bomchess::pieces::kBlackBishop, bomchess::pieces::kBlackQueen,
+    bomchess::pieces::kWhiteKing};
+
+// White: Ra1, Pa4, Nb2, Pe2. Black: Pc1, Pd3, Ke3.
+bomchess::Position MakePosition() {
+  return bomchess::testing::MakePosition({{bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                           {bomchess::Square::kA4, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kB2, bomchess::pieces::kWhiteKnight},
+                                           {bomchess::Square::kE2, bomchess::pieces::kWhitePawn},
+                                           {bomchess::Square::kC1, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kD3, bomchess::pieces::kBlackPawn},
+                                           {bomchess::Square::kE3, bomchess::pieces::kBlackKing}});
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(PieceDistance) {
+  using bomchess::Square;
+  namespace pieces = bomchess::pieces;
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhitePawn, Square::kE2, Square::kE4), 1);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhitePawn, Square::kE2, Square::kE5), 2);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhitePawn, Square::kE3, Square::kE5), 2);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhitePawn, Square::kE2, Square::kD3), bomchess::kUnreachable);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhitePawn, Square::kE4, Square::kE2), bomchess::kUnreachable);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kBlackPawn, Square::kE7, Square::kE1), 5);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kBlackRook, Square::kA1, Square::kA8), 1);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kBlackRook, Square::kA1, Square::kH8), 2);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhiteBishop, Square::kA1, Square::kH8), 1);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhiteBishop, Square::kA1, Square::kE3), 2);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhiteBishop, Square::kA1, Square::kB3), bomchess::kUnreachable);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhiteQueen, Square::kA1, Square::kB3), 2);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kBlackKing, Square::kA1, Square::kH8), 7);
+  BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kWhiteKnight, Square::kA1, Square::kH8), 6);
+  for (const bomchess::Square from : bomchess::kAllSquares) {
+    for (const bomchess::Square to : bomchess::kAllSquares) {
+      BOOST_CHECK_EQUAL(bomchess::PieceDistance(pieces::kBlackKnight, from, to), bomchess::KnightDistance(from, to));
+    }
+  }
+  BOOST_CHECK_THROW(std::ignore = bomchess::PieceDistance(pieces::kNone, Square::kA1, Square::kA2),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::PieceDistance(pieces::kWhiteKing, Square::kNone, Square::kA2),
+                    std::invalid_argument);
+}
+
+// With nothing else on the board, the search has to agree with the tables.
+BOOST_AUTO_TEST_CASE(RouteDistancesMatchEmptyBoard) {
+  for (const bomchess::Piece piece : kPieces) {
+    for (const bomchess::Square from : bomchess::kAllSquares) {
+      bomchess::Position position;
+      position.at(from) = piece;
+      const std::array<int8_t, 64> distances = bomchess::RouteDistances(position, from);
+      for (const bomchess::Square to : bomchess::kAllSquares) {
+        BOOST_CHECK_EQUAL(distances.at(std::to_underlying(to)), bomchess::PieceDistance(piece, from, to));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FindRouteAroundPieces) {
+  using bomchess::Square;
+  const bomchess::Position position = MakePosition();
+  // The pawn on a4 and knight on b2 leave a1 a3 b3 b8 a8. The rook can't go on through c1 after capturing there, so
+  // d1 takes a1 a3 c3 c2 d2 d1.
+  const bomchess::PieceRoute to_a8 = bomchess::FindRoute(position, Square::kA1, Square::kA8);
+  BOOST_CHECK_EQUAL(to_a8.distance, 4);
+  const bomchess::PieceRoute to_d1 = bomchess::FindRoute(position, Square::kA1, Square::kD1);
+  BOOST_CHECK_EQUAL(to_d1.distance, 5);
+  const bomchess::PieceRoute to_c1 = bomchess::FindRoute(position, Square::kA1, Square::kC1);
+  BOOST_CHECK(to_c1.squares == std::vector<Square>({Square::kA1, Square::kC1}));
+
+  for (const bomchess::PieceRoute& route : {to_a8, to_d1}) {
+    BOOST_REQUIRE_EQUAL(route.squares.size(), route.distance + 1);
+    BOOST_CHECK(route.squares.front() == Square::kA1);
+    for (size_t i = 1; i < route.squares.size(); ++i) {
+      const Square from = route.squares.at(i - 1);
+      const Square to = route.squares.at(i);
+      BOOST_CHECK_EQUAL(bomchess::PieceDistance(bomchess::pieces::kWhiteRook, from, to), 1);
+      BOOST_CHECK_EQUAL(bomchess::FindRoute(position, Square::kA1, to).distance, i);
+    }
+  }
+  BOOST_CHECK(to_a8.squares.back() == Square::kA8);
+  BOOST_CHECK(to_d1.squares.back() == Square::kD1);
+
+  // Own pieces can't be captured, and the pawn only captures diagonally.
+  BOOST_CHECK_EQUAL(bomchess::FindRoute(position, Square::kA1, Square::kA4).distance, bomchess::kUnreachable);
+  BOOST_CHECK(bomchess::FindRoute(position, Square::kA1, Square::kA4).squares.empty());
+  BOOST_CHECK_EQUAL(bomchess::FindRoute(position, Square::kE2, Square::kD3).distance, 1);
+  BOOST_CHECK_EQUAL(bomchess::FindRoute(position, Square::kE2, Square::kE4).distance, bomchess::kUnreachable);
+  BOOST_CHECK_EQUAL(bomchess::FindRoute(position, Square::kB2, Square::kB2).distance, 0);
+  BOOST_CHECK(bomchess::FindRoute(position, Square::kB2, Square::kB2).squares == std::vector<Square>({Square::kB2}));
+}
+
+BOOST_AUTO_TEST_CASE(RouteDistancesBatch) {
+  const bomchess::Position position = MakePosition();
+  const std::array<std::array<int8_t, 64>, 64> distances = bomchess::RouteDistances(position);
+  for (const bomchess::Square from : bomchess::kAllSquares) {
+    for (const bomchess::Square to : bomchess::kAllSquares) {
+      const int8_t distance = distances.at(std::to_underlying(from)).at(std::to_underlying(to));
+      if (position.at(from) == bomchess::pieces::kNone) {
+        BOOST_CHECK_EQUAL(distance, bomchess::kUnreachable);
+      } else {
+        BOOST_CHECK_EQUAL(distance, bomchess::FindRoute(position, from, to).distance);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FindRouteThrows) {
+  const bomchess::Position position = MakePosition();
+  BOOST_CHECK_THROW(std::ignore = bomchess::FindRoute(position, bomchess::Square::kH8, bomchess::Square::kH1),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::FindRoute(position, bomchess::Square::kA1, bomchess::Square::kNone),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::RouteDistances(position, bomchess::Square::kH8), std::invalid_argument);
+}
@@ -0,0 +1,230 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "piece.h"
+#include "position.h"
+#include "search.h"
+#include "square.h"
+#include "test_networks.h"
+#include "test_positions.h"
+#include "transpositiontable.h"
+
+namespace {
+using bomchess::testing::MakePosition;
+using bomchess::testing::WriteValue;
+
+constexpr int kHiddenSize = 16;
+
+// Counts material: the first hidden neuron is 128 plus an eighth of the side's material lead, and the output takes it
+// from one perspective minus the other, which comes out within a few centipawns of the lead.
+bomchess::NnueNetwork MaterialNetwork() {
+  constexpr std::array<int16_t, 6> kWeights{12, 62, 40, 41, 112, 0};
+  std::ostringstream network;
+  network << "BNUE";
+  WriteValue(network, static_cast<uint32_t>(kHiddenSize));
+  for (int feature = 0; feature < 768; ++feature) {
+    const int16_t weight = kWeights.at((feature % 384) / 64);
+    for (int neuron = 0; neuron < kHiddenSize; ++neuron) {
+      WriteValue(network, static_cast<int16_t>(neuron != 0 ? 0 : feature < 384 ? weight : -weight));
+    }
+  }
+  for (int neuron = 0; neuron < kHiddenSize; ++neuron) {
+    WriteValue(network, static_cast<int16_t>(neuron == 0 ? 128 : 0));
+  }
+  for (int i = 0; i < 2 * kHiddenSize; ++i) {
+    WriteValue(network, static_cast<int16_t>(i == 0 ? 163 : i == kHiddenSize ? -163 : 0));
+  }
+  WriteValue(network, int32_t{0});
+  std::istringstream network_stream(network.str());
+  return bomchess::NnueNetwork(network_stream);
+}
+
+bomchess::PositionState MakeState(const bomchess::Position& position, const bomchess::Color side_to_move) {
+  bomchess::PositionState state;
+  state.position = position;
+  state.side_to_move = side_to_move;
+  return state;
+}
+
+// Ra8 mates.
+const bomchess::Position kBackRankMate = MakePosition({{bomchess::Square::kG1, bomchess::pieces::kWhiteKing},
+                                                       {bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                                       {bomchess::Square::kG8, bomchess::pieces::kBlackKing},
+                                                       {bomchess::Square::kF7, bomchess::pieces::kBlackPawn},
+                                                       {bomchess::Square::kG7, bomchess::pieces::kBlackPawn},
+                                                       {bomchess::Square::kH7, bomchess::pieces::kBlackPawn}});
+const bomchess::Move kBackRankMateMove{bomchess::Square::kA1, bomchess::Square::kA8, bomchess::PieceType::kNone};
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SearchFindsMate) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table);
+  const bomchess::SearchResult result =
+      searcher.Search(MakeState(kBackRankMate, bomchess::Color::kWhite), {.depth = 3});
+  BOOST_CHECK_EQUAL(result.best_move, kBackRankMateMove);
+  BOOST_CHECK_EQUAL(result.info.score, bomchess::kMateScore - 1);
+  BOOST_CHECK_EQUAL(result.info.depth, 3);
+  BOOST_REQUIRE_EQUAL(result.info.principal_variation.size(), 1);
+  BOOST_CHECK(result.stop_reason == bomchess::SearchStopReason::kDepth);
+  BOOST_CHECK_GT(result.info.nodes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SearchNoLegalMoves) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table);
+
+  bomchess::Position mated = kBackRankMate;
+  mated.at(bomchess::Square::kA1) = bomchess::pieces::kNone;
+  mated.at(bomchess::Square::kA8) = bomchess::pieces::kWhiteRook;
+  const bomchess::SearchResult mated_result = searcher.Search(MakeState(mated, bomchess::Color::kBlack), {.depth = 2});
+  BOOST_CHECK_EQUAL(mated_result.best_move, bomchess::kNullMove);
+  BOOST_CHECK_EQUAL(mated_result.info.score, -bomchess::kMateScore);
+
+  const bomchess::Position stalemate = MakePosition({{bomchess::Square::kC7, bomchess::pieces::kWhiteKing},
+                                                     {bomchess::Square::kB6, bomchess::pieces::kWhiteQueen},
+                                                     {bomchess::Square::kA8, bomchess::pieces::kBlackKing}});
+  const bomchess::SearchResult stalemate_result =
+      searcher.Search(MakeState(stalemate, bomchess::Color::kBlack), {.depth = 2});
+  BOOST_CHECK_EQUAL(stalemate_result.best_move, bomchess::kNullMove);
+  BOOST_CHECK_EQUAL(stalemate_result.info.score, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SearchCaptures) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table);
+
+  const bomchess::Position hanging_queen = MakePosition({{bomchess::Square::kH1, bomchess::pieces::kWhiteKing},
+                                                         {bomchess::Square::kD1, bomchess::pieces::kWhiteRook},
+                                                         {bomchess::Square::kD5, bomchess::pieces::kBlackQueen},
+                                                         {bomchess::Square::kH8, bomchess::pieces::kBlackKing}});
+  const bomchess::SearchResult capture =
+      searcher.Search(MakeState(hanging_queen, bomchess::Color::kWhite), {.depth = 2});
+  BOOST_CHECK_EQUAL(capture.best_move,
+                    bomchess::Move(bomchess::Square::kD1, bomchess::Square::kD5, bomchess::PieceType::kNone));
+  BOOST_CHECK_GT(capture.info.score, 400);
+
+  // At depth 1 only the quiescence search sees the pawn recapture the queen.
+  const bomchess::Position defended_pawn = MakePosition({{bomchess::Square::kH1, bomchess::pieces::kWhiteKing},
+                                                         {bomchess::Square::kD1, bomchess::pieces::kWhiteQueen},
+                                                         {bomchess::Square::kD5, bomchess::pieces::kBlackPawn},
+                                                         {bomchess::Square::kE6, bomchess::pieces::kBlackPawn},
+                                                         {bomchess::Square::kH8, bomchess::pieces::kBlackKing}});
+  table.Clear();
+  const bomchess::SearchResult no_capture =
+      searcher.Search(MakeState(defended_pawn, bomchess::Color::kWhite), {.depth = 1});
+  BOOST_CHECK_NE(no_capture.best_move,
+                 bomchess::Move(bomchess::Square::kD1, bomchess::Square::kD5, bomchess::PieceType::kNone));
+  BOOST_CHECK_GT(no_capture.info.score, 500);
+}
+
+BOOST_AUTO_TEST_CASE(SearchThreads) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table, 4);
+  const bomchess::SearchResult result =
+      searcher.Search(MakeState(kBackRankMate, bomchess::Color::kWhite), {.depth = 4});
+  BOOST_CHECK_EQUAL(result.best_move, kBackRankMateMove);
+  BOOST_CHECK_EQUAL(result.info.score, bomchess::kMateScore - 1);
+
+  const bomchess::PositionState start{bomchess::testing::StartingPosition(), bomchess::Color::kWhite,
+                                      {{{true, true}, {true, true}}}};
+  const bomchess::SearchResult start_result = searcher.Search(start, {.depth = 4});
+  BOOST_CHECK_NE(start_result.best_move, bomchess::kNullMove);
+  BOOST_CHECK_LT(std::abs(start_result.info.score), 100);
+}
+
+BOOST_AUTO_TEST_CASE(SearchReportsIterations) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table);
+  const bomchess::PositionState start{bomchess::testing::StartingPosition(), bomchess::Color::kWhite,
+                                      {{{true, true}, {true, true}}}};
+
+  std::vector<int> depths;
+  std::vector<bomchess::SearchStopReason> stop_reasons;
+  bomchess::SearchCallbacks callbacks;
+  callbacks.iteration = [&depths](const bomchess::SearchInfo& info) {
+    depths.push_back(info.depth);
+    BOOST_CHECK(!info.principal_variation.empty());
+  };
+  callbacks.stopped = [&stop_reasons](const bomchess::SearchStopReason reason, const bomchess::SearchInfo&) {
+    stop_reasons.push_back(reason);
+  };
+  const bomchess::SearchResult result = searcher.Search(start, {.depth = 3}, callbacks);
+  BOOST_CHECK(depths == std::vector<int>({1, 2, 3}));
+  BOOST_CHECK(stop_reasons == std::vector<bomchess::SearchStopReason>{bomchess::SearchStopReason::kDepth});
+  BOOST_CHECK_EQUAL(result.info.depth, 3);
+
+  // Stopping from a callback keeps the iteration that just completed.
+  callbacks.iteration = [&searcher](const bomchess::SearchInfo& info) {
+    if (info.depth == 2) {
+      searcher.Stop();
+    }
+  };
+  stop_reasons.clear();
+  const bomchess::SearchResult stopped = searcher.Search(start, {}, callbacks);
+  BOOST_CHECK(stop_reasons == std::vector<bomchess::SearchStopReason>{bomchess::SearchStopReason::kStopped});
+  BOOST_CHECK_EQUAL(stopped.info.depth, 2);
+
+  // A stop that comes before the search starts isn't lost, and isn't kept for the search after.
+  searcher.Stop();
+  const bomchess::SearchResult stopped_early = searcher.Search(start, {.depth = 3});
+  BOOST_CHECK(stopped_early.stop_reason == bomchess::SearchStopReason::kStopped);
+  BOOST_CHECK(!stopped_early.info.principal_variation.empty());
+  BOOST_CHECK_NE(stopped_early.best_move, bomchess::kNullMove);
+  const bomchess::SearchResult after_stop = searcher.Search(start, {.depth = 3});
+  BOOST_CHECK(after_stop.stop_reason == bomchess::SearchStopReason::kDepth);
+  BOOST_CHECK_EQUAL(after_stop.info.depth, 3);
+}
+
+BOOST_AUTO_TEST_CASE(SearchStopsAtLimits) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  bomchess::Searcher searcher(network, table, 2);
+  const bomchess::PositionState start{bomchess::testing::StartingPosition(), bomchess::Color::kWhite,
+                                      {{{true, true}, {true, true}}}};
+
+  const bomchess::SearchResult node_limited = searcher.Search(start, {.nodes = 5000});
+  BOOST_CHECK(node_limited.stop_reason == bomchess::SearchStopReason::kNodes);
+  BOOST_CHECK_GE(node_limited.info.nodes, 5000);
+  // Each thread checks the limit every 1024 nodes.
+  BOOST_CHECK_LT(node_limited.info.nodes, 5000 + 2 * 1024);
+  BOOST_CHECK_NE(node_limited.best_move, bomchess::kNullMove);
+
+  const bomchess::SearchResult time_limited = searcher.Search(start, {.move_time = 50});
+  BOOST_CHECK(time_limited.stop_reason == bomchess::SearchStopReason::kTime);
+  BOOST_CHECK_GE(time_limited.info.time, 50);
+  BOOST_CHECK_NE(time_limited.best_move, bomchess::kNullMove);
+}
+
+BOOST_AUTO_TEST_CASE(SearchThrows) {
+  const bomchess::NnueNetwork network = MaterialNetwork();
+  bomchess::TranspositionTable table(1);
+  BOOST_CHECK_THROW(bomchess::Searcher(network, table, 0), std::invalid_argument);
+
+  bomchess::Searcher searcher(network, table);
+  BOOST_CHECK_THROW(searcher.Search(MakeState(kBackRankMate, bomchess::Color::kWhite), {.depth = 0}),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(searcher.Search(MakeState(kBackRankMate, bomchess::Color::kNone), {.depth = 1}),
+                    std::invalid_argument);
+  const bomchess::Position no_black_king = MakePosition({{bomchess::Square::kG1, bomchess::pieces::kWhiteKing}});
+  BOOST_CHECK_THROW(searcher.Search(MakeState(no_black_king, bomchess::Color::kWhite), {.depth = 1}),
+                    std::invalid_argument);
+}
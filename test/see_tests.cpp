@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "boost/test/unit_test.hpp"
+
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "see.h"
+#include "square.h"
+#include "test_positions.h"
+
+namespace {
+using bomchess::testing::MakePosition;
+
+// SEEGreaterEqual has to agree with SEE right at the boundary.
+void CheckSEE(const bomchess::Position& position, const bomchess::Move move, const int expected) {
+  BOOST_CHECK_EQUAL(bomchess::SEE(position, move), expected);
+  BOOST_CHECK(bomchess::SEEGreaterEqual(position, move, expected));
+  BOOST_CHECK(!bomchess::SEEGreaterEqual(position, move, expected + 1));
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SEESimpleCaptures) {
+  using bomchess::Square;
+  namespace pieces = bomchess::pieces;
+  const bomchess::Position position = MakePosition({{Square::kD1, pieces::kWhiteQueen},
+                                                    {Square::kE4, pieces::kWhitePawn},
+                                                    {Square::kD5, pieces::kBlackKnight},
+                                                    {Square::kC6, pieces::kBlackPawn},
+                                                    {Square::kH5, pieces::kBlackPawn}});
+  // PxN PxP QxP
+  CheckSEE(position, bomchess::FromUCI("e4d5"), 320);
+  CheckSEE(position, bomchess::FromUCI("d1d5"), 320 - 900 + 100);
+  CheckSEE(position, bomchess::FromUCI("d1h5"), 100);
+  // A quiet move is worth nothing if the piece is safe, and minus the piece if it hangs.
+  CheckSEE(position, bomchess::FromUCI("d1d3"), 0);
+  CheckSEE(position, bomchess::FromUCI("d1a4"), 0);
+  CheckSEE(MakePosition({{Square::kD3, pieces::kWhiteQueen}, {Square::kC6, pieces::kBlackPawn}}),
+           bomchess::FromUCI("d3b5"), -900);
+}
+
+BOOST_AUTO_TEST_CASE(SEEXRays) {
+  using bomchess::Square;
+  namespace pieces = bomchess::pieces;
+  // The rook on e1 backs up the rook on e2 through it.
+  const bomchess::Position doubled_rooks = MakePosition({{Square::kE1, pieces::kWhiteRook},
+                                                         {Square::kE2, pieces::kWhiteRook},
+                                                         {Square::kE5, pieces::kBlackPawn},
+                                                         {Square::kE8, pieces::kBlackRook}});
+  CheckSEE(doubled_rooks, bomchess::FromUCI("e2e5"), 100);
+  // Without the second rook, the first is lost.
+  bomchess::Position single_rook = doubled_rooks;
+  single_rook.at(Square::kE1) = pieces::kNone;
+  CheckSEE(single_rook, bomchess::FromUCI("e2e5"), 100 - 500);
+
+  // The black queen behind the rook defends d5 once the rook has captured.
+  const bomchess::Position battery = MakePosition({{Square::kC3, pieces::kWhiteKnight},
+                                                   {Square::kF4, pieces::kWhiteKnight},
+                                                   {Square::kD5, pieces::kBlackPawn},
+                                                   {Square::kD7, pieces::kBlackRook},
+                                                   {Square::kD8, pieces::kBlackQueen}});
+  // NxP RxN NxR QxN
+  CheckSEE(battery, bomchess::FromUCI("c3d5"), 100 - 320 + 500 - 320);
+}
+
+BOOST_AUTO_TEST_CASE(SEEKingCaptures) {
+  using bomchess::Square;
+  namespace pieces = bomchess::pieces;
+  bomchess::Position position = MakePosition(
+      {{Square::kF3, pieces::kWhiteQueen}, {Square::kF7, pieces::kBlackPawn}, {Square::kG8, pieces::kBlackKing}});
+  CheckSEE(position, bomchess::FromUCI("f3f7"), 100 - 900);
+  // The bishop defends f7, so the king can't take back.
+  position.at(Square::kC4) = pieces::kWhiteBishop;
+  CheckSEE(position, bomchess::FromUCI("f3f7"), 100);
+
+  // BxP NxB QxN KxQ
+  position.at(Square::kE5) = pieces::kBlackKnight;
+  CheckSEE(position, bomchess::FromUCI("c4f7"), 100 - 330);
+  // The rook behind the queen stops the king from taking back, so the exchange ends after QxN.
+  position.at(Square::kF1) = pieces::kWhiteRook;
+  CheckSEE(position, bomchess::FromUCI("c4f7"), 100 - 330 + 320);
+}
+
+BOOST_AUTO_TEST_CASE(SEESpecialMoves) {
+  using bomchess::Square;
+  namespace pieces = bomchess::pieces;
+  // En passant: the rook on d8 defends d6.
+  const bomchess::Position en_passant = MakePosition(
+      {{Square::kE5, pieces::kWhitePawn}, {Square::kD5, pieces::kBlackPawn}, {Square::kD8, pieces::kBlackRook}});
+  CheckSEE(en_passant, bomchess::FromUCI("e5d6"), 0);
+  // Taking the pawn opens the d file, so the rook on d1 backs up the capturing pawn.
+  const bomchess::Position opened_file = MakePosition({{Square::kC5, pieces::kWhitePawn},
+                                                       {Square::kD1, pieces::kWhiteRook},
+                                                       {Square::kD5, pieces::kBlackPawn},
+                                                       {Square::kD8, pieces::kBlackRook}});
+  CheckSEE(opened_file, bomchess::FromUCI("c5d6"), 100);
+
+  const bomchess::Position promotion =
+      MakePosition({{Square::kE7, pieces::kWhitePawn}, {Square::kA8, pieces::kBlackRook}});
+  CheckSEE(promotion, bomchess::FromUCI("e7e8q"), 900 - 100 - 900);
+  CheckSEE(promotion, bomchess::FromUCI("e7e8n"), 320 - 100 - 320);
+  CheckSEE(promotion, bomchess::FromUCI("e7e6"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SEEThrows) {
+  const bomchess::Position position;
+  BOOST_CHECK_THROW(std::ignore = bomchess::SEE(position, bomchess::FromUCI("e2e4")), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::SEEGreaterEqual(position, bomchess::FromUCI("e2e4"), 0),
+                    std::invalid_argument);
+  const bomchess::Move no_move{bomchess::Square::kNone, bomchess::Square::kE4, bomchess::PieceType::kNone};
+  BOOST_CHECK_THROW(std::ignore = bomchess::SEE(position, no_move), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::SEEGreaterEqual(position, no_move, 0), std::invalid_argument);
+}
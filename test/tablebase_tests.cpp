@@ -0,0 +1,422 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "move.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "tablebase.h"
+#include "test_positions.h"
+
+namespace {
+using bomchess::testing::MakePosition;
+
+void WriteFile(const std::filesystem::path& path, const std::string& contents) {
+  std::ofstream file(path, std::ios::binary);
+  file << contents;
+}
+
+std::filesystem::path MakeTableDirectory() {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "bomchess_tablebase_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directory(directory);
+  WriteFile(directory / "KQvKR.rtbw", std::string("\x71\xE8\x23\x5D", 4) + "wdl data");
+  WriteFile(directory / "KQvKR.rtbz", std::string("\xD7\x66\x0C\xA5", 4) + "dtz data");
+  WriteFile(directory / "KRvK.rtbw", "not a table");
+  WriteFile(directory / "README.txt", "ignored");
+  return directory;
+}
+
+constexpr std::string_view kWdlMagic("\x71\xE8\x23\x5D", 4);
+constexpr std::string_view kDtzMagic("\xD7\x66\x0C\xA5", 4);
+
+void AppendLittleEndian(std::string& bytes, const uint64_t value, const size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    bytes += static_cast<char>(value >> (8 * i));
+  }
+}
+
+// A KRvK table header: flags, the group order and the pieces (white king, white rook, black king), padded to 2 bytes.
+std::string KrkHeader(const std::string_view magic) {
+  std::string bytes(magic);
+  bytes += std::string("\x01\x00\x66\x44\xEE\x00", 6);
+  return bytes;
+}
+
+// White to move is a draw except for wK b1, wR h1, bK g8, index 432 of the table. Black to move is a draw.
+std::string KrkPatternWdlTable() {
+  std::string bytes = KrkHeader(kWdlMagic);
+  // White to move: flags, 4096 byte blocks, a sparse index entry every 2^15 values, no padding and one block.
+  bytes += std::string("\x00\x0C\x0F\x00", 4);
+  AppendLittleEndian(bytes, 1, 4);
+  // Every symbol is 1 bit: symbol 0 is two of symbol 2, a draw, and symbol 1 is a win.
+  bytes += std::string("\x01\x01", 2);
+  AppendLittleEndian(bytes, 0, 2);
+  AppendLittleEndian(bytes, 3, 2);
+  bytes += std::string("\x02\x20\x00\x04\xF0\xFF\x02\xF0\xFF\x00", 10);
+  // Black to move: a single value.
+  bytes += std::string("\x80\x02", 2);
+  // The sparse index entry points the middle of its span at the start of the block, and the block has all 31332
+  // values.
+  AppendLittleEndian(bytes, 0, 4);
+  AppendLittleEndian(bytes, 16384, 2);
+  AppendLittleEndian(bytes, 31331, 2);
+  bytes.resize(64, '\0');
+  std::string block(4096, '\0');
+  block.at(27) = '\x80';
+  return bytes + block;
+}
+
+// Every position has the same value for each side to move, 0 (loss) to 4 (win) in WDL tables. DTZ tables only store
+// white to move. The pieces are the table's codes in its order, 1 (pawn) to 6 (king) plus 8 for black, leading pawns or
+// kings first.
+std::string SingleValueTable(const std::string_view magic, const std::vector<int>& pieces, const char white_to_move,
+                             const char black_to_move) {
+  std::vector<int> white_pieces;
+  std::vector<int> black_pieces;
+  for (const int piece : pieces) {
+    (piece < 8 ? white_pieces : black_pieces).push_back(piece & 7);
+  }
+  std::ranges::sort(white_pieces);
+  std::ranges::sort(black_pieces);
+  const bool symmetric = white_pieces == black_pieces;
+  // Pawns sort first.
+  const bool has_pawns = white_pieces.front() == 1 || black_pieces.front() == 1;
+  const bool both_sides_have_pawns = white_pieces.front() == 1 && black_pieces.front() == 1;
+
+  std::string bytes(magic);
+  bytes += static_cast<char>((symmetric ? 0 : 1) | (has_pawns ? 2 : 0));
+  const int files = has_pawns ? 4 : 1;
+  for (int file = 0; file < files; ++file) {
+    // The leading group first, then the other side's pawns.
+    bytes += '\0';
+    if (both_sides_have_pawns) {
+      bytes += '\x11';
+    }
+    for (const int piece : pieces) {
+      bytes += static_cast<char>(piece | piece << 4);
+    }
+  }
+  if (bytes.size() % 2 != 0) {
+    bytes += '\0';
+  }
+  const bool both_sides = magic == kWdlMagic && !symmetric;
+  for (int file = 0; file < files; ++file) {
+    bytes += std::string{'\x80', white_to_move};
+    if (both_sides) {
+      bytes += std::string{'\x80', black_to_move};
+    }
+  }
+  return bytes;
+}
+
+std::string KrkSingleValueWdlTable(const char white_to_move, const char black_to_move) {
+  return SingleValueTable(kWdlMagic, {6, 4, 14}, white_to_move, black_to_move);
+}
+
+// White to move only, every position 9 moves from zeroing when winning.
+std::string KrkDtzTable() {
+  std::string bytes = KrkHeader(kDtzMagic);
+  bytes += std::string("\x82\x01", 2);
+  // Mapped values for wins, losses, cursed wins and blessed losses.
+  bytes += std::string("\x02\x07\x09\x00\x00\x00", 6);
+  bytes.resize(64, '\0');
+  return bytes;
+}
+
+// White to move wins with the pawn on the a or h file, draws on b or g, loses on c or f and has a cursed win on d or
+// e. Black to move is a draw.
+std::string KpkWdlTable() {
+  std::string bytes(kWdlMagic);
+  bytes += '\x03';
+  for (int file = 0; file < 4; ++file) {
+    // The pawn leads, then the white king and the black king.
+    bytes += std::string("\x00\x11\x66\xEE", 4);
+  }
+  bytes += '\0';
+  for (const char value : {'\x04', '\x02', '\x00', '\x03'}) {
+    bytes += std::string{'\x80', value, '\x80', '\x02'};
+  }
+  return bytes;
+}
+
+std::filesystem::path MakeDecodedTableDirectory(const std::string& krk_wdl_table) {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "bomchess_tablebase_probe_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directory(directory);
+  WriteFile(directory / "KRvK.rtbw", krk_wdl_table);
+  WriteFile(directory / "KRvK.rtbz", KrkDtzTable());
+  WriteFile(directory / "KPvK.rtbw", KpkWdlTable());
+  return directory;
+}
+
+// Positions where a capture is best, and the tables for them. The table for the position itself stores the given
+// values, which a capture beats. In the smaller tables the stronger side wins and the weaker side loses.
+std::filesystem::path MakeCaptureTableDirectory(const char queen_side_to_move, const char rook_side_to_move) {
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "bomchess_tablebase_capture_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directory(directory);
+  WriteFile(directory / "KQvKR.rtbw",
+            SingleValueTable(kWdlMagic, {6, 5, 14, 12}, queen_side_to_move, rook_side_to_move));
+  WriteFile(directory / "KQvKR.rtbz", SingleValueTable(kDtzMagic, {6, 5, 14, 12}, '\x05', '\0'));
+  WriteFile(directory / "KQvK.rtbw", SingleValueTable(kWdlMagic, {6, 5, 14}, '\x04', '\0'));
+  WriteFile(directory / "KRvK.rtbw", KrkSingleValueWdlTable('\x04', '\0'));
+  WriteFile(directory / "KPvKP.rtbw", SingleValueTable(kWdlMagic, {1, 9, 6, 14}, '\x02', '\x02'));
+  WriteFile(directory / "KPvK.rtbw", SingleValueTable(kWdlMagic, {1, 6, 14}, '\x04', '\0'));
+  return directory;
+}
+
+// White to move wins the undefended rook.
+const bomchess::Position kHangingRook = MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                                      {bomchess::Square::kD1, bomchess::pieces::kWhiteQueen},
+                                                      {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                                      {bomchess::Square::kA4, bomchess::pieces::kBlackRook}});
+// Black to move draws by giving the rook for the queen.
+const bomchess::Position kRookTakesQueen = MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                                         {bomchess::Square::kD2, bomchess::pieces::kWhiteQueen},
+                                                         {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                                         {bomchess::Square::kD8, bomchess::pieces::kBlackRook}});
+// After d7-d5, white to move wins by taking en passant.
+const bomchess::Position kEnPassant = MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                                    {bomchess::Square::kE5, bomchess::pieces::kWhitePawn},
+                                                    {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                                    {bomchess::Square::kD5, bomchess::pieces::kBlackPawn}});
+
+const bomchess::Position kKings =
+    MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                  {bomchess::Square::kE8, bomchess::pieces::kBlackKing}});
+const bomchess::Position kWhiteQueenBlackRook =
+    MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                  {bomchess::Square::kD1, bomchess::pieces::kWhiteQueen},
+                  {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                  {bomchess::Square::kA8, bomchess::pieces::kBlackRook}});
+const bomchess::Position kWhiteRookBlackQueen =
+    MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                  {bomchess::Square::kD1, bomchess::pieces::kWhiteRook},
+                  {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                  {bomchess::Square::kA8, bomchess::pieces::kBlackQueen}});
+const bomchess::Position kWhiteRook =
+    MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                  {bomchess::Square::kD1, bomchess::pieces::kWhiteRook},
+                  {bomchess::Square::kE8, bomchess::pieces::kBlackKing}});
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TablebaseSyzygyTableName) {
+  BOOST_CHECK_EQUAL(bomchess::SyzygyTableName(kKings), "KvK");
+  BOOST_CHECK_EQUAL(bomchess::SyzygyTableName(kWhiteRook), "KRvK");
+  BOOST_CHECK_EQUAL(bomchess::SyzygyTableName(kWhiteQueenBlackRook), "KQvKR");
+  BOOST_CHECK_EQUAL(bomchess::SyzygyTableName(kWhiteRookBlackQueen), "KQvKR");
+
+  const bomchess::Position three_against_two =
+      MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                    {bomchess::Square::kD1, bomchess::pieces::kWhiteQueen},
+                    {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                    {bomchess::Square::kA7, bomchess::pieces::kBlackPawn},
+                    {bomchess::Square::kB8, bomchess::pieces::kBlackKnight}});
+  BOOST_CHECK_EQUAL(bomchess::SyzygyTableName(three_against_two), "KNPvKQ");
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseSyzygyTableNameThrows) {
+  const bomchess::Position missing_king = MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing}});
+  BOOST_CHECK_THROW(std::ignore = bomchess::SyzygyTableName(missing_king), std::invalid_argument);
+
+  bomchess::Position too_many_pieces = kKings;
+  for (const bomchess::Square square : {bomchess::Square::kA2, bomchess::Square::kB2, bomchess::Square::kC2,
+                                        bomchess::Square::kD2, bomchess::Square::kE2, bomchess::Square::kF2}) {
+    too_many_pieces.at(square) = bomchess::pieces::kWhitePawn;
+  }
+  BOOST_CHECK_THROW(std::ignore = bomchess::SyzygyTableName(too_many_pieces), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseFindsTables) {
+  const bomchess::Tablebase tablebase(MakeTableDirectory());
+  BOOST_CHECK_EQUAL(tablebase.MaxPieces(), 4);
+  BOOST_CHECK(tablebase.HasTable(kWhiteQueenBlackRook, bomchess::TablebaseType::kWdl));
+  BOOST_CHECK(tablebase.HasTable(kWhiteRookBlackQueen, bomchess::TablebaseType::kDtz));
+  BOOST_CHECK(tablebase.HasTable(kWhiteRook, bomchess::TablebaseType::kWdl));
+  BOOST_CHECK(!tablebase.HasTable(kWhiteRook, bomchess::TablebaseType::kDtz));
+  BOOST_CHECK(!tablebase.HasTable(kKings, bomchess::TablebaseType::kWdl));
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseThrows) {
+  const std::filesystem::path missing_directory =
+      std::filesystem::temp_directory_path() / "bomchess_missing_tablebase_directory";
+  BOOST_CHECK_THROW(bomchess::Tablebase{missing_directory}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseTableData) {
+  const bomchess::Tablebase tablebase(MakeTableDirectory());
+  const auto wdl_data = tablebase.TableData(kWhiteQueenBlackRook, bomchess::TablebaseType::kWdl);
+  BOOST_CHECK_EQUAL(wdl_data.size(), 12);
+  BOOST_CHECK(wdl_data.data() == tablebase.TableData(kWhiteRookBlackQueen, bomchess::TablebaseType::kWdl).data());
+  BOOST_CHECK_EQUAL(tablebase.TableData(kWhiteQueenBlackRook, bomchess::TablebaseType::kDtz).size(), 12);
+
+  BOOST_CHECK_THROW(std::ignore = tablebase.TableData(kWhiteRook, bomchess::TablebaseType::kWdl), std::runtime_error);
+  BOOST_CHECK_THROW(std::ignore = tablebase.TableData(kWhiteRook, bomchess::TablebaseType::kDtz),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseProbeWdl) {
+  const bomchess::Tablebase tablebase(MakeDecodedTableDirectory(KrkPatternWdlTable()));
+  const bomchess::Position win = MakePosition({{bomchess::Square::kB1, bomchess::pieces::kWhiteKing},
+                                               {bomchess::Square::kH1, bomchess::pieces::kWhiteRook},
+                                               {bomchess::Square::kG8, bomchess::pieces::kBlackKing}});
+  BOOST_CHECK(tablebase.ProbeWdl(win, bomchess::Color::kWhite, bomchess::Square::kNone) == bomchess::WdlScore::kWin);
+  BOOST_CHECK(tablebase.ProbeWdl(win, bomchess::Color::kBlack, bomchess::Square::kNone) == bomchess::WdlScore::kDraw);
+
+  // The same table entry reached by mirroring files, mirroring along the diagonal, and swapping colors.
+  const bomchess::Position mirrored = MakePosition({{bomchess::Square::kG1, bomchess::pieces::kWhiteKing},
+                                                    {bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                                    {bomchess::Square::kB8, bomchess::pieces::kBlackKing}});
+  BOOST_CHECK(tablebase.ProbeWdl(mirrored, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kWin);
+  const bomchess::Position diagonal = MakePosition({{bomchess::Square::kA2, bomchess::pieces::kWhiteKing},
+                                                    {bomchess::Square::kA8, bomchess::pieces::kWhiteRook},
+                                                    {bomchess::Square::kH7, bomchess::pieces::kBlackKing}});
+  BOOST_CHECK(tablebase.ProbeWdl(diagonal, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kWin);
+  const bomchess::Position colors_swapped = MakePosition({{bomchess::Square::kB8, bomchess::pieces::kBlackKing},
+                                                          {bomchess::Square::kH8, bomchess::pieces::kBlackRook},
+                                                          {bomchess::Square::kG1, bomchess::pieces::kWhiteKing}});
+  BOOST_CHECK(tablebase.ProbeWdl(colors_swapped, bomchess::Color::kBlack, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kWin);
+  BOOST_CHECK(tablebase.ProbeWdl(colors_swapped, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kDraw);
+
+  const bomchess::Position draw = MakePosition({{bomchess::Square::kB1, bomchess::pieces::kWhiteKing},
+                                                {bomchess::Square::kH2, bomchess::pieces::kWhiteRook},
+                                                {bomchess::Square::kG8, bomchess::pieces::kBlackKing}});
+  BOOST_CHECK(tablebase.ProbeWdl(draw, bomchess::Color::kWhite, bomchess::Square::kNone) == bomchess::WdlScore::kDraw);
+  BOOST_CHECK(tablebase.ProbeWdl(kKings, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kDraw);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseProbeWdlPawns) {
+  const bomchess::Tablebase tablebase(MakeDecodedTableDirectory(KrkPatternWdlTable()));
+  const auto pawn_result = [&tablebase](const bomchess::Square pawn_square, const bomchess::Piece pawn,
+                                        const bomchess::Color side_to_move) {
+    return tablebase.ProbeWdl(MakePosition({{bomchess::Square::kE1, bomchess::pieces::kWhiteKing},
+                                            {bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                            {pawn_square, pawn}}),
+                              side_to_move, bomchess::Square::kNone);
+  };
+  BOOST_CHECK(pawn_result(bomchess::Square::kA2, bomchess::pieces::kWhitePawn, bomchess::Color::kWhite) ==
+              bomchess::WdlScore::kWin);
+  BOOST_CHECK(pawn_result(bomchess::Square::kH5, bomchess::pieces::kWhitePawn, bomchess::Color::kWhite) ==
+              bomchess::WdlScore::kWin);
+  BOOST_CHECK(pawn_result(bomchess::Square::kG3, bomchess::pieces::kWhitePawn, bomchess::Color::kWhite) ==
+              bomchess::WdlScore::kDraw);
+  BOOST_CHECK(pawn_result(bomchess::Square::kC4, bomchess::pieces::kWhitePawn, bomchess::Color::kWhite) ==
+              bomchess::WdlScore::kLoss);
+  BOOST_CHECK(pawn_result(bomchess::Square::kE6, bomchess::pieces::kWhitePawn, bomchess::Color::kWhite) ==
+              bomchess::WdlScore::kCursedWin);
+  BOOST_CHECK(pawn_result(bomchess::Square::kA2, bomchess::pieces::kWhitePawn, bomchess::Color::kBlack) ==
+              bomchess::WdlScore::kDraw);
+  BOOST_CHECK(pawn_result(bomchess::Square::kA7, bomchess::pieces::kBlackPawn, bomchess::Color::kBlack) ==
+              bomchess::WdlScore::kWin);
+  BOOST_CHECK(pawn_result(bomchess::Square::kD7, bomchess::pieces::kBlackPawn, bomchess::Color::kBlack) ==
+              bomchess::WdlScore::kCursedWin);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseProbeDtz) {
+  const bomchess::Tablebase tablebase(MakeDecodedTableDirectory(KrkSingleValueWdlTable('\x04', '\x00')));
+  const bomchess::Position position = MakePosition({{bomchess::Square::kB1, bomchess::pieces::kWhiteKing},
+                                                    {bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                                    {bomchess::Square::kH8, bomchess::pieces::kBlackKing}});
+  // 9 full moves from the mapped values, stored in moves so doubled, plus one.
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(position, bomchess::Color::kWhite, bomchess::Square::kNone), 19);
+  // The table only stores white to move, so every black move leads to a position 19 plies from zeroing.
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(position, bomchess::Color::kBlack, bomchess::Square::kNone), -20);
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(kKings, bomchess::Color::kBlack, bomchess::Square::kNone), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseBestMove) {
+  const bomchess::Tablebase tablebase(MakeDecodedTableDirectory(KrkSingleValueWdlTable('\x04', '\x00')));
+  // Taking the rook draws, every other move loses.
+  const bomchess::Position hanging_rook = MakePosition({{bomchess::Square::kB1, bomchess::pieces::kWhiteKing},
+                                                        {bomchess::Square::kH1, bomchess::pieces::kWhiteRook},
+                                                        {bomchess::Square::kG2, bomchess::pieces::kBlackKing}});
+  const std::optional<bomchess::Move> best_move =
+      tablebase.BestMove(hanging_rook, bomchess::Color::kBlack, bomchess::Square::kNone);
+  BOOST_REQUIRE(best_move.has_value());
+  BOOST_CHECK_EQUAL(best_move->from_square, bomchess::Square::kG2);
+  BOOST_CHECK_EQUAL(best_move->to_square, bomchess::Square::kH1);
+
+  const bomchess::Position mated = MakePosition({{bomchess::Square::kG6, bomchess::pieces::kWhiteKing},
+                                                 {bomchess::Square::kA8, bomchess::pieces::kWhiteRook},
+                                                 {bomchess::Square::kH8, bomchess::pieces::kBlackKing}});
+  BOOST_CHECK(!tablebase.BestMove(mated, bomchess::Color::kBlack, bomchess::Square::kNone).has_value());
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(mated, bomchess::Color::kBlack, bomchess::Square::kNone), -1);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseProbeSearchesCaptures) {
+  // The stored values are a draw for white to move and a loss for black to move.
+  const bomchess::Tablebase tablebase(MakeCaptureTableDirectory('\x02', '\0'));
+  BOOST_CHECK(tablebase.ProbeWdl(kHangingRook, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kWin);
+  BOOST_CHECK(tablebase.ProbeWdl(kRookTakesQueen, bomchess::Color::kBlack, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kDraw);
+  // Without a capture the stored value stands.
+  BOOST_CHECK(tablebase.ProbeWdl(kHangingRook, bomchess::Color::kBlack, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kLoss);
+
+  BOOST_CHECK(tablebase.ProbeWdl(kEnPassant, bomchess::Color::kWhite, bomchess::Square::kNone) ==
+              bomchess::WdlScore::kDraw);
+  BOOST_CHECK(tablebase.ProbeWdl(kEnPassant, bomchess::Color::kWhite, bomchess::Square::kD6) ==
+              bomchess::WdlScore::kWin);
+  // Winning zeroing moves have a DTZ of 1, whatever the DTZ table holds, and KPvKP has none.
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(kEnPassant, bomchess::Color::kWhite, bomchess::Square::kD6), 1);
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(kEnPassant, bomchess::Color::kWhite, bomchess::Square::kNone), 0);
+  BOOST_CHECK_EQUAL(tablebase.BestMove(kEnPassant, bomchess::Color::kWhite, bomchess::Square::kD6).value(),
+                    bomchess::Move(bomchess::Square::kE5, bomchess::Square::kD6, bomchess::PieceType::kNone));
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseBestMoveCaptures) {
+  // Stored as a win either way for white to move, which the DTZ table puts 11 plies from zeroing.
+  const bomchess::Tablebase tablebase(MakeCaptureTableDirectory('\x04', '\0'));
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(kHangingRook, bomchess::Color::kWhite, bomchess::Square::kNone), 1);
+  BOOST_CHECK_EQUAL(tablebase.BestMove(kHangingRook, bomchess::Color::kWhite, bomchess::Square::kNone).value(),
+                    bomchess::Move(bomchess::Square::kD1, bomchess::Square::kA4, bomchess::PieceType::kNone));
+  BOOST_CHECK_EQUAL(tablebase.BestMove(kRookTakesQueen, bomchess::Color::kBlack, bomchess::Square::kNone).value(),
+                    bomchess::Move(bomchess::Square::kD8, bomchess::Square::kD2, bomchess::PieceType::kNone));
+  BOOST_CHECK_EQUAL(tablebase.ProbeDtz(kRookTakesQueen, bomchess::Color::kBlack, bomchess::Square::kNone), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TablebaseProbeThrows) {
+  const bomchess::Tablebase missing_tables(MakeDecodedTableDirectory(KrkPatternWdlTable()));
+  BOOST_CHECK_THROW(
+      std::ignore = missing_tables.ProbeWdl(kWhiteQueenBlackRook, bomchess::Color::kWhite, bomchess::Square::kNone),
+      std::invalid_argument);
+  BOOST_CHECK_THROW(
+      std::ignore = missing_tables.ProbeWdl(kWhiteRook, bomchess::Color::kNone, bomchess::Square::kNone),
+      std::invalid_argument);
+
+  const bomchess::Tablebase corrupt_tables(MakeTableDirectory());
+  BOOST_CHECK_THROW(
+      std::ignore = corrupt_tables.ProbeWdl(kWhiteQueenBlackRook, bomchess::Color::kWhite, bomchess::Square::kNone),
+      std::runtime_error);
+  BOOST_CHECK_THROW(
+      std::ignore = corrupt_tables.ProbeWdl(kWhiteRook, bomchess::Color::kWhite, bomchess::Square::kNone),
+      std::runtime_error);
+
+  // Cut off in the middle of the compressed data.
+  const bomchess::Tablebase truncated_table(MakeDecodedTableDirectory(KrkPatternWdlTable().substr(0, 100)));
+  BOOST_CHECK_THROW(
+      std::ignore = truncated_table.ProbeWdl(kWhiteRook, bomchess::Color::kWhite, bomchess::Square::kNone),
+      std::runtime_error);
+}
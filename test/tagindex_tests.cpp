@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "tagindex.h"
+
+namespace {
+struct TestGame {
+  std::string white;
+  std::string black;
+  std::string event;
+  std::string eco;
+  std::string date;
+  int white_elo;
+  int black_elo;
+};
+
+const std::array<std::string, 5> kPlayers{"Carlsen, Magnus", "Caruana, Fabiano", "Ding, Liren", "Nakamura, Hikaru",
+                                          "Firouzja, Alireza"};
+const std::array<std::string, 3> kEvents{"Tata Steel", "Candidates", "Online Blitz"};
+
+// Spread over more than one filter chunk, with some tags missing or malformed.
+std::vector<TestGame> MakeGames() {
+  std::mt19937 random(7);
+  std::vector<TestGame> games;
+  for (int i = 0; i < 10000; ++i) {
+    TestGame game;
+    game.white = kPlayers.at(random() % kPlayers.size());
+    game.black = kPlayers.at(random() % kPlayers.size());
+    game.event = random() % 10 == 0 ? "" : kEvents.at(random() % kEvents.size());
+    game.eco = std::string(1, static_cast<char>('A' + random() % 5)) + std::to_string(10 + random() % 90);
+    game.date = std::to_string(1990 + random() % 35) + (random() % 8 == 0 ? ".??.??" : ".06.15");
+    game.white_elo = random() % 20 == 0 ? 0 : 2000 + static_cast<int>(random() % 900);
+    game.black_elo = 2000 + static_cast<int>(random() % 900);
+    games.push_back(game);
+  }
+  return games;
+}
+
+std::string MakePgn(const std::vector<TestGame>& games) {
+  std::string pgn;
+  for (const TestGame& game : games) {
+    pgn += "[Event \"" + game.event + "\"]\n[Date \"" + game.date + "\"]\n[White \"" + game.white + "\"]\n[Black \"" +
+           game.black + "\"]\n[Result \"*\"]\n[ECO \"" + game.eco + "\"]\n";
+    if (game.white_elo != 0) {
+      pgn += "[WhiteElo \"" + std::to_string(game.white_elo) + "\"]\n";
+    }
+    pgn += "[BlackElo \"" + std::to_string(game.black_elo) + "\"]\n\n1. e4 {1-0} e5 *\n\n";
+  }
+  return pgn;
+}
+
+std::filesystem::path IndexPath() { return std::filesystem::temp_directory_path() / "bomchess_tag_index.btag"; }
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TagIndexParsePgnDate) {
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate("1992.11.04"), 19921104);
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate("1992.11.??"), 19921100);
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate("1992.??.??"), 19920000);
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate("????.11.04"), 0);
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate(""), 0);
+  BOOST_CHECK_EQUAL(bomchess::ParsePgnDate("1992-11-04"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TagIndexColumns) {
+  const std::vector<TestGame> games = MakeGames();
+  const std::string pgn = MakePgn(games);
+  bomchess::BuildTagIndex(pgn, IndexPath());
+  const bomchess::TagIndex index(IndexPath());
+  BOOST_REQUIRE_EQUAL(index.Size(), games.size());
+  for (size_t i = 0; i < games.size(); ++i) {
+    BOOST_CHECK(pgn.substr(index.Offsets()[i]).starts_with("[Event \"" + games.at(i).event + "\"]"));
+    BOOST_CHECK_EQUAL(index.WhiteElo()[i], games.at(i).white_elo);
+    BOOST_CHECK_EQUAL(index.BlackElo()[i], games.at(i).black_elo);
+    BOOST_CHECK_EQUAL(index.Dates()[i], bomchess::ParsePgnDate(games.at(i).date));
+    BOOST_CHECK_EQUAL(index.Value(bomchess::TagColumn::kWhite, index.Ids(bomchess::TagColumn::kWhite)[i]),
+                      games.at(i).white);
+    BOOST_CHECK_EQUAL(index.Value(bomchess::TagColumn::kEvent, index.Ids(bomchess::TagColumn::kEvent)[i]),
+                      games.at(i).event);
+    BOOST_CHECK_EQUAL(index.Value(bomchess::TagColumn::kECO, index.Ids(bomchess::TagColumn::kECO)[i]), games.at(i).eco);
+  }
+  // Ids are in string order.
+  BOOST_CHECK_LT(*index.FindId(bomchess::TagColumn::kWhite, "Carlsen, Magnus"),
+                 *index.FindId(bomchess::TagColumn::kWhite, "Ding, Liren"));
+  BOOST_CHECK_EQUAL(*index.FindId(bomchess::TagColumn::kEvent, ""), 0);
+  BOOST_CHECK(!index.FindId(bomchess::TagColumn::kBlack, "Kasparov, Garry").has_value());
+  BOOST_CHECK_THROW(std::ignore = index.Value(bomchess::TagColumn::kWhite, 5), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(TagIndexFilter) {
+  const std::vector<TestGame> games = MakeGames();
+  bomchess::BuildTagIndex(MakePgn(games), IndexPath());
+  const bomchess::TagIndex index(IndexPath());
+
+  const auto check = [&](const bomchess::TagFilter& filter, const auto& matches) {
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < games.size(); ++i) {
+      if (matches(games.at(i))) {
+        expected.push_back(i);
+      }
+    }
+    BOOST_CHECK(!expected.empty());
+    BOOST_CHECK(index.Filter(filter) == expected);
+  };
+  check({.white_elo = bomchess::TagRange{2500, 2600}},
+        [](const TestGame& game) { return game.white_elo >= 2500 && game.white_elo <= 2600; });
+  check({.white_elo = bomchess::TagRange{.max = 0}}, [](const TestGame& game) { return game.white_elo == 0; });
+  check({.black_elo = bomchess::TagRange{.min = 2700}, .eco = std::array<std::string, 2>{"B90", "B99"}},
+        [](const TestGame& game) { return game.black_elo >= 2700 && game.eco >= "B90" && game.eco <= "B99"; });
+  check({.date = bomchess::TagRange{20000000, 20101231}, .player = "Ding, Liren"}, [](const TestGame& game) {
+    return game.date >= "2000" && game.date < "2011" && (game.white == "Ding, Liren" || game.black == "Ding, Liren");
+  });
+  check({.white = "Carlsen, Magnus", .black = "Nakamura, Hikaru", .event = "Online Blitz"}, [](const TestGame& game) {
+    return game.white == "Carlsen, Magnus" && game.black == "Nakamura, Hikaru" && game.event == "Online Blitz";
+  });
+  check({}, [](const TestGame&) { return true; });
+
+  BOOST_CHECK(index.Filter({.player = "Kasparov, Garry"}).empty());
+  BOOST_CHECK(index.Filter({.eco = std::array<std::string, 2>{"Z00", "Z99"}}).empty());
+  BOOST_CHECK(index.Filter({.white_elo = bomchess::TagRange{70000, 80000}}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TagIndexThrows) {
+  bomchess::BuildTagIndex("", IndexPath());
+  BOOST_CHECK_EQUAL(bomchess::TagIndex(IndexPath()).Size(), 0);
+
+  bomchess::BuildTagIndex(MakePgn(MakeGames()), IndexPath());
+  std::filesystem::resize_file(IndexPath(), std::filesystem::file_size(IndexPath()) - 8);
+  BOOST_CHECK_THROW(bomchess::TagIndex{IndexPath()}, std::runtime_error);
+  {
+    std::ofstream file(IndexPath(), std::ios::binary | std::ios::trunc);
+    file << "not an index file";
+  }
+  BOOST_CHECK_THROW(bomchess::TagIndex{IndexPath()}, std::runtime_error);
+  BOOST_CHECK_THROW(bomchess::TagIndex{"missing_index.btag"}, std::runtime_error);
+  BOOST_CHECK_THROW(bomchess::BuildTagIndex("[Event \"unterminated]\n*", IndexPath()), std::invalid_argument);
+}
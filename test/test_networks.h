@@ -0,0 +1,24 @@
+#ifndef TEST_NETWORKS_H
+#define TEST_NETWORKS_H
+
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * Helpers for writing NNUE network files in the test suites.
+ */
+namespace bomchess::testing {
+/**
+ * Writes the value in little endian, as network files store it whatever the host.
+ */
+template <typename T>
+void WriteValue(std::ostream& stream, const T value) {
+  const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    stream.put(static_cast<char>(bits >> (8 * byte)));
+  }
+}
+}  // namespace bomchess::testing
+
+#endif  // TEST_NETWORKS_H
@@ -0,0 +1,62 @@
+#ifndef TEST_POSITIONS_H
+#define TEST_POSITIONS_H
+
+#include <array>
+#include <initializer_list>
+#include <utility>
+
+#include "color.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+
+/**
+ * Position factories shared by the test suites.
+ */
+namespace bomchess::testing {
+/**
+ * @return A position with just the given pieces.
+ */
+inline Position MakePosition(const std::initializer_list<std::pair<Square, Piece>> pieces) {
+  Position position;
+  for (const auto& [square, piece] : pieces) {
+    position.at(square) = piece;
+  }
+  return position;
+}
+
+inline Position StartingPosition() {
+  constexpr std::array<PieceType, 8> kBackRank{PieceType::kRook,  PieceType::kKnight, PieceType::kBishop,
+                                               PieceType::kQueen, PieceType::kKing,   PieceType::kBishop,
+                                               PieceType::kKnight, PieceType::kRook};
+  Position position;
+  for (int file = 0; file < 8; ++file) {
+    position.at(static_cast<Square>(file)) = {Color::kBlack, kBackRank.at(file)};
+    position.at(static_cast<Square>(8 + file)) = pieces::kBlackPawn;
+    position.at(static_cast<Square>(48 + file)) = pieces::kWhitePawn;
+    position.at(static_cast<Square>(56 + file)) = {Color::kWhite, kBackRank.at(file)};
+  }
+  return position;
+}
+
+/**
+ * @return The square on the same file and the opposite rank.
+ */
+inline Square FlipRank(const Square square) { return static_cast<Square>(std::to_underlying(square) ^ 56); }
+
+/**
+ * @return The same position with the colors swapped and the board flipped top to bottom.
+ */
+inline Position Mirror(const Position& position) {
+  Position mirrored;
+  for (const Square square : kAllSquares) {
+    const Piece piece = position.at(square);
+    if (piece != pieces::kNone) {
+      mirrored.at(FlipRank(square)) = {piece.color == Color::kWhite ? Color::kBlack : Color::kWhite, piece.type};
+    }
+  }
+  return mirrored;
+}
+}  // namespace bomchess::testing
+
+#endif  // TEST_POSITIONS_H
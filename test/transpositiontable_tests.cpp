@@ -0,0 +1,97 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "move.h"
+#include "piece.h"
+#include "square.h"
+#include "transpositiontable.h"
+
+namespace {
+const bomchess::TranspositionEntry kEntry{
+    bomchess::Move(bomchess::Square::kE2, bomchess::Square::kE4, bomchess::PieceType::kNone), -150, 7,
+    bomchess::Bound::kLower};
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(TranspositionTableSize) {
+  const bomchess::TranspositionTable table(1);
+  BOOST_CHECK_EQUAL(table.EntryCount(), 1024 * 1024 / 16);
+  BOOST_CHECK_THROW(bomchess::TranspositionTable{0}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TranspositionTableStoreProbe) {
+  bomchess::TranspositionTable table(1);
+  BOOST_CHECK(!table.Probe(0).has_value());
+  BOOST_CHECK(!table.Probe(12345).has_value());
+
+  table.Store(12345, kEntry);
+  BOOST_REQUIRE(table.Probe(12345).has_value());
+  BOOST_CHECK(*table.Probe(12345) == kEntry);
+  BOOST_CHECK(!table.Probe(12345 + table.EntryCount()).has_value());
+
+  const bomchess::TranspositionEntry no_move{
+      bomchess::Move(bomchess::Square::kNone, bomchess::Square::kNone, bomchess::PieceType::kNone), 32000, -1,
+      bomchess::Bound::kExact};
+  table.Store(0, no_move);
+  BOOST_REQUIRE(table.Probe(0).has_value());
+  BOOST_CHECK(*table.Probe(0) == no_move);
+
+  table.Clear();
+  BOOST_CHECK(!table.Probe(12345).has_value());
+  BOOST_CHECK(!table.Probe(0).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(TranspositionTableReplacement) {
+  bomchess::TranspositionTable table(1);
+  table.Store(42, kEntry);
+
+  bomchess::TranspositionEntry shallower = kEntry;
+  shallower.depth = 3;
+  table.Store(42, shallower);
+  BOOST_CHECK_EQUAL(table.Probe(42)->depth, 7);
+
+  const uint64_t colliding_key = 42 + table.EntryCount();
+  table.Store(colliding_key, shallower);
+  BOOST_CHECK(!table.Probe(42).has_value());
+  BOOST_CHECK_EQUAL(table.Probe(colliding_key)->depth, 3);
+}
+
+BOOST_AUTO_TEST_CASE(TranspositionTableStoreThrows) {
+  bomchess::TranspositionTable table(1);
+  bomchess::TranspositionEntry invalid = kEntry;
+  invalid.move.promotion = static_cast<bomchess::PieceType>(9);
+  BOOST_CHECK_THROW(table.Store(1, invalid), std::invalid_argument);
+}
+
+// Threads hammer a handful of slots. Every entry a probe returns must be one that was stored under that key.
+BOOST_AUTO_TEST_CASE(TranspositionTableConcurrentAccess) {
+  bomchess::TranspositionTable table(1);
+  const uint64_t entry_count = table.EntryCount();
+  std::vector<std::thread> threads;
+  std::atomic<bool> torn_entry_seen = false;
+  for (int thread_index = 0; thread_index < 4; ++thread_index) {
+    threads.emplace_back([&table, &torn_entry_seen, entry_count, thread_index] {
+      for (int i = 0; i < 100000; ++i) {
+        const uint64_t key = static_cast<uint64_t>(i % 8) + entry_count * (i % 3 + thread_index);
+        bomchess::TranspositionEntry entry = kEntry;
+        entry.score = static_cast<int16_t>(key % 1000);
+        entry.depth = static_cast<int8_t>(i % 64);
+        table.Store(key, entry);
+        if (const auto probed = table.Probe(key); probed.has_value() && probed->score != entry.score) {
+          torn_entry_seen = true;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK(!torn_entry_seen);
+}
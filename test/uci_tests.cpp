@@ -0,0 +1,245 @@
+#define BOOST_TEST_MODULE "bomchess"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "boost/test/unit_test.hpp"
+
+#include "color.h"
+#include "move.h"
+#include "movegen.h"
+#include "piece.h"
+#include "position.h"
+#include "square.h"
+#include "test_positions.h"
+#include "uci.h"
+
+namespace {
+struct RecordedPosition {
+  std::string fen;
+  std::vector<bomchess::Move> moves;
+  bool reset;
+};
+
+struct Recorder {
+  std::vector<RecordedPosition> positions;
+  std::vector<bomchess::GoParameters> go_commands;
+  int stop_count = 0;
+  int ponder_hit_count = 0;
+  int new_game_count = 0;
+  std::vector<std::pair<std::string, std::string>> options;
+
+  bomchess::UciCallbacks Callbacks() {
+    return {
+        .position =
+            [this](std::string_view fen, std::span<const bomchess::Move> moves, bool reset) {
+              positions.push_back({std::string(fen), {moves.begin(), moves.end()}, reset});
+            },
+        .go = [this](const bomchess::GoParameters& parameters) { go_commands.push_back(parameters); },
+        .stop = [this] { stop_count += 1; },
+        .ponder_hit = [this] { ponder_hit_count += 1; },
+        .new_game = [this] { new_game_count += 1; },
+        .set_option =
+            [this](std::string_view name, std::string_view value) {
+              options.emplace_back(std::string(name), std::string(value));
+            },
+    };
+  }
+};
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(UciHandshake) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+  BOOST_CHECK(session.HandleCommand("uci"));
+  BOOST_CHECK(session.HandleCommand("isready"));
+  BOOST_CHECK(session.HandleCommand("unknown tokens isready"));
+  BOOST_CHECK(session.HandleCommand("not a command"));
+  BOOST_CHECK_EQUAL(output.str(), "id name bomchess\nid author Brigham Skarda\nuciok\nreadyok\nreadyok\n");
+}
+
+BOOST_AUTO_TEST_CASE(UciPositionIsIncremental) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  session.HandleCommand("position startpos");
+  session.HandleCommand("position startpos moves e2e4 e7e5");
+  session.HandleCommand("position  startpos   moves e2e4 e7e5 g1f3");
+  session.HandleCommand("position startpos moves e2e4 e7e5 g1f3");
+  session.HandleCommand("position startpos moves d2d4");
+  BOOST_REQUIRE_EQUAL(recorder.positions.size(), 5);
+
+  BOOST_CHECK_EQUAL(recorder.positions.at(0).fen, bomchess::kUciStartPosition);
+  BOOST_CHECK(recorder.positions.at(0).reset);
+  BOOST_CHECK(recorder.positions.at(0).moves.empty());
+
+  BOOST_CHECK(!recorder.positions.at(1).reset);
+  BOOST_CHECK(recorder.positions.at(1).moves ==
+              std::vector({bomchess::FromUCI("e2e4"), bomchess::FromUCI("e7e5")}));
+
+  BOOST_CHECK(!recorder.positions.at(2).reset);
+  BOOST_CHECK(recorder.positions.at(2).moves == std::vector({bomchess::FromUCI("g1f3")}));
+
+  BOOST_CHECK(!recorder.positions.at(3).reset);
+  BOOST_CHECK(recorder.positions.at(3).moves.empty());
+
+  BOOST_CHECK(recorder.positions.at(4).reset);
+  BOOST_CHECK(recorder.positions.at(4).moves == std::vector({bomchess::FromUCI("d2d4")}));
+}
+
+BOOST_AUTO_TEST_CASE(UciPositionFen) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  session.HandleCommand("position fen 8/8/8/8/8/8/4k3/4K3 w - - 0 1 moves e1d1");
+  session.HandleCommand("position fen 8/8/8/8/8/8/4k3/4K3 w - - 0 1 moves e1d1 e2e3");
+  session.HandleCommand("ucinewgame");
+  session.HandleCommand("position fen 8/8/8/8/8/8/4k3/4K3 w - - 0 1 moves e1d1 e2e3");
+  BOOST_REQUIRE_EQUAL(recorder.positions.size(), 3);
+  BOOST_CHECK_EQUAL(recorder.positions.at(0).fen, "8/8/8/8/8/8/4k3/4K3 w - - 0 1");
+  BOOST_CHECK(recorder.positions.at(0).reset);
+  BOOST_CHECK_EQUAL(recorder.positions.at(1).fen, "8/8/8/8/8/8/4k3/4K3 w - - 0 1");
+  BOOST_CHECK(!recorder.positions.at(1).reset);
+  BOOST_CHECK(recorder.positions.at(1).moves == std::vector({bomchess::FromUCI("e2e3")}));
+  BOOST_CHECK_EQUAL(recorder.new_game_count, 1);
+  BOOST_CHECK(recorder.positions.at(2).reset);
+  BOOST_CHECK_EQUAL(recorder.positions.at(2).moves.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(UciPositionThrows) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  BOOST_CHECK_THROW(session.HandleCommand("position somewhere"), std::invalid_argument);
+  session.HandleCommand("position startpos moves e2e4");
+  BOOST_CHECK_THROW(session.HandleCommand("position startpos moves e2e4 z9z9"), std::invalid_argument);
+  session.HandleCommand("position startpos moves e2e4 e7e5");
+  BOOST_REQUIRE_EQUAL(recorder.positions.size(), 2);
+  BOOST_CHECK(recorder.positions.at(1).reset);
+}
+
+BOOST_AUTO_TEST_CASE(ParseFen) {
+  const bomchess::PositionState start = bomchess::ParseFen(bomchess::kUciStartPosition);
+  BOOST_CHECK(start.position == bomchess::testing::StartingPosition());
+  BOOST_CHECK(start.side_to_move == bomchess::Color::kWhite);
+  BOOST_CHECK(start.castling.at(0) == (bomchess::CastlingRights{true, true}));
+  BOOST_CHECK(start.castling.at(1) == (bomchess::CastlingRights{true, true}));
+  BOOST_CHECK(start.en_passant == bomchess::Square::kNone);
+  BOOST_CHECK_EQUAL(start.ply, 0);
+
+  const bomchess::PositionState state = bomchess::ParseFen("4k3/8/8/3pP3/8/8/8/R3K3 w Qk d6 0 12");
+  const bomchess::Position expected =
+      bomchess::testing::MakePosition({{bomchess::Square::kE8, bomchess::pieces::kBlackKing},
+                                       {bomchess::Square::kD5, bomchess::pieces::kBlackPawn},
+                                       {bomchess::Square::kE5, bomchess::pieces::kWhitePawn},
+                                       {bomchess::Square::kA1, bomchess::pieces::kWhiteRook},
+                                       {bomchess::Square::kE1, bomchess::pieces::kWhiteKing}});
+  BOOST_CHECK(state.position == expected);
+  BOOST_CHECK(state.castling.at(0) == (bomchess::CastlingRights{false, true}));
+  BOOST_CHECK(state.castling.at(1) == (bomchess::CastlingRights{true, false}));
+  BOOST_CHECK(state.en_passant == bomchess::Square::kD6);
+  BOOST_CHECK_EQUAL(state.ply, 22);
+
+  // The move counters may be left out.
+  const bomchess::PositionState black = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 b - -");
+  BOOST_CHECK(black.side_to_move == bomchess::Color::kBlack);
+  BOOST_CHECK_EQUAL(black.ply, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ParseFenThrows) {
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen(""), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 w - - 0"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k4/8/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k2/8/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4x3/8/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 x - - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 w X - 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 w - i9 0 1"), std::invalid_argument);
+  BOOST_CHECK_THROW(std::ignore = bomchess::ParseFen("4k3/8/8/8/8/8/8/4K3 w - - 0 0"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(UciGo) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  session.HandleCommand("go wtime 300000 btime 295000 winc 2000 binc 2000 movestogo 40");
+  session.HandleCommand("go ponder searchmoves e2e4 d2d4 depth 12 infinite");
+  BOOST_REQUIRE_EQUAL(recorder.go_commands.size(), 2);
+
+  const bomchess::GoParameters& timed = recorder.go_commands.at(0);
+  BOOST_CHECK_EQUAL(timed.white_time.value(), 300000);
+  BOOST_CHECK_EQUAL(timed.black_time.value(), 295000);
+  BOOST_CHECK_EQUAL(timed.white_increment.value(), 2000);
+  BOOST_CHECK_EQUAL(timed.black_increment.value(), 2000);
+  BOOST_CHECK_EQUAL(timed.moves_to_go.value(), 40);
+  BOOST_CHECK(!timed.depth.has_value());
+  BOOST_CHECK(!timed.infinite);
+
+  const bomchess::GoParameters& pondering = recorder.go_commands.at(1);
+  BOOST_CHECK(pondering.ponder);
+  BOOST_CHECK(pondering.infinite);
+  BOOST_CHECK_EQUAL(pondering.depth.value(), 12);
+  BOOST_CHECK(pondering.search_moves == std::vector({bomchess::FromUCI("e2e4"), bomchess::FromUCI("d2d4")}));
+}
+
+BOOST_AUTO_TEST_CASE(UciSetOption) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  session.HandleCommand("setoption name Hash value 256");
+  session.HandleCommand("setoption name Clear Hash");
+  BOOST_REQUIRE_EQUAL(recorder.options.size(), 2);
+  BOOST_CHECK_EQUAL(recorder.options.at(0).first, "Hash");
+  BOOST_CHECK_EQUAL(recorder.options.at(0).second, "256");
+  BOOST_CHECK_EQUAL(recorder.options.at(1).first, "Clear Hash");
+  BOOST_CHECK_EQUAL(recorder.options.at(1).second, "");
+}
+
+BOOST_AUTO_TEST_CASE(UciNullMove) {
+  std::istringstream input;
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+
+  session.HandleCommand("position startpos moves e2e4 0000 d2d4");
+  BOOST_REQUIRE_EQUAL(recorder.positions.size(), 1);
+  BOOST_CHECK(recorder.positions.at(0).moves ==
+              std::vector({bomchess::FromUCI("e2e4"), bomchess::kNullMove, bomchess::FromUCI("d2d4")}));
+
+  session.SendBestMove(bomchess::kNullMove);
+  session.SendBestMove(bomchess::FromUCI("e2e4"), bomchess::kNullMove);
+  BOOST_CHECK_EQUAL(output.str(), "bestmove 0000\nbestmove e2e4 ponder 0000\n");
+}
+
+BOOST_AUTO_TEST_CASE(UciInputThread) {
+  std::istringstream input("uci\nposition startpos moves e2e4 xx\nisready\nstop\nponderhit\nquit\nisready\n");
+  std::ostringstream output;
+  Recorder recorder;
+  bomchess::UciSession session(input, output, recorder.Callbacks(), "bomchess", "Brigham Skarda");
+  session.Start();
+  BOOST_CHECK_THROW(session.Start(), std::logic_error);
+  session.Join();
+  session.SendBestMove(bomchess::FromUCI("e2e4"), bomchess::FromUCI("e7e5"));
+
+  BOOST_CHECK_EQUAL(output.str(),
+                    "id name bomchess\nid author Brigham Skarda\nuciok\ninfo string Invalid UCI move string.\n"
+                    "readyok\nbestmove e2e4 ponder e7e5\n");
+  BOOST_CHECK_EQUAL(recorder.stop_count, 2);
+  BOOST_CHECK_EQUAL(recorder.ponder_hit_count, 1);
+}